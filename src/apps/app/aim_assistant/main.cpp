@@ -3,6 +3,7 @@
 #include "behavior.hpp"
 #include "common.hpp"
 #include "compensator.hpp"
+#include "debug_view.hpp"
 #include "hik_camera.hpp"
 #include "robot.hpp"
 
@@ -13,6 +14,7 @@ class AutomaticAim : public App {
   AimAssitant assitant_;
   Compensator compensator_;
   Behavior manager_;
+  DebugView view_{8000};
 
   game::Arm arm_ = game::Arm::kUNKNOWN;
 
@@ -26,10 +28,12 @@ class AutomaticAim : public App {
                          kPATH_RUNTIME + "RMUT2021_Buff.json",
                          kPATH_RUNTIME + "RMUT2022_Snipe.json",
                          kPATH_RUNTIME + "RMUT2022_Armor_Pre.json",
-                         kPATH_RUNTIME + "RMUT2022_Buff_Pre.json");
+                         kPATH_RUNTIME + "RMUT2022_Buff_Pre.json",
+                         kPATH_RUNTIME + "RMUL2022_Flow.json",
+                         kPATH_RUNTIME + "MV-CA016-10UC-6mm.json");
     assitant_.SetClassiferParam(kPATH_RUNTIME + "armor_classifier.onnx",
                                 kPATH_RUNTIME + "armor_classifier_lable.json",
-                                cv::Size(28, 28));
+                                cv::Size(28, 28), kPATH_RUNTIME + "template");
 
     compensator_.LoadCameraMat("runtime/MV-CA016-10UC-6mm.json");
   }
@@ -79,6 +83,8 @@ class AutomaticAim : public App {
       if (frame.empty()) continue;
 
       assitant_.SetRFID(robot_.GetRFID());
+      /* 飞行时间随距离缓慢变化，沿用上一帧补偿的结果 */
+      assitant_.SetFlightTime(compensator_.GetFlightTime());
       auto armors = assitant_.Aim(frame);
 
       if (armors.size() > 0) {
@@ -93,13 +99,15 @@ class AutomaticAim : public App {
         }
 
         manager_.Aim(armor.GetAimEuler());
-        assitant_.VisualizeResult(frame, 10);
         robot_.Pack(manager_.GetData(), armor.GetTransVec().at<double>(0, 2));
       }
 
-      cv::imshow("show", frame);
-      if (' ' == cv::waitKey(10)) {
-        cv::waitKey(0);
+      /* 绘制交给调试画面服务，不占用瞄准线程 */
+      if (view_.Active()) {
+        draw::DrawList list;
+        for (const auto& armor : armors) list.AddObject(armor);
+        list.AddLabel(game::ToString(assitant_.GetMethod()));
+        view_.Publish(frame, std::move(list));
       }
     }
   }
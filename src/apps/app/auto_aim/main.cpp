@@ -1,18 +1,28 @@
 #define async
 #ifdef async
 
+#include <algorithm>
+
 #include "app.hpp"
 #include "armor_classifier.hpp"
 #include "async_armor_detector.hpp"
 #include "behavior.hpp"
 #include "compensator.hpp"
+#include "debug_view.hpp"
 #include "hik_camera.hpp"
 #include "robot.hpp"
 
+namespace {
+
+const int kROI_LOST = 30; /* 连续多少帧没有结果后恢复全图 */
+
+}  // namespace
+
 class AutoAim : private App {
  private:
   Robot robot_;
   HikCamera cam_;
+  DebugView view_{8000};
   ArmorDetectorAsync detector_async_;
   Compensator compensator_;
   Behavior manager_;
@@ -20,6 +30,32 @@ class AutoAim : private App {
   component::Recorder recorder_ = component::Recorder("AutoAimThread");
   ArmorClassifier classifier_;
 
+  cv::Rect roi_;
+  int lost_ = 0;
+
+  /**
+   * @brief 只读出目标附近的半幅图像，传感器读出的行数减少，帧率提高
+   * 装甲板接近区域边缘时才重新设置，避免频繁重启采集
+   *
+   * @param armors 整幅图像坐标系下的装甲板
+   */
+  void TrackRegionOfInterest(const tbb::concurrent_vector<Armor>& armors) {
+    cv::Rect box = armors.front().GetRect().boundingRect();
+    for (const auto& armor : armors) box |= armor.GetRect().boundingRect();
+
+    const cv::Size size(kIMAGE_WIDTH / 2, kIMAGE_HEIGHT / 2);
+    const cv::Rect inner(roi_.x + size.width / 8, roi_.y + size.height / 8,
+                         size.width * 3 / 4, size.height * 3 / 4);
+    if (!roi_.empty() && (box & inner) == box) return;
+
+    const cv::Point center = (box.tl() + box.br()) / 2;
+    roi_ = cv::Rect(
+        std::clamp(center.x - size.width / 2, 0, kIMAGE_WIDTH - size.width),
+        std::clamp(center.y - size.height / 2, 0, kIMAGE_HEIGHT - size.height),
+        size.width, size.height);
+    cam_.SetRegionOfInterest(roi_);
+  }
+
  public:
   explicit AutoAim(const std::string& log_path)
       : App(log_path), detector_async_(ArmorDetectorAsync(2)) {
@@ -34,6 +70,9 @@ class AutoAim : private App {
     classifier_.LoadModel(kPATH_RUNTIME + "armor_classifier.onnx");
     classifier_.LoadLable(kPATH_RUNTIME + "armor_classifier_lable.json");
     classifier_.SetInputSize(cv::Size(28, 28));
+    classifier_.LoadTemplates(kPATH_RUNTIME + "armor_classifier_lable.json",
+                              kPATH_RUNTIME + "template");
+    detector_async_.SetDebugView(&view_);
 
     do {
       std::this_thread::sleep_for(std::chrono::milliseconds(100));
@@ -52,19 +91,29 @@ class AutoAim : private App {
   /* 运行的主程序 */
   void Run() {
     SPDLOG_WARN("***** Running Auto Aiming System. *****");
-    cv::Mat frame;
+    cv::Mat frame, source;
+    cv::Point2f origin, source_origin;
     tbb::concurrent_vector<Armor> armors;
     detector_async_.Start();
 
     while (1) {
-      if (!cam_.GetFrame(frame)) continue;
-
-      detector_async_.PutFrame(frame);
-      if (!detector_async_.GetResult(armors)) continue;
-
-      for (auto armor : armors) {
-        classifier_.ClassifyModel(armor, frame);
+      if (!cam_.GetFrame(frame, origin)) continue;
+
+      detector_async_.PutFrame(frame, origin);
+      if (!detector_async_.GetResult(armors, source, source_origin)) {
+        /* 目标丢失一段时间后恢复全图搜索 */
+        if (++lost_ == kROI_LOST && !roi_.empty()) {
+          roi_ = cv::Rect();
+          cam_.ResetRegionOfInterest();
+        }
+        continue;
       }
+      lost_ = 0;
+      TrackRegionOfInterest(armors);
+
+      /* 结果可能来自较早的帧，图案要从检测所用的帧中提取 */
+      FrameContext ctx(source, source_origin);
+      classifier_.ClassifyTracked(armors, ctx);
       compensator_.Apply(armors, robot_.GetBalletSpeed(), robot_.GetEuler(),
                          game::AimMethod::kARMOR);
       manager_.Aim(armors.front().GetAimEuler());
@@ -28,6 +28,7 @@ class BuffAim : private App {
     detector_.LoadParams(kPATH_RUNTIME + "RMUT2022_Buff.json");
     predictor_.LoadParams(kPATH_RUNTIME + "RMUT2022_Buff_Pre.json");
     compensator_.LoadCameraMat(kPATH_RUNTIME + "MV-CA016-10UC-6mm_2.json");
+    predictor_.LoadCameraMat(kPATH_RUNTIME + "MV-CA016-10UC-6mm_2.json");
 
     // do {
     //   std::this_thread::sleep_for(std::chrono::milliseconds(100));
@@ -58,6 +59,8 @@ class BuffAim : private App {
       auto buffs = detector_.Detect(frame);
       if (buffs.size() > 0) {
         predictor_.SetBuff(buffs.back());
+        /* 飞行时间随距离缓慢变化，沿用上一帧补偿的结果 */
+        predictor_.SetFlightTime(compensator_.GetFlightTime());
         auto armors = predictor_.Predict();
         auto armor = armors.front();
         SPDLOG_WARN("size : {}", armors.size());
@@ -26,6 +26,12 @@ class Radar : private App {
     cam_.Setup(kIMAGE_WIDTH, kIMAGE_HEIGHT);
     base_cam_.Setup(kIMAGE_WIDTH, kIMAGE_HEIGHT);
     outpost_cam_.Setup(kIMAGE_WIDTH, kIMAGE_HEIGHT);
+
+    /* 三个相机的画面一次推理，原分辨率分块以检测远处的小目标 */
+    nn::EngineOption option;
+    option.max_batch = 3;
+    detector_.LoadModel(kPATH_RUNTIME + "best.onnx", option);
+    detector_.SetTiling(true);
   }
 
   ~Radar() {
@@ -37,17 +43,15 @@ class Radar : private App {
   /* 运行的主程序 */
   void Run() {
     SPDLOG_WARN("***** Running Auto Aiming System. *****");
-    cv::Mat frame[3];
+    std::vector<cv::Mat> frames(3);
 
     while (1) {
-      cam_.GetFrame(frame[0]);
-      base_cam_.GetFrame(frame[1]);
-      outpost_cam_.GetFrame(frame[2]);
-
-      cv::Mat dst;
-      cv::hconcat(frame, 3, dst);
+      cam_.GetFrame(frames[0]);
+      base_cam_.GetFrame(frames[1]);
+      outpost_cam_.GetFrame(frames[2]);
 
-      auto alert = detector_.Detect(frame[0]);
+      game::Alert alert;
+      for (auto& camera_alert : detector_.Detect(frames)) alert |= camera_alert;
       manager_.SetNotice(alert);
       robot_.Pack(manager_.GetData(), 9999);
       if (' ' == cv::waitKey(10)) {
@@ -0,0 +1,39 @@
+#include "reorder_buffer.hpp"
+
+#include "gtest/gtest.h"
+
+TEST(TestComponent, TestReorderBuffer) {
+  component::ReorderBuffer<int> buffer;
+  int result;
+
+  const auto seq0 = buffer.Begin();
+  const auto seq1 = buffer.Begin();
+  const auto seq2 = buffer.Begin();
+  const auto seq3 = buffer.Begin();
+
+  /* 较新的帧先完成，需要等待更旧的帧 */
+  buffer.Complete(seq1, 1);
+  EXPECT_FALSE(buffer.Pop(result));
+
+  buffer.Complete(seq0, 0);
+  ASSERT_TRUE(buffer.Pop(result));
+  EXPECT_EQ(result, 0);
+  ASSERT_TRUE(buffer.Pop(result));
+  EXPECT_EQ(result, 1);
+
+  /* 放弃的序号不再阻塞后续结果 */
+  buffer.Complete(seq3, 3);
+  buffer.Cancel(seq2);
+  ASSERT_TRUE(buffer.Pop(result));
+  EXPECT_EQ(result, 3);
+
+  /* 比已输出结果更旧的结果被丢弃 */
+  const auto seq4 = buffer.Begin();
+  const auto seq5 = buffer.Begin();
+  buffer.Cancel(seq4);
+  buffer.Complete(seq5, 5);
+  ASSERT_TRUE(buffer.Pop(result));
+  buffer.Complete(seq4, 4);
+  EXPECT_FALSE(buffer.Pop(result));
+  EXPECT_EQ(buffer.InFlight(), 0u);
+}
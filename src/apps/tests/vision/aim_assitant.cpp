@@ -0,0 +1,48 @@
+#include "aim_assitant.hpp"
+
+#include "gtest/gtest.h"
+#include "log.hpp"
+#include "opencv2/opencv.hpp"
+
+namespace {
+
+/* 画面中央一对蓝色灯条 */
+cv::Mat ArmorFrame() {
+  cv::Mat frame(480, 640, CV_8UC3, cv::Scalar(0, 0, 0));
+  for (float x : {290.f, 350.f}) {
+    cv::Point2f vertices[4];
+    cv::RotatedRect(cv::Point2f(x, 240.f), cv::Size2f(6, 36), -3.f)
+        .points(vertices);
+    std::vector<cv::Point> polygon(vertices, vertices + 4);
+    cv::fillConvexPoly(frame, polygon, cv::Scalar(255, 0, 0));
+  }
+  return frame;
+}
+
+}  // namespace
+
+TEST(TestVision, TestAimAssitantArmor) {
+  component::logger::SetLogger();
+  AimAssitant assitant(game::Arm::kINFANTRY);
+  assitant.LoadParams(kPATH_RUNTIME + "RMUL2021_Armor.json",
+                      kPATH_RUNTIME + "RMUT2021_Buff.json",
+                      kPATH_RUNTIME + "RMUT2022_Snipe.json",
+                      kPATH_RUNTIME + "RMUT2022_Armor_Pre.json",
+                      kPATH_RUNTIME + "RMUT2022_Buff_Pre.json",
+                      kPATH_RUNTIME + "RMUL2022_Flow.json",
+                      kPATH_RUNTIME + "MV-CA016-10UC-6mm.json");
+  assitant.SetClassiferParam(kPATH_RUNTIME + "armor_classifier.onnx",
+                             kPATH_RUNTIME + "armor_classifier_lable.json",
+                             cv::Size(28, 28), kPATH_RUNTIME + "template");
+  assitant.SetEnemyTeam(game::Team::kBLUE);
+  assitant.SetRFID(game::RFID::kUNKNOWN);
+  ASSERT_EQ(assitant.GetMethod(), game::AimMethod::kARMOR);
+
+  /* 第二帧由光流跟踪且分类缓存命中，装甲板没有经过 Face */
+  const cv::Mat frame = ArmorFrame();
+  EXPECT_NO_THROW(assitant.Aim(frame));
+  tbb::concurrent_vector<Armor> armors;
+  EXPECT_NO_THROW(armors = assitant.Aim(frame));
+  ASSERT_EQ(armors.size(), 1u);
+  EXPECT_NEAR(armors.front().ImageCenter().x, 320., 5.);
+}
@@ -0,0 +1,30 @@
+#include "angle_history.hpp"
+
+#include <cmath>
+
+#include "gtest/gtest.h"
+
+TEST(TestVision, TestAngleHistory) {
+  AngleHistory history;
+  const double speed = 1., acc = 0.5;
+
+  /* 模拟检测器给出的角度，范围 [-pi, pi)，中途切换一次扇叶 */
+  for (int i = 0; i <= 200; ++i) {
+    const double t = i * 0.01;
+    double theta = speed * t + acc * t * t / 2.;
+    if (i > 150) theta += 2. * M_PI / 5.;
+    history.Push(t, std::remainder(theta, 2. * M_PI));
+  }
+
+  EXPECT_EQ(history.Size(), AngleHistory::kCAPACITY);
+  EXPECT_EQ(history.GetDirection(), component::Direction::kCCW);
+  EXPECT_NEAR(history.Theta(), speed * 2. + acc * 2., 1e-6);
+  EXPECT_NEAR(history.Acceleration(), acc, 1e-3);
+  EXPECT_NEAR(history.Speed(), speed + acc * 2., 1e-2);
+
+  history.Reset();
+  for (int i = 0; i <= 20; ++i)
+    history.Push(i * 0.01, std::remainder(-i * 0.01, 2. * M_PI));
+  EXPECT_EQ(history.GetDirection(), component::Direction::kCW);
+  EXPECT_NEAR(history.MeanSpeed(), -1., 1e-6);
+}
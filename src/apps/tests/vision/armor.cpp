@@ -2,6 +2,7 @@
 
 #include "gtest/gtest.h"
 #include "light_bar.hpp"
+#include "opencv2/dnn.hpp"
 #include "opencv2/opencv.hpp"
 
 TEST(TestVision, TestArmor) {
@@ -23,3 +24,45 @@ TEST(TestVision, TestArmor) {
   armor.SetModel(model);
   ASSERT_TRUE(armor.GetModel() == model);
 }
+
+TEST(TestVision, TestArmorFaceBlob) {
+  cv::Mat frame(480, 640, CV_8UC3, cv::Scalar(20, 20, 20));
+  cv::rectangle(frame, cv::Rect(305, 200, 30, 80), cv::Scalar(230, 230, 230),
+                cv::FILLED);
+  Armor armor(cv::RotatedRect(cv::Point2f(320, 240), cv::Size2f(135, 125), 0));
+  FrameContext ctx(frame);
+
+  /* 直接提取的结果与先提取图案再缩放的结果基本一致 */
+  const cv::Size input_size(28, 28);
+  cv::Mat expected;
+  cv::dnn::blobFromImage(armor.Face(ctx), expected, 1. / 128., input_size);
+  cv::Mat blob(input_size, CV_32F);
+  armor.FaceBlob(ctx, input_size, 1. / 128., blob.ptr<float>());
+
+  expected = expected.reshape(1, input_size.height);
+  cv::Mat diff = cv::abs(blob - expected) > 1.;
+  EXPECT_LT(cv::countNonZero(diff), input_size.area() / 20);
+
+  /* 二值化后只有两种取值 */
+  for (int i = 0; i < blob.rows; ++i)
+    for (int j = 0; j < blob.cols; ++j)
+      EXPECT_TRUE(blob.at<float>(i, j) == 0.f ||
+                  blob.at<float>(i, j) == static_cast<float>(255. / 128.));
+}
+
+TEST(TestVision, TestArmorFaceRoi) {
+  cv::Mat frame(480, 640, CV_8UC3, cv::Scalar(20, 20, 20));
+  cv::putText(frame, "3", cv::Point(430, 300), cv::FONT_HERSHEY_SIMPLEX, 3.,
+              cv::Scalar(230, 230, 230), 10);
+  const cv::Rect roi(300, 150, 300, 250);
+  FrameContext full_ctx(frame);
+  FrameContext roi_ctx(frame(roi), roi.tl());
+
+  /* 装甲板为整幅图像坐标，感兴趣区域中提取的图案应与整幅图像一致 */
+  Armor armor(cv::RotatedRect(cv::Point2f(460, 275), cv::Size2f(135, 125), 0));
+  const cv::Size size(28, 28);
+  const cv::Mat expected = armor.Face(full_ctx, size);
+  EXPECT_GT(cv::countNonZero(expected), 0);
+  EXPECT_EQ(cv::countNonZero(armor.Face(roi_ctx, size) != expected), 0);
+  EXPECT_EQ(cv::countNonZero(armor.Face(roi_ctx) != armor.Face(full_ctx)), 0);
+}
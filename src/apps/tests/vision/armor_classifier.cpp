@@ -49,3 +49,51 @@ TEST(TestVision, TestArmorClassifierInput) {
   cv::resize(armor.Face(f), nn_input, cv::Size(28, 28));
   cv::imwrite(kPATH_IMAGE + "test_nn_input.png", nn_input);
 }
+
+TEST(TestVision, TestArmorClassifierBatch) {
+  if (!algo::FileExist(kPATH_IMAGE + "test_classifier_0.png")) return;
+
+  cv::Mat f = cv::imread(kPATH_IMAGE + "test_classifier_0.png");
+  tbb::concurrent_vector<Armor> armors(
+      3, Armor(cv::RotatedRect(cv::Point2f(0, 0), cv::Point2f(f.cols, 0),
+                               cv::Point2f(f.cols, f.rows))));
+  armor_classifier.ClassifyBatch(armors, f);
+
+  Armor single = armors.front();
+  armor_classifier.ClassifyModel(single, f);
+  for (auto& armor : armors) {
+    EXPECT_EQ(armor.GetModel(), single.GetModel());
+    EXPECT_NEAR(armor.GetModelConf(), single.GetModelConf(), 1e-4);
+  }
+}
+
+TEST(TestVision, TestArmorClassifierTemplate) {
+  cv::Mat digit = cv::imread(kPATH_RUNTIME + "template/2.png");
+  if (digit.empty()) GTEST_SKIP();
+
+  /* 小装甲板的中间正方形正好是以中心为中心的 125x125 区域 */
+  cv::Mat frame(480, 640, CV_8UC3, cv::Scalar(0, 0, 0));
+  digit.copyTo(frame(cv::Rect(258, 178, 125, 125)));
+  FrameContext ctx(frame);
+
+  /* 没有模型时退回到模板匹配 */
+  ArmorClassifier classifier;
+  classifier.LoadLable(kPATH_RUNTIME + "armor_classifier_lable.json");
+  classifier.SetInputSize(cv::Size(28, 28));
+  ASSERT_TRUE(
+      classifier.LoadTemplates(kPATH_RUNTIME + "armor_classifier_lable.json",
+                               kPATH_RUNTIME + "template"));
+
+  tbb::concurrent_vector<Armor> armors(
+      2, Armor(cv::RotatedRect(cv::Point2f(320, 240), cv::Size2f(135, 125),
+                               0)));
+  classifier.ClassifyBatch(armors, ctx);
+  for (const auto& armor : armors) {
+    EXPECT_EQ(armor.GetModel(), game::Model::kENGINEER);
+    EXPECT_GT(armor.GetModelConf(), 0.75);
+  }
+
+  Armor single = armors.front();
+  classifier.ClassifyModel(single, ctx);
+  EXPECT_EQ(single.GetModel(), game::Model::kENGINEER);
+}
@@ -0,0 +1,128 @@
+#include "armor_tracker.hpp"
+
+#include <chrono>
+
+#include "armor_predictor.hpp"
+#include "gtest/gtest.h"
+#include "log.hpp"
+
+namespace {
+
+const double kDT = 0.03;
+
+/* 两个反向匀速运动的装甲板 */
+cv::Point2d PositionA(int frame) { return {100. + 300. * kDT * frame, 240.}; }
+cv::Point2d PositionB(int frame) { return {500. - 150. * kDT * frame, 260.}; }
+
+/* 第 frame 帧的时间戳 */
+std::chrono::steady_clock::time_point Stamp(int frame) {
+  return std::chrono::steady_clock::time_point() +
+         std::chrono::microseconds(static_cast<int>(kDT * 1e6) * frame);
+}
+
+Armor At(const cv::Point2d &center) {
+  return Armor(cv::RotatedRect(center, cv::Size2f(60, 30), 0));
+}
+
+}  // namespace
+
+TEST(TestVision, TestArmorTracker) {
+  component::logger::SetLogger();
+  ArmorTracker tracker(13.8, 3, 10);
+  int frame = 0;
+  auto step = [&](bool a, bool b, bool swap = false) {
+    tbb::concurrent_vector<Armor> armors;
+    if (a) armors.emplace_back(At(PositionA(frame)));
+    if (b) armors.emplace_back(At(PositionB(frame)));
+    if (swap) std::swap(armors[0], armors[1]);
+    tracker.Update(armors, kDT);
+    ++frame;
+  };
+
+  step(true, true);
+  ASSERT_EQ(tracker.GetTracks().size(), 2u);
+  const int id_a = tracker.TrackOf(0), id_b = tracker.TrackOf(1);
+  EXPECT_NE(id_a, id_b);
+  EXPECT_EQ(tracker.Find(id_a)->state, ArmorTracker::State::kTENTATIVE);
+
+  /* 连续关联后确认，编号不随装甲板顺序变化 */
+  step(true, true);
+  step(true, true, true);
+  EXPECT_EQ(tracker.TrackOf(0), id_b);
+  EXPECT_EQ(tracker.TrackOf(1), id_a);
+  EXPECT_EQ(tracker.Find(id_a)->state, ArmorTracker::State::kCONFIRMED);
+  for (int i = 0; i < 20; ++i) step(true, true);
+  EXPECT_NEAR(tracker.Find(id_a)->Velocity().x, 300., 10.);
+  EXPECT_NEAR(tracker.Find(id_b)->Velocity().x, -150., 10.);
+
+  /* A 短暂丢失时继续外推，重新出现后沿用原编号 */
+  for (int i = 0; i < 5; ++i) step(false, true);
+  const ArmorTracker::Track *lost = tracker.Find(id_a);
+  ASSERT_NE(lost, nullptr);
+  EXPECT_EQ(lost->state, ArmorTracker::State::kLOST);
+  EXPECT_NEAR(lost->Position().x, PositionA(frame - 1).x, 2.);
+  step(true, true);
+  EXPECT_EQ(tracker.TrackOf(0), id_a);
+  EXPECT_EQ(tracker.Find(id_a)->state, ArmorTracker::State::kCONFIRMED);
+  EXPECT_EQ(tracker.GetTracks().size(), 2u);
+
+  /* B 丢失超过外推帧数后删除 */
+  for (int i = 0; i < 11; ++i) step(true, false);
+  EXPECT_EQ(tracker.Find(id_b), nullptr);
+  EXPECT_NE(tracker.Find(id_a), nullptr);
+
+  /* 只出现一帧的误检不会被确认 */
+  tbb::concurrent_vector<Armor> armors{At(PositionA(frame)), At({320., 50.})};
+  tracker.Update(armors, kDT);
+  ++frame;
+  const int spurious = tracker.TrackOf(1);
+  EXPECT_EQ(tracker.Find(spurious)->state, ArmorTracker::State::kTENTATIVE);
+  step(true, false);
+  EXPECT_EQ(tracker.Find(spurious), nullptr);
+}
+
+TEST(TestVision, TestArmorPredictorSwitch) {
+  component::logger::SetLogger();
+  ArmorPredictor predictor;
+  int frame = 0;
+  for (; frame < 20; ++frame) {
+    predictor.SetArmors({At(PositionA(frame)), At(PositionB(frame))},
+                        Stamp(frame));
+    /* 第二帧起就给出预测 */
+    EXPECT_EQ(predictor.Predict().size(), frame > 0 ? 1u : 0u);
+  }
+  const int id_a = predictor.GetTargetId();
+  EXPECT_GE(id_a, 0);
+
+  /* 目标消失后立即切换到已收敛的 B */
+  predictor.SetArmors({At(PositionB(frame))}, Stamp(frame));
+  const auto &predicts = predictor.Predict();
+  EXPECT_NE(predictor.GetTargetId(), id_a);
+  ASSERT_EQ(predicts.size(), 1u);
+  EXPECT_NEAR(predicts.front().GetRect().center.x, PositionB(frame).x, 1.);
+  EXPECT_NEAR(predicts.front().GetRect().center.y, PositionB(frame).y, 1.);
+}
+
+TEST(TestVision, TestArmorPredictorFrameTime) {
+  component::logger::SetLogger();
+  ArmorPredictor predictor;
+  const auto start = std::chrono::steady_clock::now();
+  auto stamp = [&](double t) {
+    return start + std::chrono::microseconds(static_cast<int>(t * 1e6));
+  };
+
+  /* 帧间隔在 10 ms 与 50 ms 之间交替 */
+  double t = 0.;
+  for (int i = 0; i < 30; ++i) {
+    t += i % 2 ? 0.05 : 0.01;
+    predictor.SetArmor(At({100. + 300. * t, 240.}), stamp(t));
+    predictor.Predict();
+  }
+
+  /* 目标丢失时按测得的帧间隔外推 */
+  t += 0.05;
+  predictor.SetArmor(At({320., 50.}), stamp(t));
+  const auto &predicts = predictor.Predict();
+  ASSERT_EQ(predicts.size(), 1u);
+  EXPECT_NEAR(predicts.front().GetRect().center.x, 100. + 300. * t, 2.);
+}
@@ -19,6 +19,26 @@ TEST(TestVision, TestBuffDetector) {
   SUCCEED();
 }
 
+TEST(TestVision, TestBuffDetectorPolar) {
+  BuffDetector buff_detector(kPATH_RUNTIME + "RMUT2021_Buff.json",
+                             game::Team::kBLUE);
+
+  if (!algo::FileExist(kPATH_IMAGE + "test_buff.png"))
+    GTEST_SKIP() << "Missing test_buff.png.";
+  cv::Mat frame = cv::imread(kPATH_IMAGE + "test_buff.png", cv::IMREAD_COLOR);
+  ASSERT_FALSE(frame.empty()) << "Can not opening image.";
+
+  /* 第一帧全图搜索，之后同一帧走环带跟踪，结果应一致 */
+  auto full = buff_detector.Detect(frame);
+  if (full.empty()) GTEST_SKIP() << "No buff found in test_buff.png.";
+  auto polar = buff_detector.Detect(frame);
+  ASSERT_EQ(polar.size(), 1);
+  EXPECT_LT(cv::norm(polar[0].GetCenter() - full[0].GetCenter()), 2.);
+  EXPECT_LT(cv::norm(polar[0].GetTarget().ImageCenter() -
+                     full[0].GetTarget().ImageCenter()),
+            5.);
+}
+
 TEST(TestVision, TestBuffDetectorVideo) {
   BuffDetector buff_detector(kPATH_RUNTIME + "RMUT2021_Buff.json",
                              game::Team::kBLUE);
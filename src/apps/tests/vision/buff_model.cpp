@@ -0,0 +1,71 @@
+#include "buff_model.hpp"
+
+#include <cmath>
+
+#include "gtest/gtest.h"
+#include "log.hpp"
+#include "opencv2/opencv.hpp"
+
+namespace {
+
+const std::string kCAM_MAT(kPATH_RUNTIME + "MV-CA016-10UC-6mm_2.json");
+
+const double kRADIUS = 700.;
+const cv::Vec3d kROT_VEC(0.1, -0.2, 0.);
+const cv::Vec3d kCENTER(200., -400., 6000.);
+
+/* 按真实平面位姿投影，生成一帧检测结果 */
+Buff MakeBuff(double angle, const cv::Mat &cam_mat, const cv::Mat &distor) {
+  const cv::Vec3d radial(std::cos(angle), std::sin(angle), 0.);
+  const cv::Vec3d tangent(-radial[1], radial[0], 0.);
+  const cv::Vec3d target = kRADIUS * radial;
+  std::vector<cv::Point3d> points{
+      target - 115. * tangent + 62.5 * radial,
+      target + 115. * tangent + 62.5 * radial,
+      target + 115. * tangent - 62.5 * radial,
+      target - 115. * tangent - 62.5 * radial,
+      cv::Point3d(0., 0., 0.),
+  };
+  std::vector<cv::Point2f> image;
+  cv::projectPoints(points, kROT_VEC, kCENTER, cam_mat, distor, image);
+
+  Buff buff;
+  buff.SetCenter(image.back());
+  image.pop_back();
+  Armor armor(cv::minAreaRect(image));
+  armor.SetModel(game::Model::kBUFF);
+  buff.SetTarget(armor);
+  return buff;
+}
+
+}  // namespace
+
+TEST(TestVision, TestBuffModel) {
+  component::logger::SetLogger();
+  cv::FileStorage fs(kCAM_MAT,
+                     cv::FileStorage::READ | cv::FileStorage::FORMAT_JSON);
+  if (!fs.isOpened()) return;
+  const cv::Mat cam_mat = fs["cam_mat"].mat();
+  const cv::Mat distor = fs["distor_coff"].mat();
+
+  BuffModel model;
+  model.LoadCameraMat(kCAM_MAT);
+  ASSERT_TRUE(model.Update(MakeBuff(0.5, cam_mat, distor)));
+  ASSERT_TRUE(model.Ready());
+  EXPECT_NEAR(model.Angle(), 0.5, 0.05);
+
+  /* 之后每帧只求扇叶角度 */
+  for (double angle = 0.5; angle < 2.; angle += 0.1)
+    ASSERT_TRUE(model.Update(MakeBuff(angle, cam_mat, distor)));
+  EXPECT_NEAR(model.Angle(), 1.9, 0.05);
+  EXPECT_NEAR(model.Radius(), kRADIUS, 50.);
+
+  /* 预测点应与真实位置的投影重合 */
+  const double angle = 2.4;
+  Armor predict = model.Predict(angle);
+  Buff truth = MakeBuff(angle, cam_mat, distor);
+  EXPECT_LT(cv::norm(predict.ImageCenter() - truth.GetTarget().ImageCenter()),
+            5.);
+  ASSERT_FALSE(predict.GetTransVec().empty());
+  EXPECT_NEAR(predict.GetTransVec().at<double>(2, 0), kCENTER[2], 300.);
+}
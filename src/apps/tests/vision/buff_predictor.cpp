@@ -1,6 +1,9 @@
 
 #include "buff_predictor.hpp"
 
+#include <cmath>
+#include <thread>
+
 #include "armor_detector.hpp"
 #include "buff_detector.hpp"
 #include "gtest/gtest.h"
@@ -12,6 +15,24 @@ namespace {
 const std::string kPARAM_DETECT(kPATH_RUNTIME + "RMUT2021_Buff.json");
 const std::string kPARAM_PREDICT(kPATH_RUNTIME + "RMUT2022_Buff_Pre.json");
 
+const cv::Point2f kCENTER(640., 512.);
+const double kRADIUS = 300.;
+
+/* 扇叶在 angle 处的一帧检测结果 */
+Buff MakeBuff(double angle) {
+  const cv::Point2f target(kCENTER.x + kRADIUS * std::cos(angle),
+                           kCENTER.y - kRADIUS * std::sin(angle));
+  Buff buff;
+  buff.SetCenter(kCENTER);
+  buff.SetTarget(Armor(cv::RotatedRect(target, cv::Size2f(120, 60),
+                                       -angle * 180. / M_PI)));
+  return buff;
+}
+
+double Angle(const cv::Point2f &point) {
+  return std::atan2(-(point.y - kCENTER.y), point.x - kCENTER.x);
+}
+
 }  // namespace
 
 TEST(TestVision, TestKalmanPredictor) {
@@ -56,3 +77,79 @@ TEST(TestVision, TestKalmanPredictor) {
   cv::destroyAllWindows();
   cap.release();
 }
+
+TEST(TestVision, TestBuffPredictorFlightTime) {
+  component::logger::SetLogger();
+  BuffPredictor predictor(kPARAM_PREDICT);
+  predictor.SetState(game::BuffState::kSMALL);
+
+  /* 约每秒 1 弧度匀速旋转 */
+  double angle = 0.;
+  for (int i = 0; i < 15; ++i, angle += 0.01) {
+    predictor.SetBuff(MakeBuff(angle));
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  predictor.SetBuff(MakeBuff(angle));
+
+  auto lead = [&](double flight_time) {
+    predictor.SetFlightTime(flight_time);
+    const auto &predicts = predictor.Predict();
+    return std::abs(std::remainder(
+        Angle(predicts.front().ImageCenter()) - angle, 2. * M_PI));
+  };
+
+  /* 提前量应包含弹丸飞行时间 */
+  const double base = lead(0.);
+  const double flight = lead(0.5);
+  EXPECT_GT(base, 0.);
+  EXPECT_GT(flight, 2. * base);
+}
+
+TEST(TestVision, TestBuffPredictorCenter) {
+  component::logger::SetLogger();
+  BuffPredictor predictor(kPARAM_PREDICT);
+  predictor.SetState(game::BuffState::kSMALL);
+
+  /* 中心检测结果在 ±3 像素内抖动 */
+  cv::RNG rng(0);
+  double angle = 0., raw = 0., smooth = 0.;
+  for (int i = 0; i < 40; ++i, angle += 0.01) {
+    const cv::Point2f noise(rng.uniform(-3.f, 3.f), rng.uniform(-3.f, 3.f));
+    Buff buff = MakeBuff(angle);
+    buff.SetCenter(kCENTER + noise);
+    predictor.SetBuff(buff);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    /* 跳过起始阶段，比较平滑前后中心的误差 */
+    if (i < 10) continue;
+    const auto &x = predictor.filter_.GetState();
+    raw += noise.dot(noise);
+    const cv::Point2d error = cv::Point2d(x(0), x(2)) - cv::Point2d(kCENTER);
+    smooth += error.dot(error);
+  }
+  EXPECT_LT(smooth, raw);
+}
+
+TEST(TestVision, TestBuffPredictorStateReset) {
+  component::logger::SetLogger();
+  BuffPredictor predictor(kPARAM_PREDICT);
+  predictor.SetState(game::BuffState::kSMALL);
+
+  double angle = 0.;
+  for (int i = 0; i < 15; ++i, angle += 0.01) {
+    predictor.SetBuff(MakeBuff(angle));
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  predictor.SetBuff(MakeBuff(angle));
+
+  auto lead = [&]() {
+    const auto &predicts = predictor.Predict();
+    return std::abs(std::remainder(
+        Angle(predicts.front().ImageCenter()) - angle, 2. * M_PI));
+  };
+  EXPECT_GT(lead(), 0.);
+
+  /* 切换为大符后小符的样本不再参与转速估计 */
+  predictor.SetState(game::BuffState::kBIG);
+  EXPECT_NEAR(lead(), 0., 1e-3);
+}
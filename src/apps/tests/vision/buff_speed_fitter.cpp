@@ -0,0 +1,34 @@
+#include "buff_speed_fitter.hpp"
+
+#include <cmath>
+
+#include "gtest/gtest.h"
+#include "log.hpp"
+
+namespace {
+
+const double kA = 0.9;
+const double kW = 1.95;
+const double kPHI = 0.5;
+const double kB = 2.090 - kA;
+
+double Theta(double t) { return kB * t - kA / kW * std::cos(kW * t + kPHI); }
+
+}  // namespace
+
+TEST(TestVision, TestBuffSpeedFitter) {
+  component::logger::SetLogger();
+  BuffSpeedFitter fitter;
+  fitter.SetTimeBudget(0.5);
+
+  for (double t = 0.; t < 3.; t += 0.01) fitter.AddSample(t, Theta(t) + 1.);
+
+  ASSERT_TRUE(fitter.Fit());
+  ASSERT_TRUE(fitter.Ready());
+
+  auto params = fitter.GetParams();
+  EXPECT_NEAR(params.a, kA, 0.05);
+  EXPECT_NEAR(params.w, kW, 0.05);
+  EXPECT_NEAR(fitter.Speed(3.), kA * std::sin(kW * 3. + kPHI) + kB, 0.05);
+  EXPECT_NEAR(fitter.Integrate(3., 0.3), Theta(3.3) - Theta(3.), 0.02);
+}
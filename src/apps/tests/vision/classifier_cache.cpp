@@ -0,0 +1,67 @@
+#include "classifier_cache.hpp"
+
+#include "gtest/gtest.h"
+#include "log.hpp"
+
+namespace {
+
+Armor MakeArmor(float x, float y) {
+  return Armor(cv::RotatedRect(cv::Point2f(x, y), cv::Size2f(60, 25), 0));
+}
+
+/* 模拟网络输出：按横坐标给出型号 */
+void Classify(tbb::concurrent_vector<Armor> &armors,
+              const std::vector<std::size_t> &pending, double conf) {
+  for (std::size_t i : pending) {
+    armors[i].SetModel(armors[i].GetRect().center.x < 500.f
+                           ? game::Model::kINFANTRY
+                           : game::Model::kHERO);
+    armors[i].SetModelConf(conf);
+  }
+}
+
+}  // namespace
+
+TEST(TestVision, TestClassifierCache) {
+  component::logger::SetLogger();
+  ClassifierCache cache(0.8, 5);
+
+  tbb::concurrent_vector<Armor> armors{MakeArmor(100, 100),
+                                       MakeArmor(800, 300)};
+  auto pending = cache.Lookup(armors);
+  ASSERT_EQ(pending.size(), 2u);
+  Classify(armors, pending, 0.9);
+  cache.Update(armors, pending);
+
+  /* 稳定跟踪时全部命中，刷新间隔到期后重新分类 */
+  for (int frame = 1; frame < 5; ++frame) {
+    armors = {MakeArmor(100 + frame * 3, 100), MakeArmor(800, 300 - frame)};
+    pending = cache.Lookup(armors);
+    EXPECT_TRUE(pending.empty());
+    EXPECT_EQ(armors[0].GetModel(), game::Model::kINFANTRY);
+    EXPECT_EQ(armors[1].GetModel(), game::Model::kHERO);
+    EXPECT_DOUBLE_EQ(armors[1].GetModelConf(), 0.9);
+    cache.Update(armors, pending);
+  }
+  armors = {MakeArmor(115, 100), MakeArmor(800, 295)};
+  pending = cache.Lookup(armors);
+  EXPECT_EQ(pending.size(), 2u);
+  Classify(armors, pending, 0.5);
+  cache.Update(armors, pending);
+
+  /* 置信度低的结果不复用，新出现的装甲板需要分类 */
+  armors = {MakeArmor(118, 100), MakeArmor(800, 295), MakeArmor(400, 400)};
+  pending = cache.Lookup(armors);
+  EXPECT_EQ(pending.size(), 3u);
+  Classify(armors, pending, 0.95);
+  cache.Update(armors, pending);
+
+  armors = {MakeArmor(400, 402)};
+  pending = cache.Lookup(armors);
+  EXPECT_TRUE(pending.empty());
+  EXPECT_EQ(armors[0].GetModel(), game::Model::kINFANTRY);
+  cache.Update(armors, pending);
+
+  /* 16 次查询中 9 次命中 */
+  EXPECT_NEAR(cache.HitRate(), 9. / 16., 1e-9);
+}
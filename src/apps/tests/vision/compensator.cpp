@@ -2,7 +2,38 @@
 
 #include "gtest/gtest.h"
 
+namespace {
+
+const std::string kCAM_MAT(kPATH_RUNTIME + "MV-CA016-10UC-6mm.json");
+
+}  // namespace
+
 TEST(TestVision, TestCompensator) {
   Compensator compensator;
   ASSERT_EQ(1, 1);
 }
+
+TEST(TestVision, TestCompensatorBuffPnp) {
+  cv::FileStorage fs(kCAM_MAT,
+                     cv::FileStorage::READ | cv::FileStorage::FORMAT_JSON);
+  if (!fs.isOpened()) GTEST_SKIP() << "Missing camera matrix.";
+  const cv::Mat cam_mat = fs["cam_mat"].mat();
+  const cv::Mat distor = fs["distor_coff"].mat();
+
+  /* 绕光轴转动的扇叶装甲板，只有外接矩形的角点 */
+  Armor model;
+  model.SetModel(game::Model::kBUFF);
+  const cv::Vec3d rot_vec(0., 0., 0.5), trans_vec(100., -50., 5000.);
+  std::vector<cv::Point2f> image;
+  cv::projectPoints(model.PhysicVertices(), rot_vec, trans_vec, cam_mat,
+                    distor, image);
+  Armor armor(cv::minAreaRect(image));
+  armor.SetModel(game::Model::kBUFF);
+
+  Compensator compensator(kCAM_MAT, game::Arm::kINFANTRY);
+  compensator.PnpEstimate(armor);
+  const cv::Mat trans = armor.GetTransVec();
+  ASSERT_FALSE(trans.empty());
+  EXPECT_NEAR(trans.at<double>(0, 0), trans_vec[0], 20.);
+  EXPECT_NEAR(trans.at<double>(2, 0), trans_vec[2], 100.);
+}
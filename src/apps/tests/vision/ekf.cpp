@@ -1,51 +1,131 @@
 #include "ekf.hpp"
 
-#include "buff_detector.hpp"
+#include <random>
+
 #include "gtest/gtest.h"
 #include "log.hpp"
-#include "opencv2/opencv.hpp"
-#include "spdlog/spdlog.h"
+#include "timer.hpp"
 
 namespace {
 
-const std::vector<cv::Point2d> points = {
-    cv::Point2d(50., 50.),  cv::Point2d(100., 50.),  cv::Point2d(150., 50.),
-    cv::Point2d(200., 50.), cv::Point2d(250., 50.),  cv::Point2d(300., 50.),
-    cv::Point2d(350., 50.), cv::Point2d(400., 50.),  cv::Point2d(450., 50.),
-    cv::Point2d(500., 50.), cv::Point2d(550., 50.),  cv::Point2d(600., 50.),
-    cv::Point2d(650., 50.), cv::Point2d(700., 50.),  cv::Point2d(750., 50.),
-    cv::Point2d(800., 50.), cv::Point2d(850., 50.),  cv::Point2d(900., 50.),
-    cv::Point2d(950., 50.), cv::Point2d(1000., 50.), cv::Point2d(1050., 50.)};
+const int kSTEPS = 2000;
+
+using CV2 = EKF<ekf::ConstantVelocity<2>, ekf::Position<2>>;
+using CTRV = EKF<ekf::ConstantTurnRate, ekf::TurnRatePosition>;
 
-const std::string kVIDEO = "../../../../../../redbuff01.avi";
-const std::string kPARAM = kPATH_RUNTIME + "RMUT2021_Buff.json";
+/* 模拟 IMU 频率不均匀的时间间隔 */
+double StepTime(int i) { return i % 3 == 0 ? 0.002 : 0.006; }
 
 }  // namespace
 
+TEST(TestVision, TestEKFJacobian) {
+  /* 自动求导与数值差分一致 */
+  CTRV filter;
+  CTRV::State x;
+  x << 1., 2., 3., 0.4, 0.5;
+  filter.Init(x, CTRV::StateMatrix::Identity());
+  const double dt = 0.1;
+  filter.Predict(dt);
+  const auto &F = filter.GetProcessJacobian();
+
+  const ekf::ConstantTurnRate model;
+  const double kEPS = 1e-6;
+  for (int j = 0; j < CTRV::kSTATES; ++j) {
+    CTRV::State lo = x, hi = x, y_lo, y_hi;
+    lo(j) -= kEPS;
+    hi(j) += kEPS;
+    model(lo.data(), dt, y_lo.data());
+    model(hi.data(), dt, y_hi.data());
+    const CTRV::State numeric = (y_hi - y_lo) / (2. * kEPS);
+    for (int i = 0; i < CTRV::kSTATES; ++i)
+      EXPECT_NEAR(F(i, j), numeric(i), 1e-6);
+  }
+
+  /* 角速度为 0 时退化为直线运动 */
+  x(4) = 0.;
+  CTRV::State y;
+  model(x.data(), dt, y.data());
+  EXPECT_NEAR(y(0), 1. + 3. * dt * std::cos(0.4), 1e-12);
+  EXPECT_NEAR(y(1), 2. + 3. * dt * std::sin(0.4), 1e-12);
+}
+
 TEST(TestVision, TestEKF) {
   component::logger::SetLogger();
-  EKF filter;
-  SPDLOG_WARN("Filter");
-  cv::Mat predict_mat;
-  cv::Mat img(300, 1200, CV_8UC3, cv::Scalar(0, 0, 0));
-
-  for (auto& pt : points) {
-    cv::Mat point_mat(pt);
-    predict_mat = filter.Predict(point_mat);
-    SPDLOG_WARN("Predicted");
-    cv::Point2d predict_pt(predict_mat.at<double>(0, 0),
-                           predict_mat.at<double>(0, 1));
-    filter.Update(predict_mat);
-    cv::circle(img, pt, 3, draw::kBLUE, 2);
-    cv::circle(img, predict_pt, 3, draw::kGREEN, 2);
-#if WITH_UI
-    cv::imshow("img", img);
-    cv::waitKey(0);
+  CV2 filter;
+  filter.SetProcessNoise(CV2::StateMatrix::Identity());
+  filter.SetMeasurementNoise(CV2::MeasurementCov::Identity() * 1e-2);
+
+  std::mt19937 gen(7);
+  std::normal_distribution<double> dist(0., 0.1);
+  double t = 0.;
+  for (int i = 0; i < kSTEPS; ++i) {
+    const double dt = StepTime(i);
+    t += dt;
+    filter.Predict(dt);
+    filter.Update(CV2::Measurement(5. * t + dist(gen), -2. * t + dist(gen)));
   }
-#else
-    continue;
+  const auto &x = filter.GetState();
+  EXPECT_NEAR(x(0), 5. * t, 0.1);
+  EXPECT_NEAR(x(1), 5., 0.3);
+  EXPECT_NEAR(x(2), -2. * t, 0.1);
+  EXPECT_NEAR(x(3), -2., 0.3);
+
+  const auto &P = filter.GetCovariance();
+  EXPECT_LT((P - P.transpose()).cwiseAbs().maxCoeff(), 1e-9);
+  EXPECT_GT(P.ldlt().vectorD().minCoeff(), 0.);
+
+  /* 按时间戳预测：第一次只记录时间，之后按真实间隔外推 */
+  const double x0 = x(0), v0 = x(1);
+  const auto stamp = CV2::Clock::now();
+  filter.Predict(stamp);
+  EXPECT_DOUBLE_EQ(filter.GetState()(0), x0);
+  filter.Predict(stamp + std::chrono::milliseconds(100));
+  EXPECT_NEAR(filter.GetState()(0), x0 + v0 * 0.1, 1e-9);
+  filter.Predict(stamp);
+  EXPECT_NEAR(filter.GetState()(0), x0 + v0 * 0.1, 1e-9);
+}
+
+TEST(TestVision, TestEKFTurnRate) {
+  component::logger::SetLogger();
+  CTRV filter;
+  CTRV::State x0;
+  x0 << 0., 0., 1., 0., 0.;
+  filter.Init(x0, CTRV::StateMatrix::Identity());
+  CTRV::StateMatrix Q = CTRV::StateMatrix::Zero();
+  Q.diagonal() << 1e-4, 1e-4, 1e-2, 1e-4, 1e-2;
+  filter.SetProcessNoise(Q);
+  filter.SetMeasurementNoise(CTRV::MeasurementCov::Identity() * 1e-4);
+
+  /* 速度 2，角速度 0.5 的圆周运动 */
+  const double kV = 2., kW = 0.5;
+  std::mt19937 gen(7);
+  std::normal_distribution<double> dist(0., 0.01);
+  double t = 0.;
+  for (int i = 0; i < kSTEPS; ++i) {
+    t += StepTime(i);
+    filter.Predict(StepTime(i));
+    const double yaw = kW * t;
+    filter.Update(CTRV::Measurement(kV / kW * std::sin(yaw) + dist(gen),
+                                    kV / kW * (1. - std::cos(yaw)) +
+                                        dist(gen)));
+  }
+  const auto &x = filter.GetState();
+  EXPECT_NEAR(x(2), kV, 0.1);
+  EXPECT_NEAR(x(4), kW, 0.05);
+  EXPECT_NEAR(std::remainder(x(3) - kW * t, 2. * M_PI), 0., 0.05);
+}
+
+TEST(TestVision, TestEKFBenchmark) {
+  component::logger::SetLogger();
+  const int kRUNS = 10000;
+  component::Timer timer;
+
+  CTRV filter;
+  timer.Start();
+  for (int i = 0; i < kRUNS; ++i) {
+    filter.Predict(0.001);
+    filter.Update(CTRV::Measurement(i * 0.001, 0.));
   }
-  cv::imwrite(kPATH_IMAGE + "TestEKF.png", img);
-#endif
-  cv::destroyWindow("img");
+  timer.Calc("EKF CTRV x10000");
+  EXPECT_TRUE(filter.GetState().allFinite());
 }
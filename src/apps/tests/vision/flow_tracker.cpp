@@ -0,0 +1,44 @@
+#include "flow_tracker.hpp"
+
+#include "gtest/gtest.h"
+#include "opencv2/opencv.hpp"
+
+TEST(TestVision, TestFlowTracker) {
+  ArmorDetector detector(kPATH_RUNTIME + "test_params.json",
+                         game::Team::kBLUE);
+  FlowTracker tracker(detector, kPATH_RUNTIME + "test_flow_tracker.json");
+
+  /* 随机纹理便于光流跟踪 */
+  cv::Mat texture(480, 640, CV_8UC3);
+  cv::randu(texture, cv::Scalar::all(0), cv::Scalar::all(255));
+  cv::GaussianBlur(texture, texture, cv::Size(5, 5), 1.5);
+
+  Armor armor(cv::RotatedRect(cv::Point2f(320., 240.), cv::Size2f(60., 30.),
+                              0.));
+  armor.SetModel(game::Model::kINFANTRY);
+  armor.SetModelConf(0.9);
+
+  FrameContext ctx(texture);
+  tracker.Reset(ctx, tbb::concurrent_vector<Armor>{armor});
+
+  const cv::Mat shift = (cv::Mat_<double>(2, 3) << 1, 0, 3, 0, 1, 2);
+  cv::Mat moved;
+  cv::warpAffine(texture, moved, shift, texture.size());
+
+  FrameContext next(moved);
+  auto armors = tracker.Detect(next);
+
+  ASSERT_FALSE(tracker.Detected());
+  ASSERT_EQ(armors.size(), 1u);
+  EXPECT_NEAR(armors[0].ImageCenter().x, 323., 0.5);
+  EXPECT_NEAR(armors[0].ImageCenter().y, 242., 0.5);
+  EXPECT_TRUE(armors[0].GetModel() == game::Model::kINFANTRY);
+  EXPECT_DOUBLE_EQ(armors[0].GetModelConf(), 0.9);
+
+  /* 角点按原顺序平移，不经过重新拟合 */
+  const auto before = armor.ImageVertices();
+  const auto after = armors[0].ImageVertices();
+  ASSERT_EQ(after.size(), before.size());
+  for (std::size_t i = 0; i < before.size(); ++i)
+    EXPECT_LT(cv::norm(after[i] - before[i] - cv::Point2f(3., 2.)), 0.5);
+}
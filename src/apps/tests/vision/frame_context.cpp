@@ -0,0 +1,42 @@
+#include "frame_context.hpp"
+
+#include "gtest/gtest.h"
+#include "opencv2/opencv.hpp"
+
+TEST(TestVision, TestFrameContext) {
+  cv::Mat frame(48, 64, CV_8UC3, cv::Scalar(200, 50, 100));
+  FrameContext ctx(frame);
+
+  const cv::Mat &blue = ctx.ColorDiff(game::Team::kBLUE);
+  ASSERT_EQ(blue.at<uchar>(0, 0), 100);
+  ASSERT_EQ(ctx.ColorDiff(game::Team::kRED).at<uchar>(0, 0), 0);
+  ASSERT_TRUE(ctx.ColorDiff(game::Team::kUNKNOWN).empty());
+
+  /* 第二次请求应直接返回缓存 */
+  ASSERT_EQ(ctx.ColorDiff(game::Team::kBLUE).data, blue.data);
+  ASSERT_EQ(ctx.Gray().data, ctx.Gray().data);
+  ASSERT_EQ(ctx.Gray().channels(), 1);
+
+  /* 图案灰度图沿用 RGB2GRAY 的权重 */
+  cv::Mat face_gray;
+  cv::cvtColor(frame, face_gray, cv::COLOR_RGB2GRAY);
+  ASSERT_EQ(ctx.FaceGray().at<uchar>(0, 0), face_gray.at<uchar>(0, 0));
+  ASSERT_NE(ctx.FaceGray().at<uchar>(0, 0), ctx.Gray().at<uchar>(0, 0));
+
+  /* 局部差分与全图差分截取的结果一致 */
+  const cv::Rect roi(8, 4, 16, 12);
+  FrameContext local(frame);
+  ASSERT_EQ(local.ColorDiff(game::Team::kBLUE, roi).size(), roi.size());
+  ASSERT_EQ(cv::norm(local.ColorDiff(game::Team::kBLUE, roi), blue(roi),
+                     cv::NORM_INF),
+            0.);
+  ASSERT_EQ(ctx.ColorDiff(game::Team::kBLUE, roi).data, blue(roi).data);
+
+  ASSERT_EQ(ctx.Pyramid(0).data, frame.data);
+  ASSERT_EQ(ctx.Pyramid(2).size(), cv::Size(16, 12));
+  ASSERT_EQ(ctx.Resized(frame.size()).data, frame.data);
+  ASSERT_EQ(ctx.Resized(cv::Size(32, 24)).size(), cv::Size(32, 24));
+
+  ctx.SetFrame(cv::Mat(48, 64, CV_8UC3, cv::Scalar(0, 0, 255)));
+  ASSERT_EQ(ctx.ColorDiff(game::Team::kRED).at<uchar>(0, 0), 255);
+}
@@ -0,0 +1,192 @@
+#include "inference_engine.hpp"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "log.hpp"
+#include "opencv2/opencv.hpp"
+
+namespace {
+
+const std::string kONNX = kPATH_RUNTIME + "best.onnx";
+
+/* protobuf 编码，只实现构造测试模型需要的部分 */
+std::string Varint(uint64_t value) {
+  std::string bytes;
+  for (; value >= 0x80; value >>= 7)
+    bytes += static_cast<char>((value & 0x7f) | 0x80);
+  return bytes + static_cast<char>(value);
+}
+
+std::string Field(int field, uint64_t value) {
+  return Varint(field << 3) + Varint(value);
+}
+
+std::string Field(int field, const std::string &bytes) {
+  return Varint(field << 3 | 2) + Varint(bytes.size()) + bytes;
+}
+
+std::string ValueInfo(const std::string &name,
+                      const std::vector<int64_t> &dims) {
+  std::string shape;
+  for (int64_t dim : dims) shape += Field(1, Field(1, dim));
+  /* TypeProto.tensor_type，元素类型为 FLOAT */
+  return Field(1, name) + Field(2, Field(1, Field(1, 1) + Field(2, shape)));
+}
+
+/**
+ * @brief 最小的 YOLO 形式模型
+ * 输入 [1, 3, 32, 32] 直接 Reshape 为 512 个预测框，每个框 6 个数。
+ * 输入全为 1 时每个框都是位于 (1, 1)、置信度为 1 的同一个框
+ *
+ * @return std::string ONNX 文件内容
+ */
+std::string TinyYolo() {
+  std::string shape_data;
+  for (int64_t value : {1, 512, 6}) shape_data += Varint(value);
+  /* INT64 张量，dims = [3] */
+  const std::string shape = Field(1, 3) + Field(2, 7) +
+                            Field(7, shape_data) + Field(8, "shape");
+  const std::string node = Field(1, "images") + Field(1, "shape") +
+                           Field(2, "output") + Field(3, "reshape") +
+                           Field(4, "Reshape");
+  const std::string graph = Field(1, node) + Field(2, "tiny") +
+                            Field(5, shape) +
+                            Field(11, ValueInfo("images", {1, 3, 32, 32})) +
+                            Field(12, ValueInfo("output", {1, 512, 6}));
+  /* ir_version 7，opset 11 */
+  return Field(1, 7) + Field(7, graph) + Field(8, Field(2, 11));
+}
+
+/* 每张图像输出一个位于输入中心的预测框，类别为图像在 batch 中的序号 */
+class BatchEngine : public InferenceEngine {
+ private:
+  bool Forward(const cv::Mat &blob, std::vector<float> &output) override {
+    batches.push_back(blob.size[0]);
+    if (fixed_batch && blob.size[0] > 1) return false;
+    output.assign(blob.size[0] * stride_, 0.f);
+    for (int i = 0; i < blob.size[0]; ++i) {
+      float *box = output.data() + i * stride_;
+      box[0] = blob.size[3] / 2.f;
+      box[1] = blob.size[2] / 2.f;
+      box[2] = box[3] = 10.f;
+      box[4] = 0.9f;
+      box[5 + i] = 1.f;
+    }
+    return true;
+  }
+
+ public:
+  std::vector<int> batches;
+  bool fixed_batch = false; /* 模拟导出时固定 batch 为 1 的模型 */
+
+  BatchEngine() { stride_ = 5 + 4; }
+
+  bool Load(const std::string &) override { return true; }
+  nn::Backend GetBackend() const override { return nn::Backend::kCPU; }
+};
+
+}  // namespace
+
+TEST(TestVision, TestCpuEngine) {
+  component::logger::SetLogger();
+  if (!std::ifstream(kONNX).good()) GTEST_SKIP();
+
+  nn::EngineOption option;
+  option.backend = nn::Backend::kCPU;
+  option.threads = 2;
+
+  auto engine = CreateInferenceEngine(kONNX, option);
+  ASSERT_NE(engine, nullptr);
+  EXPECT_EQ(engine->GetBackend(), nn::Backend::kCPU);
+
+  cv::Mat image(480, 640, CV_8UC3, cv::Scalar(0, 0, 0));
+  auto dets = engine->Infer(image);
+  for (auto &det : dets) {
+    EXPECT_GE(det.conf, option.conf_thresh);
+    EXPECT_GE(det.class_id, 0.f);
+  }
+}
+
+TEST(TestVision, TestCpuEngineTinyModel) {
+  component::logger::SetLogger();
+  const std::string path = testing::TempDir() + "tiny_yolo.onnx";
+  std::ofstream(path, std::ios::binary) << TinyYolo();
+
+  nn::EngineOption option;
+  option.backend = nn::Backend::kCPU;
+  auto engine = CreateInferenceEngine(path, option);
+  ASSERT_NE(engine, nullptr);
+  EXPECT_EQ(engine->InputSize(), cv::Size(32, 32));
+
+  /* 所有预测框重合，NMS 后只剩一个，坐标按 2 倍缩放回原图 */
+  cv::Mat image(64, 64, CV_8UC3, cv::Scalar(255, 255, 255));
+  auto dets = engine->Infer(image);
+  ASSERT_EQ(dets.size(), 1u);
+  EXPECT_FLOAT_EQ(dets[0].conf, 1.f);
+  EXPECT_FLOAT_EQ(dets[0].class_id, 0.f);
+  EXPECT_NEAR(dets[0].x_ctr, 2.f, 1e-3);
+  EXPECT_NEAR(dets[0].w, 2.f, 1e-3);
+}
+
+TEST(TestVision, TestCpuEngineFixedBatch) {
+  component::logger::SetLogger();
+  const std::string path = testing::TempDir() + "tiny_yolo.onnx";
+  std::ofstream(path, std::ios::binary) << TinyYolo();
+
+  /* 模型的 batch 固定为 1，批量请求应降为逐张推理 */
+  nn::EngineOption option;
+  option.backend = nn::Backend::kCPU;
+  option.max_batch = 3;
+  auto engine = CreateInferenceEngine(path, option);
+  ASSERT_NE(engine, nullptr);
+  EXPECT_EQ(engine->MaxBatch(), 1);
+
+  std::vector<cv::Mat> images(
+      3, cv::Mat(64, 64, CV_8UC3, cv::Scalar(255, 255, 255)));
+  auto results = engine->InferBatch(images);
+  ASSERT_EQ(results.size(), images.size());
+  for (const auto &dets : results) EXPECT_EQ(dets.size(), 1u);
+}
+
+TEST(TestVision, TestInferBatch) {
+  component::logger::SetLogger();
+  BatchEngine engine;
+  engine.SetMaxBatch(2);
+
+  std::vector<cv::Mat> images{
+      cv::Mat(480, 640, CV_8UC3, cv::Scalar(0, 0, 0)),
+      cv::Mat(640, 320, CV_8UC3, cv::Scalar(0, 0, 0)),
+      cv::Mat(1024, 1280, CV_8UC3, cv::Scalar(0, 0, 0)),
+  };
+  auto results = engine.InferBatch(images);
+
+  ASSERT_EQ(engine.batches, std::vector<int>({2, 1}));
+  ASSERT_EQ(results.size(), images.size());
+  const std::vector<float> class_ids{0.f, 1.f, 0.f};
+  for (std::size_t i = 0; i < images.size(); ++i) {
+    ASSERT_EQ(results[i].size(), 1u);
+    EXPECT_FLOAT_EQ(results[i][0].class_id, class_ids[i]);
+    EXPECT_NEAR(results[i][0].x_ctr, images[i].cols / 2.f, 1.f);
+    EXPECT_NEAR(results[i][0].y_ctr, images[i].rows / 2.f, 1.f);
+  }
+}
+
+TEST(TestVision, TestInferBatchFallback) {
+  component::logger::SetLogger();
+  BatchEngine engine;
+  engine.fixed_batch = true;
+  engine.SetMaxBatch(2);
+
+  std::vector<cv::Mat> images(3,
+                              cv::Mat(480, 640, CV_8UC3, cv::Scalar(0, 0, 0)));
+  auto results = engine.InferBatch(images);
+
+  /* 第一次批量失败后逐张重试，之后不再批量 */
+  ASSERT_EQ(engine.batches, std::vector<int>({2, 1, 1, 1}));
+  EXPECT_EQ(engine.MaxBatch(), 1);
+  for (const auto &dets : results) ASSERT_EQ(dets.size(), 1u);
+}
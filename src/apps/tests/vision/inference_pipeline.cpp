@@ -0,0 +1,79 @@
+#include "inference_pipeline.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "log.hpp"
+#include "opencv2/opencv.hpp"
+
+namespace {
+
+/* 输出一个位于输入中心的预测框，类别为帧序号 */
+class FakeEngine : public InferenceEngine {
+ private:
+  bool Forward(const cv::Mat &blob, std::vector<float> &output) override {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    const int id = calls++;
+    output.assign(stride_, 0.f);
+    output[0] = blob.size[3] / 2.f;
+    output[1] = blob.size[2] / 2.f;
+    output[2] = output[3] = 10.f;
+    output[4] = 0.9f;
+    output[5 + id % (stride_ - 5)] = 1.f;
+    return true;
+  }
+
+ public:
+  std::atomic<int> calls{0};
+
+  FakeEngine() { stride_ = 5 + 8; }
+
+  bool Load(const std::string &) override { return true; }
+  nn::Backend GetBackend() const override { return nn::Backend::kCPU; }
+};
+
+}  // namespace
+
+TEST(TestVision, TestInferencePipeline) {
+  component::logger::SetLogger();
+  FakeEngine engine;
+  cv::Mat image(480, 640, CV_8UC3, cv::Scalar(0, 0, 0));
+
+  std::vector<std::future<std::vector<nn::Detection>>> results;
+  {
+    InferencePipeline pipeline(engine, 2);
+    EXPECT_EQ(pipeline.SlotCount(), 2u);
+
+    for (int i = 0; i < 6; ++i) results.push_back(pipeline.Submit(image));
+
+    for (int i = 0; i < 6; ++i) {
+      auto dets = results[i].get();
+      ASSERT_EQ(dets.size(), 1u);
+      EXPECT_FLOAT_EQ(dets[0].class_id, static_cast<float>(i));
+      EXPECT_FLOAT_EQ(dets[0].x_ctr, 320.f);
+      EXPECT_FLOAT_EQ(dets[0].y_ctr, 240.f);
+    }
+  }
+  EXPECT_EQ(engine.calls, 6);
+}
+
+TEST(TestVision, TestInferencePipelineShutdown) {
+  component::logger::SetLogger();
+  FakeEngine engine;
+  cv::Mat image(480, 640, CV_8UC3, cv::Scalar(0, 0, 0));
+
+  /* 析构时仍在途的帧也要处理完，不能留下未兑现的 promise */
+  std::vector<std::future<std::vector<nn::Detection>>> results;
+  {
+    InferencePipeline pipeline(engine, 3);
+    for (int i = 0; i < 3; ++i) results.push_back(pipeline.Submit(image));
+  }
+  for (auto &result : results) {
+    ASSERT_EQ(result.wait_for(std::chrono::seconds(0)),
+              std::future_status::ready);
+    EXPECT_EQ(result.get().size(), 1u);
+  }
+  EXPECT_EQ(engine.calls, 3);
+}
@@ -32,6 +32,10 @@ TEST(TestVision, TestKalman) {
   for (auto pt : points) {
     pre_pt = filter.Predict(pt);
 
+    /* 两点起始，从第一帧起就有输出，匀速运动时与观测一致 */
+    EXPECT_NEAR(pre_pt.x, pt.x, 1.);
+    EXPECT_NEAR(pre_pt.y, pt.y, 1.);
+
     cv::circle(img, pt, 3, draw::kBLUE, 2);
     cv::circle(img, pre_pt, 3, draw::kGREEN, 2);
 
@@ -0,0 +1,180 @@
+#include "kalman_t.hpp"
+
+#include <random>
+
+#include "gtest/gtest.h"
+#include "kalman.hpp"
+#include "log.hpp"
+#include "timer.hpp"
+
+namespace {
+
+const double kDT = 0.01;
+const int kSTEPS = 300;
+
+using CV2 = kalman::ConstantVelocity<2>;
+
+/* 匀速运动的目标，观测带高斯噪声 */
+template <typename Model>
+typename Model::Filter Track(typename Model::Filter::State truth, double noise,
+                             int steps) {
+  using Scalar = typename Model::Filter::State::Scalar;
+  typename Model::Filter filter;
+  Model::Configure(filter, kDT, Scalar(1), noise * noise);
+
+  std::mt19937 gen(7);
+  std::normal_distribution<double> dist(0., noise);
+  const auto F = Model::Transition(kDT);
+  const auto H = Model::Measurement();
+  for (int i = 0; i < steps; ++i) {
+    truth = F * truth;
+    typename Model::Filter::Measurement z = H * truth;
+    for (int k = 0; k < z.size(); ++k) z(k) += static_cast<Scalar>(dist(gen));
+    filter.Predict();
+    filter.Update(z);
+  }
+  return filter;
+}
+
+}  // namespace
+
+TEST(TestVision, TestKalmanTModel) {
+  /* 匀加速模型：x' = x + v dt + a dt^2 / 2 */
+  const auto F = kalman::ConstantAcceleration<1>::Transition(0.1);
+  EXPECT_DOUBLE_EQ(F(0, 1), 0.1);
+  EXPECT_DOUBLE_EQ(F(0, 2), 0.005);
+  EXPECT_DOUBLE_EQ(F(1, 2), 0.1);
+  EXPECT_DOUBLE_EQ(F(2, 0), 0.);
+
+  /* 匀速模型的过程噪声 q [dt^3/3 dt^2/2; dt^2/2 dt] */
+  const auto Q = kalman::ConstantVelocity<2>::ProcessNoise(0.1, 2.);
+  EXPECT_NEAR(Q(0, 0), 2. * 1e-3 / 3., 1e-12);
+  EXPECT_NEAR(Q(0, 1), 2. * 1e-2 / 2., 1e-12);
+  EXPECT_NEAR(Q(1, 1), 2. * 0.1, 1e-12);
+  EXPECT_NEAR(Q(2, 3), Q(0, 1), 1e-12);
+  EXPECT_DOUBLE_EQ(Q(0, 2), 0.);
+
+  const auto H = CV2::Measurement();
+  EXPECT_DOUBLE_EQ(H(0, 0), 1.);
+  EXPECT_DOUBLE_EQ(H(1, 2), 1.);
+  EXPECT_DOUBLE_EQ(H.sum(), 2.);
+}
+
+TEST(TestVision, TestKalmanT) {
+  component::logger::SetLogger();
+  CV2::Filter::State truth;
+  truth << 100., 50., 200., -30.;
+
+  auto filter = Track<CV2>(truth, 1., kSTEPS);
+  const auto &x = filter.GetState();
+  EXPECT_NEAR(x(1), 50., 2.);
+  EXPECT_NEAR(x(3), -30., 2.);
+  EXPECT_NEAR(x(0), 100. + 50. * kDT * kSTEPS, 1.);
+  EXPECT_NEAR(x(2), 200. - 30. * kDT * kSTEPS, 1.);
+
+  /* Joseph 形式保持协方差对称正定 */
+  const auto &P = filter.GetCovariance();
+  EXPECT_LT((P - P.transpose()).cwiseAbs().maxCoeff(), 1e-9);
+  EXPECT_GT(P.ldlt().vectorD().minCoeff(), 0.);
+
+  /* 单精度与双精度结果一致 */
+  using CV2f = kalman::ConstantVelocity<2, float>;
+  auto filter_f = Track<CV2f>(truth.cast<float>(), 1., kSTEPS);
+  EXPECT_LT((filter_f.GetState().cast<double>() - x).cwiseAbs().maxCoeff(),
+            1e-2);
+  const auto &P_f = filter_f.GetCovariance();
+  EXPECT_LT((P_f - P_f.transpose()).cwiseAbs().maxCoeff(), 1e-5f);
+}
+
+TEST(TestVision, TestKalmanTFastStart) {
+  component::logger::SetLogger();
+
+  /* 两点起始：速度为差分，协方差为 r [1 1/dt; 1/dt 2/dt^2] */
+  using Start = kalman::FastStart<2, 2>;
+  Start start;
+  EXPECT_FALSE(start.Add(Start::Measurement(10., 20.), 0.));
+  EXPECT_TRUE(start.Add(Start::Measurement(13., 18.), kDT));
+  CV2::Filter filter;
+  start.Init(filter, 4.);
+  const auto &x = filter.GetState();
+  EXPECT_NEAR(x(0), 13., 1e-9);
+  EXPECT_NEAR(x(1), 3. / kDT, 1e-6);
+  EXPECT_NEAR(x(2), 18., 1e-9);
+  EXPECT_NEAR(x(3), -2. / kDT, 1e-6);
+  const auto &P = filter.GetCovariance();
+  EXPECT_NEAR(P(0, 0), 4., 1e-9);
+  EXPECT_NEAR(P(0, 1), 4. / kDT, 1e-6);
+  EXPECT_NEAR(P(1, 1), 8. / (kDT * kDT), 1e-3);
+  EXPECT_DOUBLE_EQ(P(0, 2), 0.);
+
+  /* 最小二乘：只用最近 Points 帧，无噪声的匀加速运动被准确恢复 */
+  using CA = kalman::FastStart<1, 3, 6>;
+  CA ca;
+  auto position = [](double t) { return 1. + 2. * t + 1.5 * t * t; };
+  for (int i = 0; i < 8; ++i)
+    ca.Add(CA::Measurement(i < 2 ? 1e3 : position(i * kDT)), i * kDT);
+  kalman::ConstantAcceleration<1>::Filter ca_filter;
+  ca.Init(ca_filter, 1.);
+  const double t = 7 * kDT;
+  EXPECT_NEAR(ca_filter.GetState()(0), position(t), 1e-9);
+  EXPECT_NEAR(ca_filter.GetState()(1), 2. + 3. * t, 1e-6);
+  EXPECT_NEAR(ca_filter.GetState()(2), 3., 1e-3);
+}
+
+TEST(TestVision, TestKalmanTFirstShot) {
+  component::logger::SetLogger();
+  /* 锁定后的首发时间：提前 kLEAD 外推的位置误差小于 kHIT 即可射击 */
+  const double kLEAD = 0.1;
+  const double kHIT = 10.;
+  auto truth = [](double t) {
+    return Eigen::Vector2d(100. + 300. * t, 200. - 120. * t);
+  };
+
+  std::mt19937 gen(7);
+  std::normal_distribution<double> dist(0., 1.);
+  kalman::FastStart<2, 2> start;
+  CV2::Filter filter;
+  CV2::Configure(filter, kDT, 1e4, 1.);
+  int first_shot = -1;
+  for (int i = 0; i < kSTEPS && first_shot < 0; ++i) {
+    const double t = i * kDT;
+    const CV2::Filter::Measurement z =
+        truth(t) + Eigen::Vector2d(dist(gen), dist(gen));
+    if (!start.Ready()) {
+      if (!start.Add(z, t)) continue;
+      start.Init(filter, 1.);
+    } else {
+      filter.Predict();
+      filter.Update(z);
+    }
+
+    const auto &x = filter.GetState();
+    const Eigen::Vector2d lead(x(0) + x(1) * kLEAD, x(2) + x(3) * kLEAD);
+    if ((lead - truth(t + kLEAD)).norm() < kHIT) first_shot = i;
+  }
+  SPDLOG_INFO("First good shot at frame {} ({} ms after lock).", first_shot,
+              first_shot * kDT * 1e3);
+  EXPECT_GE(first_shot, 1);
+  EXPECT_LE(first_shot, 3);
+}
+
+TEST(TestVision, TestKalmanTBenchmark) {
+  component::logger::SetLogger();
+  const int kRUNS = 1000;
+  component::Timer timer;
+
+  CV2::Filter filter;
+  CV2::Configure(filter, kDT, 1., 1.);
+  timer.Start();
+  for (int i = 0; i < kRUNS; ++i) {
+    filter.Predict();
+    filter.Update(CV2::Filter::Measurement(static_cast<double>(i), 50.));
+  }
+  timer.Calc("KalmanT x1000");
+  EXPECT_NEAR(filter.GetState()(0), kRUNS - 1., 1.);
+
+  Kalman kalman(4, 2);
+  timer.Start();
+  for (int i = 0; i < kRUNS; ++i) kalman.Predict(cv::Point2d(i, 50.));
+  timer.Calc("Kalman x1000");
+}
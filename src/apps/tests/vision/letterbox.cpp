@@ -0,0 +1,65 @@
+#include "letterbox.hpp"
+
+#include "gtest/gtest.h"
+#include "log.hpp"
+#include "opencv2/opencv.hpp"
+
+namespace {
+
+const float kPAD = 114.f / 255.f;
+
+float At(const cv::Mat &blob, int c, int y, int x) {
+  const int idx[] = {0, c, y, x};
+  if (blob.depth() == CV_16F) return float(blob.at<cv::float16_t>(idx));
+  return blob.at<float>(idx);
+}
+
+}  // namespace
+
+TEST(TestVision, TestLetterbox) {
+  component::logger::SetLogger();
+
+  /* 左半蓝色，右半红色 */
+  cv::Mat image(480, 640, CV_8UC3, cv::Scalar(255, 0, 0));
+  image(cv::Rect(320, 0, 320, 480)).setTo(cv::Scalar(0, 0, 255));
+
+  Letterbox letterbox(cv::Size(320, 320));
+  const cv::Mat &blob = letterbox.Process(image);
+  ASSERT_EQ(blob.dims, 4);
+  EXPECT_EQ(blob.size[1], 3);
+  EXPECT_EQ(blob.size[2], 320);
+  EXPECT_EQ(blob.size[3], 320);
+
+  const nn::LetterboxInfo &info = letterbox.Info();
+  EXPECT_FLOAT_EQ(info.scale, 0.5f);
+  EXPECT_FLOAT_EQ(info.pad.x, 0.f);
+  EXPECT_FLOAT_EQ(info.pad.y, 40.f);
+
+  /* 上下填充区 */
+  for (int c = 0; c < 3; ++c) {
+    EXPECT_NEAR(At(blob, c, 0, 100), kPAD, 1e-6);
+    EXPECT_NEAR(At(blob, c, 319, 100), kPAD, 1e-6);
+  }
+
+  /* 通道顺序为 RGB */
+  EXPECT_NEAR(At(blob, 0, 160, 50), 0.f, 1e-6);
+  EXPECT_NEAR(At(blob, 2, 160, 50), 1.f, 1e-6);
+  EXPECT_NEAR(At(blob, 0, 160, 270), 1.f, 1e-6);
+  EXPECT_NEAR(At(blob, 2, 160, 270), 0.f, 1e-6);
+
+  const cv::Point2f point = info.ToImage(cv::Point2f(160.f, 160.f));
+  EXPECT_FLOAT_EQ(point.x, 320.f);
+  EXPECT_FLOAT_EQ(point.y, 240.f);
+
+  const cv::Rect2f rect = info.ToImage(cv::Rect2f(150.f, 140.f, 10.f, 20.f));
+  EXPECT_FLOAT_EQ(rect.x, 300.f);
+  EXPECT_FLOAT_EQ(rect.y, 200.f);
+  EXPECT_FLOAT_EQ(rect.width, 20.f);
+  EXPECT_FLOAT_EQ(rect.height, 40.f);
+
+  letterbox.SetDepth(CV_16F);
+  const cv::Mat &half = letterbox.Process(image);
+  EXPECT_EQ(half.depth(), CV_16F);
+  EXPECT_NEAR(At(half, 0, 0, 100), kPAD, 1e-3);
+  EXPECT_NEAR(At(half, 2, 160, 50), 1.f, 1e-3);
+}
@@ -0,0 +1,73 @@
+#include "template_matcher.hpp"
+
+#include "gtest/gtest.h"
+#include "log.hpp"
+#include "timer.hpp"
+
+namespace {
+
+cv::Mat Digit(const std::string &text, const cv::Point &offset) {
+  cv::Mat image(64, 64, CV_8UC1, cv::Scalar(0));
+  cv::putText(image, text, cv::Point(14, 52) + offset,
+              cv::FONT_HERSHEY_SIMPLEX, 1.8, cv::Scalar(255), 5);
+  return image;
+}
+
+}  // namespace
+
+TEST(TestVision, TestTemplateMatcher) {
+  component::logger::SetLogger();
+  TemplateMatcher matcher(0.8);
+  matcher.AddTemplate(game::Model::kHERO, Digit("1", {0, 0}));
+  matcher.AddTemplate(game::Model::kENGINEER, Digit("2", {0, 0}));
+  matcher.AddTemplate(game::Model::kINFANTRY, Digit("3", {0, 0}));
+  ASSERT_EQ(matcher.TemplateCount(), 3u);
+
+  const auto mask = TemplateMatcher::Pack(Digit("2", {0, 0}));
+  EXPECT_EQ(TemplateMatcher::Distance(mask, mask), 0);
+
+  /* 平移几个像素仍能匹配到正确的数字 */
+  double similarity;
+  EXPECT_EQ(matcher.Match(Digit("1", {2, 1}), &similarity),
+            game::Model::kHERO);
+  EXPECT_GT(similarity, 0.8);
+  EXPECT_EQ(matcher.Match(Digit("2", {-2, 2})), game::Model::kENGINEER);
+  EXPECT_EQ(matcher.Match(Digit("3", {1, -2})), game::Model::kINFANTRY);
+
+  /* 与所有模板都不像时不给出结果 */
+  cv::Mat noise(64, 64, CV_8UC1);
+  cv::randu(noise, 0, 256);
+  EXPECT_EQ(matcher.Match(noise, &similarity), game::Model::kUNKNOWN);
+  EXPECT_LT(similarity, 0.8);
+
+  component::Timer timer;
+  timer.Start();
+  int matched = 0;
+  for (int i = 0; i < 100000; ++i)
+    matched += matcher.Match(mask) == game::Model::kENGINEER;
+  timer.Calc("Template match x100000");
+  EXPECT_EQ(matched, 100000);
+}
+
+TEST(TestVision, TestTemplateMatcherBatch) {
+  component::logger::SetLogger();
+  cv::Mat frame(480, 640, CV_8UC3, cv::Scalar(0, 0, 0));
+  cv::putText(frame, "2", cv::Point(290, 285), cv::FONT_HERSHEY_SIMPLEX, 3.,
+              cv::Scalar(255, 255, 255), 10);
+  FrameContext ctx(frame);
+
+  /* 小装甲板的中间正方形正好是以中心为中心的 125x125 区域 */
+  TemplateMatcher matcher(0.8);
+  matcher.AddTemplate(game::Model::kHERO, Digit("1", {0, 0}));
+  matcher.AddTemplate(game::Model::kENGINEER,
+                      ctx.FaceGray()(cv::Rect(258, 178, 125, 125)));
+
+  tbb::concurrent_vector<Armor> armors(
+      2, Armor(cv::RotatedRect(cv::Point2f(320, 240), cv::Size2f(135, 125),
+                               0)));
+  matcher.MatchBatch(armors, ctx);
+  for (const auto &armor : armors) {
+    EXPECT_EQ(armor.GetModel(), game::Model::kENGINEER);
+    EXPECT_GT(armor.GetModelConf(), 0.9);
+  }
+}
@@ -0,0 +1,45 @@
+#include "tile_scheduler.hpp"
+
+#include <set>
+
+#include "gtest/gtest.h"
+#include "log.hpp"
+
+TEST(TestVision, TestTileScheduler) {
+  component::logger::SetLogger();
+  TileScheduler scheduler;
+  const cv::Size frame_size(1920, 1080);
+  scheduler.Plan(frame_size, cv::Size(640, 640), 64,
+                 {cv::Rect(100, 100, 50, 50)});
+
+  /* 横向 0 576 1152 1280，纵向 0 440 */
+  ASSERT_TRUE(scheduler.Planned(frame_size));
+  ASSERT_EQ(scheduler.TileCount(), 8u);
+  EXPECT_EQ(scheduler.Tile(3), cv::Rect(1280, 0, 640, 640));
+  EXPECT_EQ(scheduler.Tile(4), cv::Rect(0, 440, 640, 640));
+
+  /* 关注区域所在图块每帧都有，其余 7 块 4 帧内全部轮到 */
+  std::set<std::size_t> seen;
+  for (int frame = 0; frame < 4; ++frame) {
+    auto tiles = scheduler.Schedule(3);
+    ASSERT_EQ(tiles.size(), 3u);
+    EXPECT_EQ(tiles.front(), 0u);
+    seen.insert(tiles.begin(), tiles.end());
+  }
+  EXPECT_EQ(seen.size(), 8u);
+
+  /* 同一目标在两个重叠图块中各出现一次，被内部边缘截断的丢弃 */
+  scheduler.Update(0, {nn::Detection{600.f, 300.f, 20.f, 20.f, 0.9f, 1.f},
+                       nn::Detection{635.f, 100.f, 20.f, 20.f, 0.8f, 1.f}});
+  scheduler.Update(1, {nn::Detection{24.f, 300.f, 20.f, 20.f, 0.7f, 1.f}});
+  auto merged = scheduler.Merge(0.5f);
+  ASSERT_EQ(merged.size(), 1u);
+  EXPECT_FLOAT_EQ(merged[0].x_ctr, 600.f);
+  EXPECT_FLOAT_EQ(merged[0].conf, 0.9f);
+
+  /* 与原图边缘重合的一侧保留 */
+  scheduler.Update(3, {nn::Detection{635.f, 300.f, 20.f, 20.f, 0.6f, 2.f}});
+  merged = scheduler.Merge(0.5f);
+  ASSERT_EQ(merged.size(), 2u);
+  EXPECT_FLOAT_EQ(merged[1].x_ctr, 1915.f);
+}
@@ -0,0 +1,56 @@
+#include "tiny_cnn.hpp"
+
+#include "common.hpp"
+#include "gtest/gtest.h"
+#include "log.hpp"
+#include "opencv2/dnn.hpp"
+#include "timer.hpp"
+
+TEST(TestVision, TestTinyCnn) {
+  component::logger::SetLogger();
+  const std::string path = kPATH_RUNTIME + "armor_classifier.onnx";
+  TinyCnn cnn;
+  ASSERT_TRUE(cnn.LoadModel(path));
+  ASSERT_EQ(cnn.InputSize(), cv::Size(28, 28));
+  ASSERT_EQ(cnn.OutputSize(), 8);
+
+  cv::dnn::Net net = cv::dnn::readNet(path);
+  cv::RNG rng(42);
+  cv::Mat input(28, 28, CV_32F);
+  cv::Mat output(1, cnn.OutputSize(), CV_32F);
+  for (int i = 0; i < 10; ++i) {
+    rng.fill(input, cv::RNG::UNIFORM, 0., 255. / 128.);
+    net.setInput(input.reshape(1, {1, 1, 28, 28}));
+    cv::Mat expected = net.forward().reshape(1, 1);
+
+    /* 与 OpenCV DNN 只差在浮点累加顺序上 */
+    cnn.SetQuantized(false);
+    cnn.Forward(input.ptr<float>(), output.ptr<float>());
+    for (int j = 0; j < output.cols; ++j)
+      EXPECT_NEAR(output.at<float>(j), expected.at<float>(j), 1e-5);
+
+    cnn.SetQuantized(true);
+    cnn.Forward(input.ptr<float>(), output.ptr<float>());
+    for (int j = 0; j < output.cols; ++j)
+      EXPECT_NEAR(output.at<float>(j), expected.at<float>(j), 0.05);
+  }
+
+  component::Timer timer;
+  cnn.SetQuantized(false);
+  timer.Start();
+  for (int i = 0; i < 1000; ++i)
+    cnn.Forward(input.ptr<float>(), output.ptr<float>());
+  timer.Calc("TinyCnn x1000");
+
+  timer.Start();
+  for (int i = 0; i < 1000; ++i) net.forward();
+  timer.Calc("OpenCV DNN x1000");
+}
+
+TEST(TestVision, TestTinyCnnInvalid) {
+  component::logger::SetLogger();
+  TinyCnn cnn;
+  EXPECT_FALSE(cnn.LoadModel(kPATH_RUNTIME + "not_exist.onnx"));
+  EXPECT_FALSE(cnn.Loaded());
+  EXPECT_EQ(cnn.OutputSize(), 0);
+}
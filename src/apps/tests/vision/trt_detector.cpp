@@ -4,6 +4,17 @@
 #include "log.hpp"
 #include "opencv2/opencv.hpp"
 
+namespace {
+
+/* 直接调用 Forward，检查原始输出 */
+class TrtProbe : public TrtDetector {
+ public:
+  using TrtDetector::Forward;
+  int Depth() const { return input_depth_; }
+};
+
+}  // namespace
+
 TEST(TestNN, ExampleTest) { EXPECT_EQ(1, 1); }
 
 TEST(TestNN, TestTRT) {
@@ -11,3 +22,22 @@ TEST(TestNN, TestTRT) {
   TrtDetector detector(std::string(kPATH_RUNTIME + "best.onnx"));
   detector.TestInfer();
 }
+
+TEST(TestNN, TestTRTFallback) {
+  component::logger::SetLogger();
+  TrtProbe detector;
+  detector.SetMaxBatch(4);
+  if (!detector.Load(kPATH_RUNTIME + "best.onnx")) GTEST_SKIP();
+
+  const cv::Size size = detector.InputSize();
+  const int dims[] = {1, 3, size.height, size.width};
+  const cv::Mat blob(4, dims, detector.Depth(), cv::Scalar(0.5));
+  std::vector<float> before, after;
+  ASSERT_TRUE(detector.Forward(blob, before));
+
+  /* 批量推理失败后 MaxBatch 降为 1，单张推理仍使用原来的显存 */
+  detector.SetMaxBatch(1);
+  ASSERT_TRUE(detector.Forward(blob, after));
+  ASSERT_EQ(after.size(), before.size());
+  EXPECT_EQ(after, before);
+}
@@ -0,0 +1,126 @@
+#include "yolo_post_process.hpp"
+
+#include <random>
+
+#include "gtest/gtest.h"
+#include "log.hpp"
+#include "timer.hpp"
+
+namespace {
+
+const int kNUM_CLASSES = 4;
+const int kSTRIDE = 5 + kNUM_CLASSES;
+
+void SetBox(std::vector<float> &prob, int i, float x, float y, float obj,
+            int class_id, float cls_conf = 1.f) {
+  float *box = prob.data() + i * kSTRIDE;
+  box[0] = x;
+  box[1] = y;
+  box[2] = 20.f;
+  box[3] = 20.f;
+  box[4] = obj;
+  box[5 + class_id] = cls_conf;
+}
+
+nn::Detection Box(float x, float y, float conf, float class_id) {
+  return nn::Detection{x, y, 20.f, 20.f, conf, class_id};
+}
+
+}  // namespace
+
+TEST(TestVision, TestYoloDecode) {
+  component::logger::SetLogger();
+
+  /* 37 个预测框，不是 SIMD 宽度的整数倍，覆盖尾部的标量处理 */
+  std::vector<float> prob(37 * kSTRIDE, 0.f);
+  SetBox(prob, 0, 10.f, 10.f, 0.9f, 1, 0.5f);
+  SetBox(prob, 7, 20.f, 20.f, 0.4f, 2);
+  SetBox(prob, 8, 30.f, 30.f, 0.8f, 3);
+  SetBox(prob, 36, 40.f, 40.f, 0.6f, 0);
+
+  nn::DecodeParam param;
+  param.stride = kSTRIDE;
+  param.conf_thresh = 0.5f;
+  param.scale_x = 2.f;
+  param.scale_y = 0.5f;
+
+  auto dets = nn::Decode(prob.data(), prob.size(), param);
+  ASSERT_EQ(dets.size(), 3u);
+  EXPECT_FLOAT_EQ(dets[0].conf, 0.8f);
+  EXPECT_FLOAT_EQ(dets[0].class_id, 3.f);
+  EXPECT_FLOAT_EQ(dets[0].x_ctr, 60.f);
+  EXPECT_FLOAT_EQ(dets[0].y_ctr, 15.f);
+  EXPECT_FLOAT_EQ(dets[1].conf, 0.6f);
+  EXPECT_FLOAT_EQ(dets[2].conf, 0.45f);
+  EXPECT_FLOAT_EQ(dets[2].class_id, 1.f);
+
+  param.top_k = 2;
+  dets = nn::Decode(prob.data(), prob.size(), param);
+  ASSERT_EQ(dets.size(), 2u);
+  EXPECT_FLOAT_EQ(dets[0].conf, 0.8f);
+  EXPECT_FLOAT_EQ(dets[1].conf, 0.6f);
+
+  param.stride = 5;
+  EXPECT_TRUE(nn::Decode(prob.data(), prob.size(), param).empty());
+}
+
+TEST(TestVision, TestYoloNMS) {
+  component::logger::SetLogger();
+
+  std::vector<nn::Detection> dets = {
+      Box(100.f, 100.f, 0.7f, 0), Box(102.f, 100.f, 0.9f, 0),
+      Box(101.f, 101.f, 0.8f, 1), Box(300.f, 300.f, 0.6f, 0),
+      Box(104.f, 100.f, 0.5f, 0),
+  };
+
+  auto class_aware = dets;
+  nn::NonMaxSuppression(class_aware, 0.5f);
+  ASSERT_EQ(class_aware.size(), 3u);
+  EXPECT_FLOAT_EQ(class_aware[0].conf, 0.9f);
+  EXPECT_FLOAT_EQ(class_aware[1].conf, 0.8f);
+  EXPECT_FLOAT_EQ(class_aware[2].conf, 0.6f);
+
+  auto agnostic = dets;
+  nn::NonMaxSuppression(agnostic, 0.5f, false);
+  ASSERT_EQ(agnostic.size(), 2u);
+  EXPECT_FLOAT_EQ(agnostic[0].conf, 0.9f);
+  EXPECT_FLOAT_EQ(agnostic[1].conf, 0.6f);
+
+  EXPECT_FLOAT_EQ(nn::IOU(dets[0], dets[0]), 1.f);
+  EXPECT_FLOAT_EQ(nn::IOU(dets[0], dets[3]), 0.f);
+}
+
+TEST(TestVision, TestYoloPostProcessBenchmark) {
+  component::logger::SetLogger();
+
+  /* 640x640 输入的 YOLOv5 输出规模 */
+  const int kBOXES = 25200;
+  const int kRUNS = 100;
+
+  std::mt19937 gen(0);
+  std::uniform_real_distribution<float> pos(0.f, 640.f);
+  std::uniform_real_distribution<float> conf(0.f, 1.f);
+  std::vector<float> prob(kBOXES * kSTRIDE, 0.f);
+  for (int i = 0; i < kBOXES; ++i) {
+    /* 大部分预测框的 obj_conf 很低，与实际输出相近 */
+    const float obj = i % 50 == 0 ? conf(gen) : conf(gen) * 0.1f;
+    SetBox(prob, i, pos(gen), pos(gen), obj, i % kNUM_CLASSES, conf(gen));
+  }
+
+  nn::DecodeParam param;
+  param.stride = kSTRIDE;
+  param.conf_thresh = 0.25f;
+
+  std::size_t kept = 0;
+  component::Timer timer;
+  timer.Start();
+  for (int i = 0; i < kRUNS; ++i) {
+    auto dets = nn::Decode(prob.data(), prob.size(), param);
+    nn::NonMaxSuppression(dets, 0.45f);
+    kept = dets.size();
+  }
+  timer.Calc("YOLO post process x100");
+
+  EXPECT_GT(kept, 0u);
+  EXPECT_LE(kept, param.top_k);
+}
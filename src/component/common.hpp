@@ -60,6 +60,16 @@ struct Alert {
     self_sentry = false;
     self_base = false;
   }
+
+  Alert &operator|=(const Alert &other) {
+    enemy_buff |= other.enemy_buff;
+    enemy_snipe |= other.enemy_snipe;
+    enemy_slope |= other.enemy_slope;
+    self_outpost |= other.self_outpost;
+    self_sentry |= other.self_sentry;
+    self_base |= other.self_base;
+    return *this;
+  }
 };
 
 enum class AimMethod {
@@ -0,0 +1,187 @@
+#include "onnx_reader.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace onnx {
+
+void ProtoReader::Advance(std::size_t size) {
+  if (static_cast<std::size_t>(end_ - pos_) < size)
+    ok_ = false;
+  else
+    pos_ += size;
+}
+
+ProtoReader::ProtoReader(const std::string &data)
+    : pos_(data.data()), end_(data.data() + data.size()) {}
+
+bool ProtoReader::Next(int &field, int &wire) {
+  if (!ok_ || pos_ >= end_) return false;
+  const uint64_t tag = Varint();
+  field = static_cast<int>(tag >> 3);
+  wire = static_cast<int>(tag & 7);
+  return ok_;
+}
+
+bool ProtoReader::End() const { return !ok_ || pos_ >= end_; }
+
+bool ProtoReader::Ok() const { return ok_; }
+
+uint64_t ProtoReader::Varint() {
+  uint64_t value = 0;
+  for (int shift = 0; shift < 64 && pos_ < end_; shift += 7) {
+    const uint8_t byte = static_cast<uint8_t>(*pos_++);
+    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if (!(byte & 0x80)) return value;
+  }
+  ok_ = false;
+  return 0;
+}
+
+float ProtoReader::Fixed32() {
+  float value = 0.f;
+  if (end_ - pos_ < 4) {
+    ok_ = false;
+    return value;
+  }
+  std::memcpy(&value, pos_, sizeof(value));
+  pos_ += sizeof(value);
+  return value;
+}
+
+std::string ProtoReader::Bytes() {
+  const uint64_t size = Varint();
+  if (!ok_ || size > static_cast<uint64_t>(end_ - pos_)) {
+    ok_ = false;
+    return std::string();
+  }
+  std::string bytes(pos_, size);
+  pos_ += size;
+  return bytes;
+}
+
+void ProtoReader::Skip(int wire) {
+  switch (wire) {
+    case 0:
+      Varint();
+      break;
+    case 1:
+      Advance(8);
+      break;
+    case 2:
+      Bytes();
+      break;
+    case 5:
+      Advance(4);
+      break;
+    default:
+      ok_ = false;
+  }
+}
+
+void ReadInts(ProtoReader &reader, int wire, std::vector<int64_t> &ints) {
+  if (wire != 2) {
+    ints.push_back(static_cast<int64_t>(reader.Varint()));
+    return;
+  }
+  const std::string bytes = reader.Bytes();
+  ProtoReader packed(bytes);
+  while (!packed.End())
+    ints.push_back(static_cast<int64_t>(packed.Varint()));
+}
+
+void ReadFloats(ProtoReader &reader, int wire, std::vector<float> &floats) {
+  if (wire != 2) {
+    floats.push_back(reader.Fixed32());
+    return;
+  }
+  const std::string bytes = reader.Bytes();
+  const std::size_t offset = floats.size();
+  floats.resize(offset + bytes.size() / sizeof(float));
+  std::memcpy(floats.data() + offset, bytes.data(),
+              bytes.size() / sizeof(float) * sizeof(float));
+}
+
+bool ParseValueInfo(const std::string &bytes, std::string &name,
+                    std::vector<int64_t> &shape) {
+  std::string type, tensor_type, shape_proto;
+  ProtoReader info(bytes);
+  int field, wire;
+  while (info.Next(field, wire)) {
+    if (field == 1)
+      name = info.Bytes();
+    else if (field == 2)
+      type = info.Bytes();
+    else
+      info.Skip(wire);
+  }
+  ProtoReader type_reader(type);
+  while (type_reader.Next(field, wire)) {
+    if (field == 1)
+      tensor_type = type_reader.Bytes();
+    else
+      type_reader.Skip(wire);
+  }
+  ProtoReader tensor_reader(tensor_type);
+  while (tensor_reader.Next(field, wire)) {
+    if (field == 2)
+      shape_proto = tensor_reader.Bytes();
+    else
+      tensor_reader.Skip(wire);
+  }
+  ProtoReader shape_reader(shape_proto);
+  while (shape_reader.Next(field, wire)) {
+    if (field != 1) {
+      shape_reader.Skip(wire);
+      continue;
+    }
+    /* 没有 dim_value 的维度记为 -1 */
+    int64_t value = -1;
+    const std::string dim_proto = shape_reader.Bytes();
+    ProtoReader dim(dim_proto);
+    int dim_field, dim_wire;
+    while (dim.Next(dim_field, dim_wire)) {
+      if (dim_field == 1)
+        value = static_cast<int64_t>(dim.Varint());
+      else
+        dim.Skip(dim_wire);
+    }
+    shape.push_back(value > 0 ? value : -1);
+  }
+  return info.Ok() && type_reader.Ok() && tensor_reader.Ok() &&
+         shape_reader.Ok();
+}
+
+std::vector<int64_t> InputShape(const std::string &onnx_file_path) {
+  std::ifstream file(onnx_file_path, std::ios::binary);
+  if (!file) return {};
+  const std::string bytes((std::istreambuf_iterator<char>(file)),
+                          std::istreambuf_iterator<char>());
+
+  /* ModelProto.graph -> GraphProto.input，取第一个输入 */
+  ProtoReader model(bytes);
+  int field, wire;
+  while (model.Next(field, wire)) {
+    if (field != 7) {
+      model.Skip(wire);
+      continue;
+    }
+    const std::string graph_proto = model.Bytes();
+    ProtoReader graph(graph_proto);
+    while (graph.Next(field, wire)) {
+      if (field != 11) {
+        graph.Skip(wire);
+        continue;
+      }
+      std::string name;
+      std::vector<int64_t> shape;
+      if (!ParseValueInfo(graph.Bytes(), name, shape)) return {};
+      return shape;
+    }
+    return {};
+  }
+  return {};
+}
+
+}  // namespace onnx
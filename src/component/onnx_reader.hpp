@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace onnx {
+
+/**
+ * @brief 最小的 protobuf 解码器，只处理 ONNX 文件用到的编码方式
+ *
+ */
+class ProtoReader {
+ private:
+  const char *pos_;
+  const char *end_;
+  bool ok_ = true;
+
+  void Advance(std::size_t size);
+
+ public:
+  /* 只保存指针，data 需在读取期间有效 */
+  explicit ProtoReader(const std::string &data);
+  explicit ProtoReader(std::string &&data) = delete;
+
+  bool Next(int &field, int &wire);
+  bool End() const;
+  bool Ok() const;
+
+  uint64_t Varint();
+  float Fixed32();
+  std::string Bytes();
+  void Skip(int wire);
+};
+
+/* repeated 字段可能是 packed 编码，也可能逐个编码 */
+void ReadInts(ProtoReader &reader, int wire, std::vector<int64_t> &ints);
+void ReadFloats(ProtoReader &reader, int wire, std::vector<float> &floats);
+
+/**
+ * @brief 解析 ValueInfoProto 的名称和形状
+ * ValueInfoProto -> TypeProto -> TypeProto.Tensor -> TensorShapeProto
+ *
+ * @param bytes ValueInfoProto 编码
+ * @param name 名称
+ * @param shape 形状，没有 dim_value 的维度记为 -1
+ * @return true 解析成功
+ */
+bool ParseValueInfo(const std::string &bytes, std::string &name,
+                    std::vector<int64_t> &shape);
+
+/**
+ * @brief 读取 ONNX 模型第一个输入的形状
+ *
+ * @param onnx_file_path ONNX 模型路径
+ * @return std::vector<int64_t> 输入形状，动态维度为 -1，读取失败时为空
+ */
+std::vector<int64_t> InputShape(const std::string &onnx_file_path);
+
+}  // namespace onnx
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
+
+namespace component {
+
+/**
+ * @brief 重排序缓冲区
+ * 多个工作线程按完成顺序提交结果，按序号从小到大输出，
+ * 比上一次输出更旧的结果直接丢弃，保证下游收到的数据时间单调
+ *
+ * @tparam Result 结果类型
+ */
+template <typename Result>
+class ReorderBuffer {
+ private:
+  std::mutex mutex_;
+  uint64_t next_seq_ = 0;
+  uint64_t emit_seq_ = 0; /* 下一个允许输出的最小序号 */
+  std::set<uint64_t> in_flight_;
+  std::map<uint64_t, Result> done_;
+  std::size_t max_size_;
+
+ public:
+  explicit ReorderBuffer(std::size_t max_size = 80) : max_size_(max_size) {}
+
+  /**
+   * @brief 分配序号并登记为处理中
+   *
+   * @return uint64_t 序号
+   */
+  uint64_t Begin() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    in_flight_.insert(next_seq_);
+    return next_seq_++;
+  }
+
+  /**
+   * @brief 放弃一个序号，例如帧被丢弃或没有结果，不再等待它
+   *
+   * @param seq 序号
+   */
+  void Cancel(uint64_t seq) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    in_flight_.erase(seq);
+  }
+
+  /**
+   * @brief 提交结果
+   *
+   * @param seq 序号
+   * @param result 结果
+   */
+  void Complete(uint64_t seq, const Result &result) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    in_flight_.erase(seq);
+    if (seq < emit_seq_) return;
+
+    done_.emplace(seq, result);
+    if (done_.size() > max_size_) {
+      emit_seq_ = done_.begin()->first + 1;
+      done_.erase(done_.begin());
+    }
+  }
+
+  /**
+   * @brief 按序取出结果，更小的序号仍在处理中时等待
+   *
+   * @param result 结果
+   * @param seq 结果的序号
+   * @return true 取出成功
+   * @return false 没有可输出的结果
+   */
+  bool Pop(Result &result, uint64_t &seq) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (done_.empty()) return false;
+
+    auto it = done_.begin();
+    if (!in_flight_.empty() && *in_flight_.begin() < it->first) return false;
+
+    seq = it->first;
+    result = it->second;
+    emit_seq_ = seq + 1;
+    done_.erase(it);
+    return true;
+  }
+
+  bool Pop(Result &result) {
+    uint64_t seq;
+    return Pop(result, seq);
+  }
+
+  std::size_t InFlight() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return in_flight_.size();
+  }
+};
+
+}  // namespace component
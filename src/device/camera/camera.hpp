@@ -37,6 +37,12 @@ class Camera {
   std::mutex frame_stack_mutex_;
   std::deque<cv::Mat> frame_stack_;
 
+  /* 输出图像坐标系下的感兴趣区域，为空时输出整幅图像 */
+  cv::Rect roi_;
+  cv::Point2f roi_origin_;
+  /* 为真时 frame_stack_ 中已是传感器裁剪后的图像 */
+  bool hw_roi_ = false;
+
   /**
    * @brief 设置相机参数
    *
@@ -64,24 +70,89 @@ class Camera {
     return false;
   }
 
+  /**
+   * @brief 设置感兴趣区域，之后 GetFrame 只输出该区域
+   * 默认实现在软件中截取子图，不拷贝数据；支持的相机可在传感器上裁剪以提高帧率
+   *
+   * @param roi 输出图像坐标系下的区域，为空或覆盖整幅图像时恢复全图
+   * @return true 设置成功
+   * @return false 设置失败
+   */
+  virtual bool SetRegionOfInterest(const cv::Rect& roi) {
+    std::lock_guard<std::mutex> lock(frame_stack_mutex_);
+    const cv::Rect full(0, 0, frame_w_, frame_h_);
+    roi_ = roi & full;
+    if (roi_ == full) roi_ = cv::Rect();
+    roi_origin_ = roi_.tl();
+    hw_roi_ = false;
+    SPDLOG_DEBUG("ROI: {}, {}, {}, {}", roi_.x, roi_.y, roi_.width,
+                 roi_.height);
+    return true;
+  }
+
+  /**
+   * @brief 取消感兴趣区域，恢复输出整幅图像
+   *
+   * @return true 设置成功
+   * @return false 设置失败
+   */
+  bool ResetRegionOfInterest() { return SetRegionOfInterest(cv::Rect()); }
+
   /**
    * @brief Get the Frame object
    *
-   * @return cv::Mat 拍摄的图像
+   * @param frame 拍摄的图像，设置感兴趣区域时为该区域
+   * @param origin 图像左上角在整幅输出图像中的坐标
+   * @return true 获取成功
+   * @return false 没有新图像
    */
-  virtual bool GetFrame(cv::Mat& frame) {
+  virtual bool GetFrame(cv::Mat& frame, cv::Point2f& origin) {
     std::lock_guard<std::mutex> lock(frame_stack_mutex_);
-    if (!frame_stack_.empty()) {
-      frame_signal_.Take();
-      cv::resize(frame_stack_.front(), frame, cv::Size(frame_w_, frame_h_));
-      frame_stack_.clear();
-    } else {
+    if (frame_stack_.empty()) {
       // SPDLOG_ERROR("Empty frame stack!");
       return false;
     }
+    frame_signal_.Take();
+
+    const cv::Mat& src = frame_stack_.front();
+    const cv::Size dst_size =
+        roi_.empty() ? cv::Size(frame_w_, frame_h_) : roi_.size();
+
+    /* 先在原图上截取，只缩放需要的部分 */
+    cv::Mat region = src;
+    if (!roi_.empty() && !hw_roi_) {
+      const double scale_x = static_cast<double>(src.cols) / frame_w_;
+      const double scale_y = static_cast<double>(src.rows) / frame_h_;
+      cv::Rect src_roi(cvRound(roi_.x * scale_x), cvRound(roi_.y * scale_y),
+                       cvRound(roi_.width * scale_x),
+                       cvRound(roi_.height * scale_y));
+      region = src(src_roi & cv::Rect(0, 0, src.cols, src.rows));
+    }
+
+    /* 每帧使用新的缓冲区，已交给其他线程的上一帧不会被覆盖 */
+    if (region.size() == dst_size) {
+      frame = region;
+    } else {
+      cv::Mat resized;
+      cv::resize(region, resized, dst_size);
+      frame = resized;
+    }
+
+    origin = roi_origin_;
+    frame_stack_.clear();
     return true;
   }
 
+  /**
+   * @brief Get the Frame object
+   *
+   * @return cv::Mat 拍摄的图像
+   */
+  bool GetFrame(cv::Mat& frame) {
+    cv::Point2f origin;
+    return GetFrame(frame, origin);
+  }
+
   /**
    * @brief 关闭相机设备
    *
@@ -1,5 +1,7 @@
 #include "hik_camera.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <cstring>
 #include <exception>
 #include <string>
@@ -72,27 +74,33 @@ void HikCamera::GrabPrepare() {
 }
 
 void HikCamera::GrabLoop() {
-  if (HikCheck(MV_CC_GetImageBuffer(camera_handle_, &raw_frame_, 10000),
-               "[GrabThread] GetImageBuffer", false)) {
-    SPDLOG_DEBUG("[GrabThread] FrameNum: {}.",
-                 raw_frame_.stFrameInfo.nFrameNum);
+  /* 设置感兴趣区域时会停止取流，此时取图失败，直接跳过 */
+  if (!HikCheck(MV_CC_GetImageBuffer(camera_handle_, &raw_frame_, 10000),
+                "[GrabThread] GetImageBuffer", false)) {
+    return;
   }
+  SPDLOG_DEBUG("[GrabThread] FrameNum: {}.", raw_frame_.stFrameInfo.nFrameNum);
 
   cv::Mat raw_mat(
       cv::Size(raw_frame_.stFrameInfo.nWidth, raw_frame_.stFrameInfo.nHeight),
       CV_8UC1, raw_frame_.pBufAddr);
 
-  if (!raw_mat.empty()) cv::cvtColor(raw_mat, raw_mat, cv::COLOR_BayerRG2BGR);
+  cv::Mat bgr;
+  if (!raw_mat.empty()) cv::cvtColor(raw_mat, bgr, cv::COLOR_BayerRG2BGR);
 
-  std::lock_guard<std::mutex> lock(frame_stack_mutex_);
-  frame_stack_.clear();
-  frame_stack_.push_front(raw_mat.clone());
-  frame_signal_.Give();
-  SPDLOG_DEBUG("frame_stack_ size: {}", frame_stack_.size());
-  if (nullptr != raw_frame_.pBufAddr) {
-    HikCheck(MV_CC_FreeImageBuffer(camera_handle_, &raw_frame_),
-             "[GrabThread] FreeImageBuffer");
+  {
+    std::lock_guard<std::mutex> lock(frame_stack_mutex_);
+    /* 丢弃切换感兴趣区域前读出的图像 */
+    if (!bgr.empty() && bgr.size() == sensor_size_) {
+      frame_stack_.clear();
+      frame_stack_.push_front(bgr);
+      frame_signal_.Give();
+    }
+    SPDLOG_DEBUG("frame_stack_ size: {}", frame_stack_.size());
   }
+
+  HikCheck(MV_CC_FreeImageBuffer(camera_handle_, &raw_frame_),
+           "[GrabThread] FreeImageBuffer");
 }
 
 bool HikCamera::OpenPrepare(unsigned int index) {
@@ -140,6 +148,11 @@ bool HikCamera::OpenPrepare(unsigned int index) {
              "GammaEnable");
   }
 
+  MVCC_INTVALUE width, height;
+  HikCheck(MV_CC_GetIntValue(camera_handle_, "Width", &width), "Width");
+  HikCheck(MV_CC_GetIntValue(camera_handle_, "Height", &height), "Height");
+  sensor_size_ = cv::Size(width.nCurValue, height.nCurValue);
+
   HikCheck(MV_CC_StartGrabbing(camera_handle_), "StartGrabbing");
   return true;
 }
@@ -204,6 +217,125 @@ HikCamera::~HikCamera() {
   SPDLOG_TRACE("Destructed.");
 }
 
+/**
+ * @brief 在传感器上设置感兴趣区域，减少读出行数以提高帧率
+ *
+ * @param roi 输出图像坐标系下的区域，为空或覆盖整幅图像时恢复全图
+ * @return true 设置成功
+ * @return false 设置失败
+ */
+bool HikCamera::SetRegionOfInterest(const cv::Rect &roi) {
+  if (nullptr == camera_handle_) return Camera::SetRegionOfInterest(roi);
+
+  const cv::Rect full(0, 0, frame_w_, frame_h_);
+  const cv::Rect out_roi = roi & full;
+
+  MVCC_INTVALUE width_max, height_max, width, height, offset_x, offset_y;
+  if (!(HikCheck(MV_CC_GetIntValue(camera_handle_, "WidthMax", &width_max),
+                 "WidthMax", false) &&
+        HikCheck(MV_CC_GetIntValue(camera_handle_, "HeightMax", &height_max),
+                 "HeightMax", false) &&
+        HikCheck(MV_CC_GetIntValue(camera_handle_, "Width", &width), "Width",
+                 false) &&
+        HikCheck(MV_CC_GetIntValue(camera_handle_, "Height", &height),
+                 "Height", false) &&
+        HikCheck(MV_CC_GetIntValue(camera_handle_, "OffsetX", &offset_x),
+                 "OffsetX", false) &&
+        HikCheck(MV_CC_GetIntValue(camera_handle_, "OffsetY", &offset_y),
+                 "OffsetY", false))) {
+    return Camera::SetRegionOfInterest(roi);
+  }
+
+  /* 输出图像由整幅传感器图像缩放而来 */
+  const double scale_x = static_cast<double>(width_max.nMax) / frame_w_;
+  const double scale_y = static_cast<double>(height_max.nMax) / frame_h_;
+
+  /* 按相机要求的步长对齐，向外扩展以保证覆盖所需区域 */
+  auto align_down = [](int value, unsigned int inc) {
+    return inc > 1 ? value / static_cast<int>(inc) * static_cast<int>(inc)
+                   : value;
+  };
+  auto align_up = [](int value, unsigned int inc) {
+    const int step = std::max(1, static_cast<int>(inc));
+    return (value + step - 1) / step * step;
+  };
+
+  cv::Rect sensor(0, 0, width_max.nMax, height_max.nMax);
+  if (!out_roi.empty() && out_roi != full) {
+    sensor.x = align_down(static_cast<int>(std::floor(out_roi.x * scale_x)),
+                          offset_x.nInc);
+    sensor.y = align_down(static_cast<int>(std::floor(out_roi.y * scale_y)),
+                          offset_y.nInc);
+    sensor.width = align_up(
+        static_cast<int>(std::ceil(out_roi.br().x * scale_x)) - sensor.x,
+        width.nInc);
+    sensor.height = align_up(
+        static_cast<int>(std::ceil(out_roi.br().y * scale_y)) - sensor.y,
+        height.nInc);
+    sensor.width = std::max<int>(sensor.width, width.nMin);
+    sensor.height = std::max<int>(sensor.height, height.nMin);
+    sensor.x = std::min<int>(sensor.x, width_max.nMax - sensor.width);
+    sensor.y = std::min<int>(sensor.y, height_max.nMax - sensor.height);
+  }
+
+  HikCheck(MV_CC_StopGrabbing(camera_handle_), "StopGrabbing");
+
+  /* 先清零偏移，否则增大宽高时可能越界 */
+  bool ok = HikCheck(MV_CC_SetIntValue(camera_handle_, "OffsetX", 0),
+                     "OffsetX", false) &&
+            HikCheck(MV_CC_SetIntValue(camera_handle_, "OffsetY", 0),
+                     "OffsetY", false) &&
+            HikCheck(MV_CC_SetIntValue(camera_handle_, "Width", sensor.width),
+                     "Width", false) &&
+            HikCheck(MV_CC_SetIntValue(camera_handle_, "Height", sensor.height),
+                     "Height", false) &&
+            HikCheck(MV_CC_SetIntValue(camera_handle_, "OffsetX", sensor.x),
+                     "OffsetX", false) &&
+            HikCheck(MV_CC_SetIntValue(camera_handle_, "OffsetY", sensor.y),
+                     "OffsetY", false);
+
+  if (!ok) {
+    SPDLOG_WARN("Sensor ROI not supported, fall back to software crop.");
+    MV_CC_SetIntValue(camera_handle_, "Width", width_max.nMax);
+    MV_CC_SetIntValue(camera_handle_, "Height", height_max.nMax);
+    sensor = cv::Rect(0, 0, width_max.nMax, height_max.nMax);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(frame_stack_mutex_);
+    frame_stack_.clear();
+    sensor_size_ = sensor.size();
+  }
+
+  HikCheck(MV_CC_StartGrabbing(camera_handle_), "StartGrabbing");
+
+  MVCC_FLOATVALUE frame_rate;
+  if (HikCheck(MV_CC_GetFloatValue(camera_handle_, "ResultingFrameRate",
+                                   &frame_rate),
+               "ResultingFrameRate", false)) {
+    SPDLOG_INFO("ResultingFrameRate: {}.", frame_rate.fCurValue);
+  }
+
+  if (!ok) return Camera::SetRegionOfInterest(roi);
+
+  std::lock_guard<std::mutex> lock(frame_stack_mutex_);
+  if (sensor.size() == cv::Size(width_max.nMax, height_max.nMax)) {
+    roi_ = cv::Rect();
+    roi_origin_ = cv::Point2f(0., 0.);
+    hw_roi_ = false;
+  } else {
+    /* 对齐后的传感器区域映射回输出图像坐标系 */
+    roi_origin_ = cv::Point2f(sensor.x / scale_x, sensor.y / scale_y);
+    roi_ = cv::Rect(cvRound(roi_origin_.x), cvRound(roi_origin_.y),
+                    cvRound(sensor.width / scale_x),
+                    cvRound(sensor.height / scale_y));
+    hw_roi_ = true;
+  }
+  SPDLOG_DEBUG("Sensor ROI: {}, {}, {}, {}", sensor.x, sensor.y, sensor.width,
+               sensor.height);
+  return true;
+}
+
 /**
  * @brief 关闭相机设备
  *
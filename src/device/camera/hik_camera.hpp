@@ -13,6 +13,7 @@ class HikCamera : public Camera {
   MV_CC_DEVICE_INFO_LIST mv_dev_list_;
   void *camera_handle_ = nullptr;
   MV_FRAME_OUT raw_frame_;
+  cv::Size sensor_size_;
 
   void GrabPrepare();
   void GrabLoop();
@@ -46,6 +47,15 @@ class HikCamera : public Camera {
    */
   ~HikCamera();
 
+  /**
+   * @brief 在传感器上设置感兴趣区域，减少读出行数以提高帧率
+   *
+   * @param roi 输出图像坐标系下的区域，为空或覆盖整幅图像时恢复全图
+   * @return true 设置成功
+   * @return false 设置失败
+   */
+  bool SetRegionOfInterest(const cv::Rect &roi) override;
+
   /**
    * @brief 关闭相机设备
    *
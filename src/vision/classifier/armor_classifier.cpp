@@ -1,10 +1,19 @@
 #include "armor_classifier.hpp"
 
+#include <execution>
+#include <numeric>
+
 #include "opencv2/dnn.hpp"
 #include "opencv2/imgproc.hpp"
 #include "opencv2/opencv.hpp"
 #include "spdlog/spdlog.h"
 
+namespace {
+
+const double kSCALE = 1. / 128.;
+
+}  // namespace
+
 ArmorClassifier::ArmorClassifier(const std::string model_path,
                                  const std::string lable_path,
                                  const cv::Size &input_size) {
@@ -18,7 +27,13 @@ ArmorClassifier::ArmorClassifier() { SPDLOG_TRACE("Constructed."); }
 ArmorClassifier::~ArmorClassifier() { SPDLOG_TRACE("Destructed."); }
 
 void ArmorClassifier::LoadModel(const std::string &path) {
-  net_ = cv::dnn::readNet(path);
+  try {
+    net_ = cv::dnn::readNet(path);
+  } catch (const cv::Exception &e) {
+    SPDLOG_ERROR("Can not load '{}': {}", path, e.what());
+    net_ = cv::dnn::Net();
+  }
+  if (!tiny_cnn_.LoadModel(path)) SPDLOG_WARN("Fall back to OpenCV DNN.");
 }
 
 void ArmorClassifier::LoadLable(const std::string &path) {
@@ -36,13 +51,111 @@ void ArmorClassifier::SetInputSize(const cv::Size &input_size) {
   net_input_size_ = input_size;
 }
 
+bool ArmorClassifier::LoadTemplates(const std::string &lable_path,
+                                    const std::string &dir) {
+  return matcher_.LoadTemplates(lable_path, dir);
+}
+
+void ArmorClassifier::SetQuantized(bool quantized) {
+  tiny_cnn_.SetQuantized(quantized);
+}
+
+bool ArmorClassifier::UseTinyCnn() const {
+  return tiny_cnn_.Loaded() && tiny_cnn_.InputSize() == net_input_size_ &&
+         tiny_cnn_.OutputSize() == static_cast<int>(classes_.size());
+}
+
+bool ArmorClassifier::UseTemplates() const {
+  return net_.empty() && !UseTinyCnn() && matcher_.TemplateCount() > 0;
+}
+
+cv::Mat ArmorClassifier::Forward(int count) {
+  if (!UseTinyCnn()) {
+    net_.setInput(blob_);
+    return net_.forward().reshape(1, count);
+  }
+
+  /* 网络很小，逐张推理比 cv::dnn 的调度开销小得多 */
+  cv::Mat prob(count, tiny_cnn_.OutputSize(), CV_32F);
+  for (int k = 0; k < count; ++k)
+    tiny_cnn_.Forward(blob_.ptr<float>(k), prob.ptr<float>(k));
+  return prob;
+}
+
 void ArmorClassifier::ClassifyModel(Armor &armor, const cv::Mat &frame) {
-  cv::Mat image = armor.Face(frame);
-  cv::dnn::blobFromImage(image, blob_, 1. / 128., net_input_size_);
-  net_.setInput(blob_);
-  cv::Mat prob = net_.forward();
+  FrameContext ctx(frame);
+  ClassifyModel(armor, ctx);
+}
+
+void ArmorClassifier::ClassifyModel(Armor &armor, FrameContext &ctx) {
+  if (UseTemplates()) {
+    matcher_.Match(armor, ctx);
+    model_ = armor.GetModel();
+    conf_ = armor.GetModelConf();
+    return;
+  }
+
+  blob_.create({1, 1, net_input_size_.height, net_input_size_.width}, CV_32F);
+  armor.FaceBlob(ctx, net_input_size_, kSCALE, blob_.ptr<float>(0));
+  cv::Mat prob = Forward(1);
   cv::Point class_point;
-  cv::minMaxLoc(prob.reshape(1, 1), nullptr, &conf_, nullptr, &class_point);
+  cv::minMaxLoc(prob, nullptr, &conf_, nullptr, &class_point);
   model_ = classes_[class_point.x];
   armor.SetModel(model_);
+  armor.SetModelConf(conf_);
+}
+
+void ArmorClassifier::ClassifyBatch(tbb::concurrent_vector<Armor> &armors,
+                                    const cv::Mat &frame) {
+  FrameContext ctx(frame);
+  ClassifyBatch(armors, ctx);
 }
+
+void ArmorClassifier::Classify(tbb::concurrent_vector<Armor> &armors,
+                               FrameContext &ctx,
+                               const std::vector<std::size_t> &indices) {
+  if (indices.empty()) return;
+  if (UseTemplates()) {
+    matcher_.MatchBatch(armors, ctx, indices);
+    return;
+  }
+
+  /* 先生成共享的灰度图，并行提取图案时不必排队等待 */
+  ctx.FaceGray();
+  const int count = static_cast<int>(indices.size());
+  blob_.create({count, 1, net_input_size_.height, net_input_size_.width},
+               CV_32F);
+  order_.resize(indices.size());
+  std::iota(order_.begin(), order_.end(), 0);
+  std::for_each(std::execution::par_unseq, order_.begin(), order_.end(),
+                [&](std::size_t k) {
+                  armors[indices[k]].FaceBlob(ctx, net_input_size_, kSCALE,
+                                              blob_.ptr<float>(k));
+                });
+
+  cv::Mat prob = Forward(count);
+
+  for (std::size_t k = 0; k < indices.size(); ++k) {
+    double conf;
+    cv::Point class_point;
+    cv::minMaxLoc(prob.row(k), nullptr, &conf, nullptr, &class_point);
+    armors[indices[k]].SetModel(classes_[class_point.x]);
+    armors[indices[k]].SetModelConf(conf);
+  }
+}
+
+void ArmorClassifier::ClassifyBatch(tbb::concurrent_vector<Armor> &armors,
+                                    FrameContext &ctx) {
+  std::vector<std::size_t> indices(armors.size());
+  std::iota(indices.begin(), indices.end(), 0);
+  Classify(armors, ctx, indices);
+}
+
+void ArmorClassifier::ClassifyTracked(tbb::concurrent_vector<Armor> &armors,
+                                      FrameContext &ctx) {
+  const auto pending = cache_.Lookup(armors);
+  Classify(armors, ctx, pending);
+  cache_.Update(armors, pending);
+}
+
+double ArmorClassifier::CacheHitRate() const { return cache_.HitRate(); }
@@ -3,8 +3,12 @@
 #include <vector>
 
 #include "armor.hpp"
+#include "classifier_cache.hpp"
 #include "common.hpp"
 #include "opencv2/opencv.hpp"
+#include "tbb/concurrent_vector.h"
+#include "template_matcher.hpp"
+#include "tiny_cnn.hpp"
 
 class ArmorClassifier {
  private:
@@ -14,6 +18,16 @@ class ArmorClassifier {
   cv::Size net_input_size_;
   cv::Mat blob_;
   game::Model model_;
+  std::vector<std::size_t> order_;
+  ClassifierCache cache_;
+  TinyCnn tiny_cnn_;
+  TemplateMatcher matcher_;
+
+  bool UseTinyCnn() const;
+  bool UseTemplates() const;
+  cv::Mat Forward(int count);
+  void Classify(tbb::concurrent_vector<Armor> &armors, FrameContext &ctx,
+                const std::vector<std::size_t> &indices);
 
  public:
   ArmorClassifier();
@@ -25,5 +39,43 @@ class ArmorClassifier {
   void LoadLable(const std::string &path);
   void SetInputSize(const cv::Size &input_size);
 
+  /**
+   * @brief 读入数字模板，模型不可用时改用模板匹配分类
+   *
+   * @param lable_path 标签文件
+   * @param dir 模板目录，第 i 个标签对应 "<标签>.png"
+   * @return true 至少读入一个模板
+   * @return false 没有可用模板
+   */
+  bool LoadTemplates(const std::string &lable_path, const std::string &dir);
+
+  /**
+   * @brief 轻量推理使用 int8 量化，模型回退到 OpenCV DNN 时无效
+   *
+   * @param quantized 是否量化
+   */
+  void SetQuantized(bool quantized);
+
   void ClassifyModel(Armor &armor, const cv::Mat &frame);
+  void ClassifyModel(Armor &armor, FrameContext &ctx);
+
+  /**
+   * @brief 所有装甲板的图案放在一个 blob 中，一次前向推理完成分类
+   *
+   * @param armors 装甲板，型号和置信度写回每个装甲板
+   * @param frame 原图
+   */
+  void ClassifyBatch(tbb::concurrent_vector<Armor> &armors,
+                     const cv::Mat &frame);
+  void ClassifyBatch(tbb::concurrent_vector<Armor> &armors, FrameContext &ctx);
+
+  /**
+   * @brief 只对新出现、置信度低或需要刷新的装甲板做推理，其余复用缓存
+   *
+   * @param armors 装甲板，型号和置信度写回每个装甲板
+   * @param ctx 帧上下文
+   */
+  void ClassifyTracked(tbb::concurrent_vector<Armor> &armors,
+                       FrameContext &ctx);
+  double CacheHitRate() const;
 };
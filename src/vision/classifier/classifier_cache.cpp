@@ -0,0 +1,117 @@
+#include "classifier_cache.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "spdlog/spdlog.h"
+
+namespace {
+
+const float kGATE_RATIO = 0.5f; /* 中心距离门限，相对装甲板尺寸 */
+const float kSIZE_RATIO = 1.5f; /* 相邻帧尺寸变化上限 */
+const int kMAX_MISSED = 3;
+
+float ArmorSize(const Armor &armor) {
+  const cv::Size2f size = armor.GetRect().size;
+  return std::max(size.width, size.height);
+}
+
+}  // namespace
+
+ClassifierCache::ClassifierCache(double conf_thresh, int refresh_interval)
+    : conf_thresh_(conf_thresh), refresh_interval_(refresh_interval) {
+  SPDLOG_TRACE("Constructed.");
+}
+
+ClassifierCache::~ClassifierCache() { SPDLOG_TRACE("Destructed."); }
+
+std::vector<std::size_t> ClassifierCache::Lookup(
+    tbb::concurrent_vector<Armor> &armors) {
+  std::vector<std::size_t> pending;
+  std::vector<bool> used(tracks_.size(), false);
+  matches_.assign(armors.size(), -1);
+
+  for (std::size_t i = 0; i < armors.size(); ++i) {
+    const cv::Point2f center = armors[i].GetRect().center;
+    const float size = ArmorSize(armors[i]);
+
+    /* 门限内距离最近且尺寸相近的跟踪 */
+    int best = -1;
+    float best_dist = std::numeric_limits<float>::max();
+    for (std::size_t t = 0; t < tracks_.size(); ++t) {
+      if (used[t]) continue;
+      const Track &track = tracks_[t];
+      const float ratio = size / track.size;
+      if (ratio > kSIZE_RATIO || ratio < 1.f / kSIZE_RATIO) continue;
+      const float dist = cv::norm(center - track.center);
+      if (dist < kGATE_RATIO * track.size && dist < best_dist) {
+        best = t;
+        best_dist = dist;
+      }
+    }
+
+    matches_[i] = best;
+    if (best < 0) {
+      pending.push_back(i);
+      continue;
+    }
+
+    used[best] = true;
+    Track &track = tracks_[best];
+    track.center = center;
+    track.size = size;
+    track.missed = 0;
+    if (track.conf < conf_thresh_ || ++track.age >= refresh_interval_) {
+      pending.push_back(i);
+      continue;
+    }
+    armors[i].SetModel(track.model);
+    armors[i].SetModelConf(track.conf);
+    ++hits_;
+  }
+  queries_ += armors.size();
+
+  /* 未关联的跟踪累计丢失帧数，过期删除 */
+  for (std::size_t t = 0; t < tracks_.size(); ++t)
+    if (!used[t]) ++tracks_[t].missed;
+  return pending;
+}
+
+void ClassifierCache::Update(const tbb::concurrent_vector<Armor> &armors,
+                             const std::vector<std::size_t> &classified) {
+  for (std::size_t i : classified) {
+    if (i >= matches_.size()) continue;
+    if (matches_[i] < 0) {
+      Track track;
+      track.id = next_id_++;
+      track.center = armors[i].GetRect().center;
+      track.size = ArmorSize(armors[i]);
+      track.model = armors[i].GetModel();
+      track.conf = armors[i].GetModelConf();
+      tracks_.push_back(track);
+    } else {
+      Track &track = tracks_[matches_[i]];
+      track.model = armors[i].GetModel();
+      track.conf = armors[i].GetModelConf();
+      track.age = 0;
+    }
+  }
+
+  tracks_.erase(std::remove_if(tracks_.begin(), tracks_.end(),
+                               [](const Track &track) {
+                                 return track.missed > kMAX_MISSED;
+                               }),
+                tracks_.end());
+  matches_.clear();
+}
+
+void ClassifierCache::Clear() {
+  tracks_.clear();
+  matches_.clear();
+  queries_ = hits_ = 0;
+}
+
+double ClassifierCache::HitRate() const {
+  return queries_ > 0 ? static_cast<double>(hits_) / queries_ : 0.;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "armor.hpp"
+#include "common.hpp"
+#include "opencv2/opencv.hpp"
+#include "tbb/concurrent_vector.h"
+
+/**
+ * @brief 按跟踪序列缓存装甲板分类结果
+ * 相邻帧按中心距离和尺寸关联装甲板，跟踪期间型号不会改变，
+ * 只有新出现、置信度低或超过刷新间隔的装甲板需要重新分类
+ *
+ */
+class ClassifierCache {
+ private:
+  struct Track {
+    int id;
+    cv::Point2f center;
+    float size;
+    game::Model model = game::Model::kUNKNOWN;
+    double conf = 0.;
+    int age = 0;    /* 距上次分类的帧数 */
+    int missed = 0; /* 连续未关联的帧数 */
+  };
+
+  std::vector<Track> tracks_;
+  std::vector<int> matches_; /* 每个装甲板关联的跟踪序号，-1 为新目标 */
+  int next_id_ = 0;
+
+  double conf_thresh_;
+  int refresh_interval_;
+
+  uint64_t queries_ = 0, hits_ = 0;
+
+ public:
+  /**
+   * @brief Construct a new Classifier Cache object
+   *
+   * @param conf_thresh 低于此置信度的结果不复用
+   * @param refresh_interval 复用超过此帧数后重新分类
+   */
+  explicit ClassifierCache(double conf_thresh = 0.8,
+                           int refresh_interval = 30);
+  ~ClassifierCache();
+
+  /**
+   * @brief 关联装甲板，命中缓存的直接写入型号和置信度
+   *
+   * @param armors 本帧装甲板
+   * @return std::vector<std::size_t> 需要重新分类的装甲板序号
+   */
+  std::vector<std::size_t> Lookup(tbb::concurrent_vector<Armor> &armors);
+
+  /**
+   * @brief 用分类结果更新缓存，需紧接在 Lookup 之后调用
+   *
+   * @param armors 本帧装甲板
+   * @param classified 重新分类过的装甲板序号
+   */
+  void Update(const tbb::concurrent_vector<Armor> &armors,
+              const std::vector<std::size_t> &classified);
+
+  void Clear();
+
+  /**
+   * @brief 缓存命中率
+   *
+   * @return double 命中次数除以查询次数
+   */
+  double HitRate() const;
+};
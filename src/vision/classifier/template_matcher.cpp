@@ -1,97 +1,139 @@
 #include "template_matcher.hpp"
 
-[[deprecated("discard function")]] int TemplaterMatcher::GetArmorId(
-    cv::Mat &armor_face) {
-  cv::Mat img = armor_face;
-  if (img.empty()) {
-    SPDLOG_ERROR("Armor Face Empty!");
-    return -1;
-  }
-  cv::Mat clone_img = img.clone();                       // 原图备份
-  cv::cvtColor(img, img, cv::COLOR_BGR2GRAY);            // 图片转灰度
-  cv::threshold(img, img, 100, 255, cv::THRESH_BINARY);  // 二值化
-  cv::Mat clone_img1 = img.clone();              // 备份二值化后的原图
-  std::vector<std::vector<cv::Point>> contours;  // 存储原图轮廓
-  std::vector<cv::Vec4i> hierarcy;
-  cv::findContours(img, contours, hierarcy, cv::RETR_EXTERNAL,
-                   cv::CHAIN_APPROX_NONE);           // 查找轮廓
-  std::vector<cv::Rect> sort_rect(contours.size());  // 外接矩形
-  std::vector<cv::Mat> img_mat;  // 存储原图中的有效数字区域
-  for (int i = 0; size_t(i) < contours.size(); i++) {
-    sort_rect[i] = cv::boundingRect(contours[i]);  // 外接矩形
-    cv::Mat roi = clone_img1(sort_rect[i]);
-    cv::Mat dstroi;
-    cv::resize(roi, dstroi, roi.size(), 0, 0);  // 重设大小
-    img_mat.push_back(dstroi);
-  }
-  // 对矩形进行排序，因为轮廓的顺序不一定是数字真正的顺序
-  for (int i = 0; size_t(i) < sort_rect.size(); i++) {
-    for (int j = i + 1; size_t(j) < sort_rect.size(); j++) {
-      if (sort_rect[j].x < sort_rect[i].x) {
-        std::swap(img_mat[i], img_mat[j]);
-      }
-    }
+#include <bitset>
+#include <execution>
+#include <numeric>
+
+#include "opencv2/core/hal/intrin.hpp"
+#include "spdlog/spdlog.h"
+
+namespace {
+
+const int kSIZE = 32;
+const int kBITS = kSIZE * kSIZE;
+
+static_assert(sizeof(TemplateMatcher::Mask) * 8 == kBITS,
+              "Mask must hold a kSIZE x kSIZE bitmap.");
+
+}  // namespace
+
+TemplateMatcher::TemplateMatcher(double thresh) : thresh_(thresh) {
+  SPDLOG_TRACE("Constructed.");
+}
+
+TemplateMatcher::~TemplateMatcher() { SPDLOG_TRACE("Destructed."); }
+
+bool TemplateMatcher::LoadTemplates(const std::string &lable_path,
+                                    const std::string &dir) {
+  cv::FileStorage fs(lable_path,
+                     cv::FileStorage::READ | cv::FileStorage::FORMAT_JSON);
+  if (!fs.isOpened()) {
+    SPDLOG_ERROR("Can not open '{}'.", lable_path);
+    return false;
   }
-  std::vector<cv::Mat> templates;  // 模板容器
-  for (int i = 1; i < 4; i++) {
-    std::string name = cv::format("%s/template/%d.png", kPATH_IMAGE, i);
-    cv::Mat temp = cv::imread(name);
-    if (temp.empty()) {
-      SPDLOG_ERROR("模板读取失败");
-      return -1;
+
+  cv::FileNode root = fs.root();
+  for (size_t i = 0; i < root.size(); ++i) {
+    const std::string name(root[std::to_string(i)]);
+    const std::string path = dir + "/" + name + ".png";
+    cv::Mat image = cv::imread(path, cv::IMREAD_GRAYSCALE);
+    if (image.empty()) {
+      SPDLOG_WARN("Template '{}' not found.", path);
+      continue;
     }
-    cv::cvtColor(temp, temp, cv::COLOR_BGR2GRAY);
-    cv::threshold(temp, temp, 100, 255, cv::THRESH_BINARY);
-    templates.push_back(temp);
+    AddTemplate(game::StringToModel(name), image);
   }
-  if (templates.empty()) {
-    SPDLOG_ERROR("模板导入失败");
-    return -2;
-  }
-  if (img_mat.empty()) {
-    SPDLOG_ERROR("二值化处理之后的源导入失败");
-    return -2;
-  }
-  std::vector<int> seq;  // 顺序存放识别结果
-  for (int i = 0; size_t(i) < img_mat.size(); i++) {
-    double com = 0;
-    double min = 0;
-    int min_seq = 0;  // 记录识别结果
-    for (int j = 0; size_t(j) < templates.size(); j++) {
-      com = MatchTemplate(img_mat[i], templates[j]);
-      if (com > min) {
-        min = com;
-        min_seq = j;
-      }
-      com = 0;
-    }
-    seq.push_back(min_seq + 1);
+  SPDLOG_INFO("Loaded {} templates.", templates_.size());
+  return !templates_.empty();
+}
+
+void TemplateMatcher::AddTemplate(game::Model model, const cv::Mat &image) {
+  models_.push_back(model);
+  templates_.push_back(Pack(image));
+}
+
+std::size_t TemplateMatcher::TemplateCount() const { return templates_.size(); }
+
+TemplateMatcher::Mask TemplateMatcher::Pack(const cv::Mat &image) {
+  Mask mask{};
+  if (image.empty()) return mask;
+
+  cv::Mat gray, resized, binary;
+  if (image.channels() == 3)
+    cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
+  else
+    gray = image;
+  if (gray.size() != cv::Size(kSIZE, kSIZE))
+    cv::resize(gray, resized, cv::Size(kSIZE, kSIZE), 0, 0, cv::INTER_AREA);
+  else
+    resized = gray;
+  cv::threshold(resized, binary, 0., 255.,
+                cv::THRESH_BINARY | cv::THRESH_OTSU);
+
+  /* 二值图只有 0 和 255，最高位就是该像素的值 */
+  for (int r = 0; r < kSIZE; ++r) {
+    const uchar *row = binary.ptr<uchar>(r);
+    uint64_t bits = 0;
+    int c = 0;
+#if CV_SIMD128
+    for (; c + cv::v_uint8x16::nlanes <= kSIZE; c += cv::v_uint8x16::nlanes)
+      bits |= static_cast<uint64_t>(cv::v_signmask(cv::v_load(row + c))) << c;
+#endif
+    for (; c < kSIZE; ++c) bits |= static_cast<uint64_t>(row[c] >> 7) << c;
+    mask[r / 2] |= bits << (r % 2 * kSIZE);
   }
-  if (!seq.empty()) return seq[0] + 1;
-  return 0;
+  return mask;
+}
+
+int TemplateMatcher::Distance(const Mask &mask1, const Mask &mask2) {
+  int distance = 0;
+  for (std::size_t i = 0; i < mask1.size(); ++i)
+    distance += std::bitset<64>(mask1[i] ^ mask2[i]).count();
+  return distance;
 }
 
-[[deprecated("discard function")]] double TemplaterMatcher::MatchTemplate(
-    cv::Mat &img, cv::Mat &temp) {
-  cv::Mat my_temp;
-  cv::resize(temp, my_temp, img.size());
-  int rows, cols;
-  uchar *img_point, *temp_point;  // 像素类型uchar
-  rows = my_temp.rows;
-  cols = my_temp.cols * img.channels();
-  double result, same = 0.0, different = 0.0;
-  for (int i = 0; i < rows; i++) {  // 遍历图像像素
-    // 获取像素值
-    img_point = img.ptr<uchar>(i);
-    temp_point = my_temp.ptr<uchar>(i);
-    for (int j = 0; j < cols; j++) {
-      if (img_point[j] == temp_point[j])
-        same++;  // 记录像素相同的个数
-      else
-        different++;  // 记录像素不同的个数
+game::Model TemplateMatcher::Match(const Mask &face,
+                                   double *similarity) const {
+  int best = -1;
+  int best_distance = kBITS + 1;
+  for (std::size_t i = 0; i < templates_.size(); ++i) {
+    const int distance = Distance(face, templates_[i]);
+    if (distance < best_distance) {
+      best = i;
+      best_distance = distance;
     }
   }
-  result = same / (same + different);
-  SPDLOG_DEBUG("Armor Number Match Result:{}", result);
-  return result;  // 返回匹配结果
+
+  const double result =
+      best < 0 ? 0. : 1. - static_cast<double>(best_distance) / kBITS;
+  if (similarity != nullptr) *similarity = result;
+  if (best < 0 || result < thresh_) return game::Model::kUNKNOWN;
+  return models_[best];
+}
+
+game::Model TemplateMatcher::Match(const cv::Mat &face,
+                                   double *similarity) const {
+  return Match(Pack(face), similarity);
+}
+
+void TemplateMatcher::Match(Armor &armor, FrameContext &ctx) const {
+  double similarity;
+  armor.SetModel(Match(Pack(armor.Face(ctx, {kSIZE, kSIZE})), &similarity));
+  armor.SetModelConf(similarity);
+}
+
+void TemplateMatcher::MatchBatch(tbb::concurrent_vector<Armor> &armors,
+                                 FrameContext &ctx) const {
+  std::vector<std::size_t> indices(armors.size());
+  std::iota(indices.begin(), indices.end(), 0);
+  MatchBatch(armors, ctx, indices);
+}
+
+void TemplateMatcher::MatchBatch(
+    tbb::concurrent_vector<Armor> &armors, FrameContext &ctx,
+    const std::vector<std::size_t> &indices) const {
+  /* 先生成共享的灰度图，并行提取图案时不必排队等待 */
+  ctx.FaceGray();
+  std::for_each(std::execution::par_unseq, indices.begin(), indices.end(),
+                [&](std::size_t i) { Match(armors[i], ctx); });
 }
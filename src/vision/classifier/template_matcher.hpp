@@ -1,12 +1,88 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
+#include <string>
 #include <vector>
 
 #include "armor.hpp"
 #include "common.hpp"
+#include "frame_context.hpp"
 #include "opencv2/opencv.hpp"
+#include "tbb/concurrent_vector.h"
 
-class TemplaterMatcher {
-  int GetArmorId(cv::Mat &armor_face);
-  double MatchTemplate(cv::Mat &img, cv::Mat &temp);
+/**
+ * @brief 基于二值模板的装甲板数字匹配
+ * 模板在启动时读入并二值化为 32x32 的位图，匹配时只做异或和 popcount，
+ * 可在网络不可用时兜底，或作为分类前的快速筛选
+ *
+ */
+class TemplateMatcher {
+ public:
+  /* 32x32 二值图，每行 32 位，两行一个字 */
+  using Mask = std::array<uint64_t, 16>;
+
+ private:
+  std::vector<game::Model> models_;
+  std::vector<Mask> templates_;
+  double thresh_;
+
+ public:
+  /**
+   * @brief Construct a new Template Matcher object
+   *
+   * @param thresh 相似度低于此值时结果为 kUNKNOWN
+   */
+  explicit TemplateMatcher(double thresh = 0.75);
+  ~TemplateMatcher();
+
+  /**
+   * @brief 按标签文件读入模板，第 i 个标签对应 dir 下的 "<标签>.png"
+   *
+   * @param lable_path 与分类网络相同格式的标签文件
+   * @param dir 模板目录
+   * @return true 至少读入一个模板
+   * @return false 没有可用模板
+   */
+  bool LoadTemplates(const std::string &lable_path, const std::string &dir);
+  void AddTemplate(game::Model model, const cv::Mat &image);
+  std::size_t TemplateCount() const;
+
+  /**
+   * @brief 缩放到 32x32，Otsu 二值化后按位打包
+   *
+   * @param image 灰度或 BGR 图案
+   * @return Mask 位图
+   */
+  static Mask Pack(const cv::Mat &image);
+  static int Distance(const Mask &mask1, const Mask &mask2);
+
+  /**
+   * @brief 找出汉明距离最小的模板
+   *
+   * @param face 打包后的图案
+   * @param similarity 输出相似度，为 1 减去不同像素的比例
+   * @return game::Model 匹配结果
+   */
+  game::Model Match(const Mask &face, double *similarity = nullptr) const;
+  game::Model Match(const cv::Mat &face, double *similarity = nullptr) const;
+
+  /**
+   * @brief 匹配单个装甲板，型号和相似度写回装甲板
+   *
+   * @param armor 装甲板
+   * @param ctx 帧上下文
+   */
+  void Match(Armor &armor, FrameContext &ctx) const;
+
+  /**
+   * @brief 并行匹配所有装甲板，型号和相似度写回每个装甲板
+   *
+   * @param armors 装甲板
+   * @param ctx 帧上下文
+   */
+  void MatchBatch(tbb::concurrent_vector<Armor> &armors,
+                  FrameContext &ctx) const;
+  void MatchBatch(tbb::concurrent_vector<Armor> &armors, FrameContext &ctx,
+                  const std::vector<std::size_t> &indices) const;
 };
@@ -0,0 +1,527 @@
+#include "tiny_cnn.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+
+#include "onnx_reader.hpp"
+#include "opencv2/core/hal/intrin.hpp"
+#include "spdlog/spdlog.h"
+
+namespace {
+
+const int kMAX_ACTIVATION = 1024; /* 单层输出的最大元素数 */
+const int kMAX_COLUMN = 4096;     /* 卷积展开后的最大元素数 */
+
+/* ONNX TensorProto 的数据类型 */
+const int64_t kONNX_FLOAT = 1;
+const int64_t kONNX_INT64 = 7;
+
+using onnx::ProtoReader;
+using onnx::ReadFloats;
+using onnx::ReadInts;
+
+struct Tensor {
+  std::vector<int64_t> dims;
+  std::vector<float> data; /* int64 数据也转为 float */
+};
+
+struct Attribute {
+  float f = 0.f;
+  int64_t i = 0;
+  std::vector<int64_t> ints;
+};
+
+struct Node {
+  std::string op_type;
+  std::vector<std::string> inputs;
+  std::vector<std::string> outputs;
+  std::map<std::string, Attribute> attrs;
+};
+
+struct Graph {
+  std::vector<Node> nodes;
+  std::map<std::string, Tensor> initializers;
+  std::vector<std::pair<std::string, std::vector<int64_t>>> inputs;
+};
+
+bool ParseTensor(const std::string &bytes, std::string &name, Tensor &tensor) {
+  int64_t data_type = 0;
+  std::string raw;
+  std::vector<int64_t> ints;
+
+  ProtoReader reader(bytes);
+  int field, wire;
+  while (reader.Next(field, wire)) {
+    if (field == 1)
+      ReadInts(reader, wire, tensor.dims);
+    else if (field == 2)
+      data_type = static_cast<int64_t>(reader.Varint());
+    else if (field == 4)
+      ReadFloats(reader, wire, tensor.data);
+    else if (field == 7)
+      ReadInts(reader, wire, ints);
+    else if (field == 8)
+      name = reader.Bytes();
+    else if (field == 9)
+      raw = reader.Bytes();
+    else
+      reader.Skip(wire);
+  }
+
+  /* 按小端序存储的原始数据 */
+  if (data_type == kONNX_FLOAT && !raw.empty()) {
+    tensor.data.resize(raw.size() / sizeof(float));
+    std::memcpy(tensor.data.data(), raw.data(),
+                tensor.data.size() * sizeof(float));
+  } else if (data_type == kONNX_INT64) {
+    if (!raw.empty()) {
+      ints.resize(raw.size() / sizeof(int64_t));
+      std::memcpy(ints.data(), raw.data(), ints.size() * sizeof(int64_t));
+    }
+    tensor.data.assign(ints.begin(), ints.end());
+  }
+  return reader.Ok();
+}
+
+bool ParseAttribute(const std::string &bytes, Node &node) {
+  std::string name;
+  Attribute attr;
+
+  ProtoReader reader(bytes);
+  int field, wire;
+  while (reader.Next(field, wire)) {
+    if (field == 1)
+      name = reader.Bytes();
+    else if (field == 2)
+      attr.f = reader.Fixed32();
+    else if (field == 3)
+      attr.i = static_cast<int64_t>(reader.Varint());
+    else if (field == 8)
+      ReadInts(reader, wire, attr.ints);
+    else
+      reader.Skip(wire);
+  }
+  node.attrs[name] = attr;
+  return reader.Ok();
+}
+
+bool ParseNode(const std::string &bytes, Node &node) {
+  ProtoReader reader(bytes);
+  int field, wire;
+  bool ok = true;
+  while (reader.Next(field, wire)) {
+    if (field == 1)
+      node.inputs.push_back(reader.Bytes());
+    else if (field == 2)
+      node.outputs.push_back(reader.Bytes());
+    else if (field == 4)
+      node.op_type = reader.Bytes();
+    else if (field == 5)
+      ok &= ParseAttribute(reader.Bytes(), node);
+    else
+      reader.Skip(wire);
+  }
+  return ok && reader.Ok();
+}
+
+bool ParseGraph(const std::string &bytes, Graph &graph) {
+  ProtoReader reader(bytes);
+  int field, wire;
+  bool ok = true;
+  while (reader.Next(field, wire)) {
+    if (field == 1) {
+      graph.nodes.emplace_back();
+      ok &= ParseNode(reader.Bytes(), graph.nodes.back());
+    } else if (field == 5) {
+      std::string name;
+      Tensor tensor;
+      ok &= ParseTensor(reader.Bytes(), name, tensor);
+      graph.initializers[name] = tensor;
+    } else if (field == 11) {
+      graph.inputs.emplace_back();
+      auto &input = graph.inputs.back();
+      ok &= onnx::ParseValueInfo(reader.Bytes(), input.first, input.second);
+    } else {
+      reader.Skip(wire);
+    }
+  }
+  return ok && reader.Ok();
+}
+
+bool ParseModel(const std::string &bytes, Graph &graph) {
+  ProtoReader reader(bytes);
+  int field, wire;
+  bool found = false;
+  while (reader.Next(field, wire)) {
+    if (field == 7) {
+      if (!ParseGraph(reader.Bytes(), graph)) return false;
+      found = true;
+    } else {
+      reader.Skip(wire);
+    }
+  }
+  return found && reader.Ok();
+}
+
+int64_t AttrInt(const Node &node, const std::string &name, int64_t value) {
+  auto it = node.attrs.find(name);
+  return it == node.attrs.end() ? value : it->second.i;
+}
+
+float AttrFloat(const Node &node, const std::string &name, float value) {
+  auto it = node.attrs.find(name);
+  return it == node.attrs.end() ? value : it->second.f;
+}
+
+std::vector<int64_t> AttrInts(const Node &node, const std::string &name,
+                              const std::vector<int64_t> &value) {
+  auto it = node.attrs.find(name);
+  return it == node.attrs.end() ? value : it->second.ints;
+}
+
+float Dot(const float *a, const float *b, int size) {
+  int i = 0;
+  float sum = 0.f;
+#if CV_SIMD
+  const int lanes = cv::v_float32::nlanes;
+  cv::v_float32 v_sum = cv::vx_setzero_f32();
+  for (; i + lanes <= size; i += lanes)
+    v_sum = cv::v_fma(cv::vx_load(a + i), cv::vx_load(b + i), v_sum);
+  sum = cv::v_reduce_sum(v_sum);
+#endif
+  for (; i < size; ++i) sum += a[i] * b[i];
+  return sum;
+}
+
+/* int8 扩展到 int16 后相邻两项相乘累加到 int32 */
+int DotInt8(const int8_t *a, const int8_t *b, int size) {
+  int i = 0;
+  int sum = 0;
+#if CV_SIMD
+  const int lanes = cv::v_int16::nlanes;
+  cv::v_int32 v_sum = cv::vx_setzero_s32();
+  for (; i + lanes <= size; i += lanes)
+    v_sum +=
+        cv::v_dotprod(cv::vx_load_expand(a + i), cv::vx_load_expand(b + i));
+  sum = cv::v_reduce_sum(v_sum);
+#endif
+  for (; i < size; ++i) sum += a[i] * b[i];
+  return sum;
+}
+
+float MaxAbs(const float *data, int size) {
+  int i = 0;
+  float max_abs = 0.f;
+#if CV_SIMD
+  const int lanes = cv::v_float32::nlanes;
+  cv::v_float32 v_max = cv::vx_setzero_f32();
+  for (; i + lanes <= size; i += lanes)
+    v_max = cv::v_max(v_max, cv::v_abs(cv::vx_load(data + i)));
+  max_abs = cv::v_reduce_max(v_max);
+#endif
+  for (; i < size; ++i) max_abs = std::max(max_abs, std::abs(data[i]));
+  return max_abs;
+}
+
+/* 四组 float 取整后两次饱和打包成一组 int8 */
+void Quantize(const float *src, int8_t *dst, int size, float scale) {
+  const float inv_scale = 1.f / scale;
+  int i = 0;
+#if CV_SIMD
+  const int lanes = cv::v_int8::nlanes;
+  const int step = cv::v_float32::nlanes;
+  const cv::v_float32 v_inv = cv::vx_setall_f32(inv_scale);
+  for (; i + lanes <= size; i += lanes) {
+    const float *p = src + i;
+    const cv::v_int16 lo =
+        cv::v_pack(cv::v_round(cv::vx_load(p) * v_inv),
+                   cv::v_round(cv::vx_load(p + step) * v_inv));
+    const cv::v_int16 hi =
+        cv::v_pack(cv::v_round(cv::vx_load(p + 2 * step) * v_inv),
+                   cv::v_round(cv::vx_load(p + 3 * step) * v_inv));
+    cv::v_store(dst + i, cv::v_pack(lo, hi));
+  }
+#endif
+  for (; i < size; ++i) dst[i] = cv::saturate_cast<int8_t>(src[i] * inv_scale);
+}
+
+void Activate(float *data, int size, TinyCnn::Activation act, float alpha) {
+  if (act == TinyCnn::Activation::kNONE) return;
+  if (act == TinyCnn::Activation::kSIGMOID) {
+    for (int i = 0; i < size; ++i) data[i] = 1.f / (1.f + std::exp(-data[i]));
+    return;
+  }
+
+  /* ReLU 相当于负半轴斜率为 0 的 LeakyReLU */
+  const float slope = act == TinyCnn::Activation::kLEAKY_RELU ? alpha : 0.f;
+  int i = 0;
+#if CV_SIMD
+  const int lanes = cv::v_float32::nlanes;
+  const cv::v_float32 v_zero = cv::vx_setzero_f32();
+  const cv::v_float32 v_slope = cv::vx_setall_f32(slope);
+  for (; i + lanes <= size; i += lanes) {
+    const cv::v_float32 x = cv::vx_load(data + i);
+    cv::v_store(data + i, cv::v_select(x >= v_zero, x, x * v_slope));
+  }
+#endif
+  for (; i < size; ++i)
+    if (data[i] < 0.f) data[i] *= slope;
+}
+
+}  // namespace
+
+TinyCnn::TinyCnn() { SPDLOG_TRACE("Constructed."); }
+
+TinyCnn::TinyCnn(const std::string &onnx_path) {
+  LoadModel(onnx_path);
+  SPDLOG_TRACE("Constructed.");
+}
+
+TinyCnn::~TinyCnn() { SPDLOG_TRACE("Destructed."); }
+
+bool TinyCnn::LoadModel(const std::string &onnx_path) {
+  layers_.clear();
+
+  std::ifstream file(onnx_path, std::ios::binary);
+  if (!file) {
+    SPDLOG_ERROR("[TinyCnn] Can not open '{}'.", onnx_path);
+    return false;
+  }
+  const std::string bytes((std::istreambuf_iterator<char>(file)),
+                          std::istreambuf_iterator<char>());
+  Graph graph;
+  if (!ParseModel(bytes, graph)) {
+    SPDLOG_ERROR("[TinyCnn] Invalid model '{}'.", onnx_path);
+    return false;
+  }
+  auto find = [&](const Node &node, std::size_t i) -> const Tensor * {
+    if (i >= node.inputs.size()) return nullptr;
+    auto it = graph.initializers.find(node.inputs[i]);
+    return it == graph.initializers.end() ? nullptr : &it->second;
+  };
+
+  /* 输入为第一个不是权重的图输入，形状为 NCHW */
+  std::string current;
+  std::vector<int64_t> shape;
+  for (const auto &input : graph.inputs) {
+    if (graph.initializers.count(input.first) > 0) continue;
+    current = input.first;
+    shape = input.second;
+    break;
+  }
+  if (shape.size() != 4 || shape[1] <= 0 || shape[2] <= 0 || shape[3] <= 0) {
+    SPDLOG_ERROR("[TinyCnn] Input must be NCHW with fixed size.");
+    return false;
+  }
+  int c = shape[1], h = shape[2], w = shape[3];
+
+  std::vector<Layer> layers;
+  bool flattened = false;
+  for (const Node &node : graph.nodes) {
+    const std::string &op = node.op_type;
+    if (op == "Constant") continue;
+    if (node.inputs.empty() || node.inputs[0] != current ||
+        node.outputs.empty()) {
+      SPDLOG_ERROR("[TinyCnn] Only sequential models are supported.");
+      return false;
+    }
+    current = node.outputs[0];
+
+    if (op == "Conv") {
+      const Tensor *weight = find(node, 1);
+      const Tensor *bias = find(node, 2);
+      if (flattened || weight == nullptr || weight->dims.size() != 4 ||
+          weight->dims[1] != c) {
+        SPDLOG_ERROR("[TinyCnn] Conv weight does not match its input.");
+        return false;
+      }
+      const auto dilations = AttrInts(node, "dilations", {1, 1});
+      if (AttrInt(node, "group", 1) != 1 ||
+          std::any_of(dilations.begin(), dilations.end(),
+                      [](int64_t d) { return d != 1; })) {
+        SPDLOG_ERROR("[TinyCnn] Only dense undilated Conv is supported.");
+        return false;
+      }
+      const auto strides = AttrInts(node, "strides", {1, 1});
+      const auto pads = AttrInts(node, "pads", {0, 0, 0, 0});
+      if (strides.size() != 2 || pads.size() != 4) {
+        SPDLOG_ERROR("[TinyCnn] Only 2D Conv is supported.");
+        return false;
+      }
+
+      Layer layer;
+      layer.in_c = c;
+      layer.in_h = h;
+      layer.in_w = w;
+      layer.out_c = weight->dims[0];
+      layer.kernel_h = weight->dims[2];
+      layer.kernel_w = weight->dims[3];
+      layer.stride_h = strides[0];
+      layer.stride_w = strides[1];
+      layer.pad_t = pads[0];
+      layer.pad_l = pads[1];
+      layer.out_h = (h + pads[0] + pads[2] - layer.kernel_h) / strides[0] + 1;
+      layer.out_w = (w + pads[1] + pads[3] - layer.kernel_w) / strides[1] + 1;
+      layer.weight = weight->data;
+      layer.bias = bias != nullptr ? bias->data
+                                   : std::vector<float>(layer.out_c, 0.f);
+      if (layer.out_h <= 0 || layer.out_w <= 0 ||
+          layer.weight.size() != static_cast<std::size_t>(
+                                     layer.out_c * c * layer.kernel_h *
+                                     layer.kernel_w) ||
+          layer.bias.size() != static_cast<std::size_t>(layer.out_c)) {
+        SPDLOG_ERROR("[TinyCnn] Invalid Conv shape.");
+        return false;
+      }
+      c = layer.out_c;
+      h = layer.out_h;
+      w = layer.out_w;
+      layers.push_back(layer);
+    } else if (op == "BatchNormalization") {
+      /* 折叠到前一层卷积的权重和偏置中 */
+      const Tensor *gamma = find(node, 1), *beta = find(node, 2);
+      const Tensor *mean = find(node, 3), *var = find(node, 4);
+      const std::size_t n = c;
+      if (layers.empty() || layers.back().act != Activation::kNONE ||
+          flattened || !gamma || !beta || !mean || !var ||
+          gamma->data.size() != n || beta->data.size() != n ||
+          mean->data.size() != n || var->data.size() != n) {
+        SPDLOG_ERROR("[TinyCnn] BatchNormalization must follow Conv.");
+        return false;
+      }
+      Layer &layer = layers.back();
+      const float eps = AttrFloat(node, "epsilon", 1e-5f);
+      const std::size_t k = layer.weight.size() / n;
+      for (std::size_t oc = 0; oc < n; ++oc) {
+        const float s = gamma->data[oc] / std::sqrt(var->data[oc] + eps);
+        for (std::size_t j = 0; j < k; ++j) layer.weight[oc * k + j] *= s;
+        layer.bias[oc] = (layer.bias[oc] - mean->data[oc]) * s + beta->data[oc];
+      }
+    } else if (op == "Relu" || op == "LeakyRelu" || op == "Sigmoid") {
+      if (layers.empty() || layers.back().act != Activation::kNONE) {
+        SPDLOG_ERROR("[TinyCnn] Activation must follow Conv.");
+        return false;
+      }
+      Layer &layer = layers.back();
+      if (op == "Relu") {
+        layer.act = Activation::kRELU;
+      } else if (op == "LeakyRelu") {
+        layer.act = Activation::kLEAKY_RELU;
+        layer.alpha = AttrFloat(node, "alpha", 0.01f);
+      } else {
+        layer.act = Activation::kSIGMOID;
+      }
+    } else if (op == "Reshape" || op == "Flatten") {
+      /* 数据按通道、行、列连续存放，展平不改变内存布局 */
+      flattened = true;
+    } else {
+      SPDLOG_ERROR("[TinyCnn] Unsupported op '{}'.", op);
+      return false;
+    }
+  }
+  if (layers.empty()) {
+    SPDLOG_ERROR("[TinyCnn] Model has no Conv layer.");
+    return false;
+  }
+
+  for (Layer &layer : layers) {
+    const int k = layer.in_c * layer.kernel_h * layer.kernel_w;
+    const int area = layer.out_h * layer.out_w;
+    if (layer.out_c * area > kMAX_ACTIVATION || area * k > kMAX_COLUMN) {
+      SPDLOG_ERROR("[TinyCnn] Layer is too large for the stack buffers.");
+      return false;
+    }
+
+    /* 每个输出通道按最大绝对值对称量化 */
+    layer.weight_q.resize(layer.weight.size());
+    layer.weight_scale.resize(layer.out_c);
+    for (int oc = 0; oc < layer.out_c; ++oc) {
+      const float max_abs = MaxAbs(layer.weight.data() + oc * k, k);
+      const float scale = max_abs > 0.f ? max_abs / 127.f : 1.f;
+      layer.weight_scale[oc] = scale;
+      Quantize(layer.weight.data() + oc * k, layer.weight_q.data() + oc * k, k,
+               scale);
+    }
+  }
+
+  layers_ = std::move(layers);
+  input_size_ = cv::Size(shape[3], shape[2]);
+  SPDLOG_INFO("[TinyCnn] Loaded {} layers from '{}'.", layers_.size(),
+              onnx_path);
+  return true;
+}
+
+bool TinyCnn::Loaded() const { return !layers_.empty(); }
+
+void TinyCnn::SetQuantized(bool quantized) { quantized_ = quantized; }
+bool TinyCnn::Quantized() const { return quantized_; }
+
+cv::Size TinyCnn::InputSize() const { return input_size_; }
+
+int TinyCnn::OutputSize() const {
+  if (layers_.empty()) return 0;
+  const Layer &layer = layers_.back();
+  return layer.out_c * layer.out_h * layer.out_w;
+}
+
+void TinyCnn::Conv(const Layer &layer, const float *src, float *dst,
+                   float *col, int8_t *col_q) const {
+  const int k = layer.in_c * layer.kernel_h * layer.kernel_w;
+  const int area = layer.out_h * layer.out_w;
+
+  /* 展开成 [输出位置][卷积核元素]，每个输出值都是一次连续的点积 */
+  float *col_ptr = col;
+  for (int oy = 0; oy < layer.out_h; ++oy)
+    for (int ox = 0; ox < layer.out_w; ++ox)
+      for (int c = 0; c < layer.in_c; ++c)
+        for (int ky = 0; ky < layer.kernel_h; ++ky) {
+          const int iy = oy * layer.stride_h - layer.pad_t + ky;
+          const float *row = iy >= 0 && iy < layer.in_h
+                                 ? src + (c * layer.in_h + iy) * layer.in_w
+                                 : nullptr;
+          for (int kx = 0; kx < layer.kernel_w; ++kx) {
+            const int ix = ox * layer.stride_w - layer.pad_l + kx;
+            *col_ptr++ = row && ix >= 0 && ix < layer.in_w ? row[ix] : 0.f;
+          }
+        }
+
+  if (quantized_) {
+    /* 激活值按层动态量化，整数点积后乘回两个量化系数 */
+    const float max_abs = MaxAbs(src, layer.in_c * layer.in_h * layer.in_w);
+    const float scale = max_abs > 0.f ? max_abs / 127.f : 1.f;
+    Quantize(col, col_q, area * k, scale);
+
+    for (int oc = 0; oc < layer.out_c; ++oc) {
+      const int8_t *weight = layer.weight_q.data() + oc * k;
+      const float s = scale * layer.weight_scale[oc];
+      for (int p = 0; p < area; ++p)
+        dst[oc * area + p] =
+            DotInt8(weight, col_q + p * k, k) * s + layer.bias[oc];
+    }
+  } else {
+    for (int oc = 0; oc < layer.out_c; ++oc) {
+      const float *weight = layer.weight.data() + oc * k;
+      for (int p = 0; p < area; ++p)
+        dst[oc * area + p] = Dot(weight, col + p * k, k) + layer.bias[oc];
+    }
+  }
+  Activate(dst, layer.out_c * area, layer.act, layer.alpha);
+}
+
+void TinyCnn::Forward(const float *input, float *output) const {
+  /* 每次调用使用各自的栈上缓冲区，多线程同时推理互不影响 */
+  float buffers[2][kMAX_ACTIVATION];
+  float col[kMAX_COLUMN];
+  int8_t col_q[kMAX_COLUMN];
+
+  const float *src = input;
+  for (std::size_t i = 0; i < layers_.size(); ++i) {
+    float *dst = i + 1 < layers_.size() ? buffers[i % 2] : output;
+    Conv(layers_[i], src, dst, col, col_q);
+    src = dst;
+  }
+}
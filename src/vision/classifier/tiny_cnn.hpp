@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "opencv2/opencv.hpp"
+
+/**
+ * @brief 装甲板分类网络的轻量推理
+ * 直接从 ONNX 文件读取权重，只支持分类器用到的卷积和激活层。
+ * 中间结果放在栈上的定长缓冲区，卷积展开成点积后用 SIMD 计算，
+ * 可选 int8 量化。Forward 不修改成员，可以在多个线程中同时调用
+ *
+ */
+class TinyCnn {
+ public:
+  enum class Activation {
+    kNONE,
+    kRELU,
+    kLEAKY_RELU,
+    kSIGMOID,
+  };
+
+ private:
+  struct Layer {
+    int in_c, in_h, in_w;
+    int out_c, out_h, out_w;
+    int kernel_h, kernel_w;
+    int stride_h, stride_w;
+    int pad_t, pad_l;
+    Activation act = Activation::kNONE;
+    float alpha = 0.f;
+
+    std::vector<float> weight; /* [out_c][in_c * kernel_h * kernel_w] */
+    std::vector<float> bias;
+    std::vector<int8_t> weight_q;    /* 按输出通道对称量化的权重 */
+    std::vector<float> weight_scale; /* 每个输出通道的量化系数 */
+  };
+
+  std::vector<Layer> layers_;
+  cv::Size input_size_;
+  bool quantized_ = false;
+
+  void Conv(const Layer &layer, const float *src, float *dst, float *col,
+            int8_t *col_q) const;
+
+ public:
+  TinyCnn();
+  explicit TinyCnn(const std::string &onnx_path);
+  ~TinyCnn();
+
+  /**
+   * @brief 读取模型，遇到不支持的算子时返回 false，可回退到 OpenCV DNN
+   *
+   * @param onnx_path 模型路径
+   * @return true 读取成功
+   * @return false 读取失败
+   */
+  bool LoadModel(const std::string &onnx_path);
+  bool Loaded() const;
+
+  /**
+   * @brief 启用后卷积用 int8 计算，激活值按层动态量化
+   *
+   * @param quantized 是否量化
+   */
+  void SetQuantized(bool quantized);
+  bool Quantized() const;
+
+  cv::Size InputSize() const;
+  int OutputSize() const;
+
+  /**
+   * @brief 前向推理
+   *
+   * @param input 单张图片的输入，按通道、行、列排列
+   * @param output 网络输出，长度为 OutputSize()
+   */
+  void Forward(const float *input, float *output) const;
+};
@@ -1,5 +1,7 @@
 #include "compensator.hpp"
 
+#include <limits>
+
 #include "opencv2/opencv.hpp"
 #include "spdlog/spdlog.h"
 
@@ -12,6 +14,34 @@ const double kSENTRY = 10.;
 const double kBIG_ARMOR = 230. / 127 * cos(15. / 180 * M_PI);
 const double kSMALL_ARMOR = 135. / 125 * cos(15. / 180 * M_PI);
 
+/**
+ * @brief 按能量机关装甲板模型的角点顺序重排图像角点
+ * 模型依次为左上、右上、右下、左下，第一条边是长边。
+ * 外接矩形的角点同样顺时针排列，只需把上方长边的起点换到最前
+ *
+ * @param vertices 顺时针排列的图像角点
+ * @return std::vector<cv::Point2f> 与模型对应的图像角点
+ */
+std::vector<cv::Point2f> BuffImageVertices(
+    const std::vector<cv::Point2f>& vertices) {
+  std::size_t start = 0;
+  double best = std::numeric_limits<double>::max();
+  for (std::size_t i = 0; i < 4; ++i) {
+    const cv::Point2f& a = vertices[i];
+    const cv::Point2f& b = vertices[(i + 1) % 4];
+    const cv::Point2f& c = vertices[(i + 2) % 4];
+    if (cv::norm(b - a) < cv::norm(c - b)) continue;
+    const double top = (a.y + b.y) / 2.;
+    if (top < best) {
+      best = top;
+      start = i;
+    }
+  }
+  std::vector<cv::Point2f> ordered(4);
+  for (std::size_t i = 0; i < 4; ++i) ordered[i] = vertices[(start + i) % 4];
+  return ordered;
+}
+
 }  // namespace
 
 void Compensator::VisualizePnp(Armor& armor, const cv::Mat& output,
@@ -70,6 +100,22 @@ void Compensator::LoadCameraMat(const std::string& path) {
 
 void Compensator::PnpEstimate(Armor& armor) {
   cv::Mat rot_vec, trans_vec;
+  if (armor.GetModel() == game::Model::kBUFF) {
+    /* 能量机关预测时已由转子平面模型给出位姿，没有时才单独解算 */
+    if (armor.GetTransVec().empty()) {
+      cv::solvePnP(armor.PhysicVertices(),
+                   BuffImageVertices(armor.ImageVertices()), cam_mat_,
+                   distor_coff_, rot_vec, trans_vec, false,
+                   cv::SOLVEPNP_ITERATIVE);
+    } else {
+      rot_vec = armor.GetRotVec().clone();
+      trans_vec = armor.GetTransVec().clone();
+    }
+    trans_vec.at<double>(1, 0) -= gun_cam_distance_;
+    armor.SetRotVec(rot_vec), armor.SetTransVec(trans_vec);
+    return;
+  }
+
   std::vector<cv::Point2f> trsd_cords(4);  // Points of 2D after update
   /*调整识别到的像素坐标,手动消除与处理带来的2D坐标
   不准的为问题,该参数可以根据ui_param灯条的变形情况
@@ -87,10 +133,6 @@ void Compensator::PnpEstimate(Armor& armor) {
   double k2;  // k2值是目标装甲板的长宽比
   if (armor.IsBigArmor()) {
     k2 = kBIG_ARMOR;
-  } else if (armor.GetModel() == game::Model::kBUFF) {
-    k2 = 1;  // TODO(GY.Wang): 等Buff和buff_detector完成后修改
-    SPDLOG_ERROR("Error param of buff has not been set!");
-    return;
   } else {
     k2 = kSMALL_ARMOR;
   }
@@ -190,6 +232,8 @@ void Compensator::Apply(Armor& armor, const double ballet_speed,
   CompensateGravity(armor, ballet_speed, method);
 }
 
+double Compensator::GetFlightTime() const { return flight_time_; }
+
 void Compensator::VisualizeResult(tbb::concurrent_vector<Armor>& armors,
                                   const cv::Mat& output, int verbose) {
   for (auto& armor : armors) {
@@ -242,6 +286,9 @@ void Compensator::CompensateGravity(Armor& armor, const double ballet_speed,
       aiming_eulr.pitch = angle;
       aiming_eulr.yaw += add_yaw;
     }
+    /* 水平距离除以出射速度的水平分量 */
+    if (ballet_speed > 0)
+      flight_time_ = x / (ballet_speed * cos(angle));
     armor.SetAimEuler(aiming_eulr);
     SPDLOG_DEBUG("Armor Euler is setted");
   }
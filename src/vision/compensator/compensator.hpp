@@ -7,6 +7,7 @@
 class Compensator {
  private:
   double distance_;
+  double flight_time_ = 0.; /* 最近一次补偿得到的弹丸飞行时间 */
   cv::Mat cam_mat_, distor_coff_;
   double gun_cam_distance_; /* 枪口到镜头的距离 */
   game::Arm arm_;
@@ -33,6 +34,13 @@ class Compensator {
   void Apply(Armor& armor, const double ballet_speed,
              const component::Euler& euler, game::AimMethod method);
 
+  /**
+   * @brief 最近一次 Apply 解算出的弹丸飞行时间，用于预测器的提前量
+   *
+   * @return double 飞行时间，单位秒
+   */
+  double GetFlightTime() const;
+
   void VisualizeResult(tbb::concurrent_vector<Armor>& armors,
                        const cv::Mat& output, int verbose = 1);
   void UpdateImgPoints(std::vector<cv::Point2f>& img, double k,
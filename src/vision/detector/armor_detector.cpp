@@ -60,38 +60,23 @@ bool ArmorDetector::PrepareParams(const std::string &params_path) {
   }
 }
 
-void ArmorDetector::FindLightBars(const cv::Mat &frame) {
+void ArmorDetector::FindLightBars(FrameContext &ctx) {
   duration_bars_.Start();
   lightbars_.clear();
   targets_.clear();
 
-  frame_size_ = frame.size();
+  frame_size_ = ctx.Frame().size();
   const double frame_area = frame_size_.area();
 
-  std::vector<cv::Mat> channels(3);
-  cv::Mat result;
-  cv::split(frame, channels);
-
   if (enemy_team_ == game::Team::kUNKNOWN) {
     SPDLOG_ERROR("enemy_team_ is {}", game::ToString(enemy_team_));
     return;
   }
 
-#if 0
-  if (enemy_team_ == game::Team::kBLUE) {
-    result = channels[0];
-  } else if (enemy_team_ == game::Team::kRED) {
-    result = channels[2];
-  }
-#else
-  if (enemy_team_ == game::Team::kBLUE) {
-    result = channels[0] - channels[2];
-  } else if (enemy_team_ == game::Team::kRED) {
-    result = channels[2] - channels[0];
-  }
-#endif
-
-  cv::threshold(result, result, params_.binary_th, 255., cv::THRESH_BINARY);
+  /* 差分图由上下文缓存，二值化结果另存，避免改写缓存 */
+  cv::Mat result;
+  cv::threshold(ctx.ColorDiff(enemy_team_), result, params_.binary_th, 255.,
+                cv::THRESH_BINARY);
   /*
     if (params_.se_erosion >= 0.) {
       cv::Mat kernel = cv::getStructuringElement(
@@ -229,9 +214,19 @@ void ArmorDetector::SetEnemyTeam(game::Team enemy_team) {
 
 const tbb::concurrent_vector<Armor> &ArmorDetector::Detect(
     const cv::Mat &frame) {
+  FrameContext ctx(frame);
+  return Detect(ctx);
+}
+
+const tbb::concurrent_vector<Armor> &ArmorDetector::Detect(FrameContext &ctx) {
   SPDLOG_DEBUG("Detecting");
-  FindLightBars(frame);
+  FindLightBars(ctx);
   MatchLightBars();
+
+  /* 输入为感兴趣区域时，把结果映射回整幅图像坐标 */
+  origin_ = ctx.Origin();
+  if (origin_ != cv::Point2f(0., 0.))
+    for (auto &armor : targets_) armor.Translate(origin_);
   SPDLOG_DEBUG("Detected.");
   return targets_;
 }
@@ -240,7 +235,9 @@ void ArmorDetector::VisualizeResult(const cv::Mat &output, int verbose) {
   auto draw_lightbar = [&](LightBar &bar) {
     bar.VisualizeObject(output, verbose > 2, draw::kGREEN, cv::MARKER_CROSS);
   };
-  auto draw_armor = [&](Armor &armor) {
+  auto draw_armor = [&](Armor armor) {
+    /* output 为检测时的输入图像，需要移回其坐标系 */
+    armor.Translate(-origin_);
     armor.VisualizeObject(output, verbose > 2);
   };
 
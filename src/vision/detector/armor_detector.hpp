@@ -9,6 +9,7 @@
 class ArmorDetector : public Detector<Armor, ArmorDetectorParam<double>> {
  private:
   game::Team enemy_team_;
+  cv::Point2f origin_;
   std::vector<std::vector<cv::Point>> contours_, contours_poly_;
   tbb::concurrent_vector<LightBar> lightbars_;
 
@@ -17,7 +18,7 @@ class ArmorDetector : public Detector<Armor, ArmorDetectorParam<double>> {
   void InitDefaultParams(const std::string &path);
   bool PrepareParams(const std::string &path);
 
-  void FindLightBars(const cv::Mat &frame);
+  void FindLightBars(FrameContext &ctx);
   void MatchLightBars();
 
  public:
@@ -28,5 +29,6 @@ class ArmorDetector : public Detector<Armor, ArmorDetectorParam<double>> {
   void SetEnemyTeam(game::Team enemy_team);
 
   const tbb::concurrent_vector<Armor> &Detect(const cv::Mat &frame);
+  const tbb::concurrent_vector<Armor> &Detect(FrameContext &ctx);
   void VisualizeResult(const cv::Mat &output, int verbose = 1);
 };
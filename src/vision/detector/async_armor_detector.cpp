@@ -3,10 +3,17 @@
 namespace {
 
 const int kMAX_VECTOR_SIZE = 80;
+const double kEMA_ALPHA = 0.1;
+const int kSCALE_PERIOD = 30;
 
+double Milliseconds(std::chrono::steady_clock::duration duration) {
+  return std::chrono::duration<double, std::milli>(duration).count();
 }
 
-ArmorDetectorAsync::ArmorDetectorAsync(const size_t thread_count) {
+}  // namespace
+
+ArmorDetectorAsync::ArmorDetectorAsync(const size_t thread_count)
+    : reorder_(kMAX_VECTOR_SIZE), active_count_(thread_count) {
   thread_count_ = thread_count;
 
   method_vec_.clear();
@@ -35,48 +42,118 @@ void ArmorDetectorAsync::SetEnemyTeam(game::Team enemy_team) {
   }
 }
 
+void ArmorDetectorAsync::SetLatencyTarget(double latency) {
+  std::lock_guard<std::mutex> lock(mutex_scale_);
+  latency_target_ = latency;
+}
+
+size_t ArmorDetectorAsync::ActiveCount() const { return active_count_; }
+
+void ArmorDetectorAsync::SetDebugView(DebugView *view) { view_ = view; }
+
+void ArmorDetectorAsync::Scale(double wait, double proc) {
+  std::lock_guard<std::mutex> lock(mutex_scale_);
+  wait_ema_ += kEMA_ALPHA * (wait - wait_ema_);
+  proc_ema_ += kEMA_ALPHA * (proc - proc_ema_);
+  if (++scale_count_ < kSCALE_PERIOD) return;
+  scale_count_ = 0;
+
+  const double latency = wait_ema_ + proc_ema_;
+  size_t active = active_count_;
+  if (latency > latency_target_) {
+    if (wait_ema_ > proc_ema_ / 2. && active < thread_count_) {
+      ++active; /* 帧在排队，增加线程 */
+    } else if (wait_ema_ <= proc_ema_ / 2. && active > 1) {
+      --active; /* 处理本身变慢，线程在争抢CPU，减少线程 */
+    }
+  } else if (latency < latency_target_ / 2. && active > 1) {
+    --active; /* 延迟很低，释放多余线程 */
+  }
+
+  if (active != active_count_) {
+    SPDLOG_INFO("Latency {:.1f}ms, active threads {} -> {}", latency,
+                active_count_.load(), active);
+    active_count_ = active;
+  }
+}
+
 void ArmorDetectorAsync::Work(const size_t i) {
-  while (true) {
-    if (!thread_continue) return;
+  while (thread_continue) {
+    /* 超出活跃数量的线程暂时休眠 */
+    if (i >= active_count_) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      continue;
+    }
 
-    source_signal_.Take();
+    if (!source_signal_.Take(100)) continue;
     mutex_source_.lock();
-    cv::Mat frame = source_.front();
+    if (source_.empty()) {
+      mutex_source_.unlock();
+      continue;
+    }
+    AsyncFrame item = source_.front();
     source_.pop_front();
-    mutex_source_.unlock();
 
-    auto result = method_vec_[i]->Detect(frame);
-
-    method_vec_[i]->VisualizeResult(frame, 5);
-    cv::imshow(std::to_string(i), frame);
-    cv::waitKey(1);
-
-    if (result.size() == 0) continue;
+    /* 更旧的帧已经过时，不再处理 */
+    for (const auto &stale : source_) reorder_.Cancel(stale.seq);
+    source_.clear();
+    mutex_source_.unlock();
 
-    mutex_result_.lock();
-    result_.emplace_back(result);
-    if (result_.size() > kMAX_VECTOR_SIZE) {
-      result_.pop_front();
+    const auto start = std::chrono::steady_clock::now();
+    FrameContext ctx(item.frame, item.origin);
+    auto result = method_vec_[i]->Detect(ctx);
+    const auto end = std::chrono::steady_clock::now();
+    Scale(Milliseconds(start - item.stamp), Milliseconds(end - start));
+
+    if (view_ != nullptr && view_->Active()) {
+      draw::DrawList list;
+      for (auto armor : result) {
+        armor.Translate(-item.origin);
+        list.AddObject(armor);
+      }
+      list.AddLabel(cv::format("Thread %ld: %ld armors in %.1f ms.", i,
+                               result.size(), Milliseconds(end - start)));
+      view_->Publish(item.frame, std::move(list));
     }
-    mutex_result_.unlock();
+
+    if (result.size() == 0)
+      reorder_.Cancel(item.seq);
+    else
+      reorder_.Complete(item.seq,
+                        AsyncResult{result, item.frame, item.origin});
   }
 }
 
-void ArmorDetectorAsync::PutFrame(const cv::Mat &frame) {
-  mutex_source_.lock();
-  source_.emplace_front(frame);
+void ArmorDetectorAsync::PutFrame(const cv::Mat &frame,
+                                  const cv::Point2f &origin) {
+  std::lock_guard<std::mutex> lock(mutex_source_);
+  source_.emplace_front(AsyncFrame{reorder_.Begin(), frame, origin,
+                                   std::chrono::steady_clock::now()});
   if (source_.size() > kMAX_VECTOR_SIZE) {
+    reorder_.Cancel(source_.back().seq);
     source_.pop_back();
   } else {
     source_signal_.Give();
   }
-  mutex_source_.unlock();
 }
 
 bool ArmorDetectorAsync::GetResult(tbb::concurrent_vector<Armor> &armors) {
-  std::lock_guard<std::mutex> lock(mutex_result_);
-  if (result_.size() == 0) return false;
-  armors = result_.front();
-  result_.pop_front();
+  cv::Mat frame;
+  return GetResult(armors, frame);
+}
+
+bool ArmorDetectorAsync::GetResult(tbb::concurrent_vector<Armor> &armors,
+                                   cv::Mat &frame) {
+  cv::Point2f origin;
+  return GetResult(armors, frame, origin);
+}
+
+bool ArmorDetectorAsync::GetResult(tbb::concurrent_vector<Armor> &armors,
+                                   cv::Mat &frame, cv::Point2f &origin) {
+  AsyncResult result;
+  if (!reorder_.Pop(result)) return false;
+  armors = std::move(result.armors);
+  frame = result.frame;
+  origin = result.origin;
   return true;
 }
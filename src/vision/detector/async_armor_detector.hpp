@@ -1,18 +1,52 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <mutex>
 #include <thread>
 
 #include "armor.hpp"
 #include "armor_detector.hpp"
 #include "async.hpp"
+#include "debug_view.hpp"
+#include "reorder_buffer.hpp"
 #include "semaphore.hpp"
 
+struct AsyncFrame {
+  uint64_t seq;
+  cv::Mat frame;
+  cv::Point2f origin; /* 感兴趣区域左上角在整幅图像中的坐标 */
+  std::chrono::steady_clock::time_point stamp;
+};
+
+struct AsyncResult {
+  tbb::concurrent_vector<Armor> armors;
+  cv::Mat frame; /* 检测所用的帧，后续提取图案必须用同一帧 */
+  cv::Point2f origin;
+};
+
 class ArmorDetectorAsync
-    : public Async<cv::Mat, tbb::concurrent_vector<Armor>, ArmorDetector> {
+    : public Async<AsyncFrame, tbb::concurrent_vector<Armor>, ArmorDetector> {
  private:
+  component::ReorderBuffer<AsyncResult> reorder_;
+  DebugView *view_ = nullptr;
+
+  std::atomic<size_t> active_count_;
+  std::mutex mutex_scale_;
+  double latency_target_ = 30.;
+  double wait_ema_ = 0., proc_ema_ = 0.;
+  int scale_count_ = 0;
+
   void Work(const size_t i);
 
+  /**
+   * @brief 根据排队和处理耗时调整活跃线程数
+   *
+   * @param wait 排队耗时，单位毫秒
+   * @param proc 处理耗时，单位毫秒
+   */
+  void Scale(double wait, double proc);
+
  public:
   explicit ArmorDetectorAsync(const size_t thread_count);
 
@@ -22,6 +56,22 @@ class ArmorDetectorAsync
 
   void SetEnemyTeam(game::Team enemy_team);
 
+  /**
+   * @brief 设置端到端延迟目标，活跃线程数据此自动调整
+   *
+   * @param latency 延迟目标，单位毫秒
+   */
+  void SetLatencyTarget(double latency);
+
+  size_t ActiveCount() const;
+
+  /**
+   * @brief 设置调试画面输出，为空时不输出
+   *
+   * @param view 调试画面服务
+   */
+  void SetDebugView(DebugView *view);
+
   // void Start();
 
   // void Stop();
@@ -30,13 +80,27 @@ class ArmorDetectorAsync
    * @brief 上传图片数据
    *
    * @param frame 图片
+   * @param origin 图片为感兴趣区域时其左上角在整幅图像中的坐标，
+   * 检测结果会换算到整幅图像坐标系
    */
-  void PutFrame(const cv::Mat &frame);
+  void PutFrame(const cv::Mat &frame,
+                const cv::Point2f &origin = cv::Point2f(0., 0.));
 
   /**
-   * @brief Get the Result object 下载结果
+   * @brief Get the Result object 下载结果，按帧的先后顺序输出
    *
    * @return tbb::concurrent_vector<Armor> armors
    */
   bool GetResult(tbb::concurrent_vector<Armor> &);
+
+  /**
+   * @brief 下载结果及其对应的帧，按帧的先后顺序输出
+   *
+   * @param armors 装甲板
+   * @param frame 检测这些装甲板所用的帧
+   * @return true 有新结果
+   */
+  bool GetResult(tbb::concurrent_vector<Armor> &armors, cv::Mat &frame);
+  bool GetResult(tbb::concurrent_vector<Armor> &armors, cv::Mat &frame,
+                 cv::Point2f &origin);
 };
@@ -2,9 +2,37 @@
 
 #include <cmath>
 #include <execution>
+#include <numeric>
 
 #include "spdlog/spdlog.h"
 
+namespace {
+
+const int kANGLE_BINS = 360;          /* 极坐标图的角度分辨率 */
+const double kBAND_RATIO = 0.2;       /* 环带半宽相对于半径的比例 */
+const int kRADIUS_STEP = 2;           /* 映射表按半径缓存的量化步长 */
+const std::size_t kPOLAR_CACHE = 32;  /* 缓存映射表的最大数量 */
+const double kFILL_RATIO = 0.1;       /* 角度上亮点占环带宽度的比例下限 */
+const int kMIN_RUN = 3;               /* 一片扇叶至少占据的角度数 */
+const double kANGLE_GATE = 0.3;       /* 帧间目标角度变化的上限，单位弧度 */
+const int kFULL_INTERVAL = 60;        /* 跟踪多少帧后强制全图搜索一次 */
+
+double AngleOf(const cv::Point2f &point, const cv::Point2f &center) {
+  return std::atan2(point.y - center.y, point.x - center.x);
+}
+
+cv::RotatedRect RotateRect(const cv::RotatedRect &rect,
+                           const cv::Point2f &center, double delta) {
+  const cv::Point2f offset = rect.center - center;
+  const float c = std::cos(delta), s = std::sin(delta);
+  return cv::RotatedRect(
+      center + cv::Point2f(c * offset.x - s * offset.y,
+                           s * offset.x + c * offset.y),
+      rect.size, rect.angle + delta * 180. / CV_PI);
+}
+
+}  // namespace
+
 void BuffDetector::InitDefaultParams(const std::string &params_path) {
   cv::FileStorage fs(params_path,
                      cv::FileStorage::WRITE | cv::FileStorage::FORMAT_JSON);
@@ -63,32 +91,80 @@ bool BuffDetector::PrepareParams(const std::string &params_path) {
   }
 }
 
-void BuffDetector::MatchBuff(const cv::Mat &frame) {
+void BuffDetector::CalcFeatures() {
+  features_.resize(contours_.size());
+  order_.resize(contours_.size());
+  std::iota(order_.begin(), order_.end(), 0);
+
+  /* 每个轮廓写入各自的位置，并行计算结果与执行顺序无关 */
+  auto calc_feature = [&](int i) {
+    const auto &contour = contours_[i];
+    auto &feature = features_[i];
+    feature.parent = hierarchy_[i][3];
+    feature.contour_area = cv::contourArea(contour) + 1;
+    feature.valid =
+        contour.size() >= static_cast<std::size_t>(params_.contour_size_low_th);
+    if (!feature.valid) return;
+
+    feature.rect = cv::minAreaRect(contour);
+    feature.rect_area = feature.rect.size.area() + 1;
+    feature.rect_ratio = feature.rect.size.aspectRatio();
+  };
+  std::for_each(std::execution::par_unseq, order_.begin(), order_.end(),
+                calc_feature);
+
+  std::sort(order_.begin(), order_.end(), [&](int i, int j) {
+    return features_[i].contour_area < features_[j].contour_area;
+  });
+}
+
+int BuffDetector::FindCenter() {
+  /* R标是独立的轮廓，候选中优先取没有父轮廓的，其次取面积最大的 */
+  int center = -1;
+  for (int i : order_) {
+    const auto &f = features_[i];
+    if (!f.valid) continue;
+    if (f.contour_area <= params_.contour_center_area_low_th) continue;
+    if (f.contour_area >= params_.contour_center_area_high_th) continue;
+    if (f.rect_ratio >= params_.rect_center_ratio_high_th) continue;
+    if (f.rect_ratio <= params_.rect_center_ratio_low_th) continue;
+
+    if (center < 0 || f.parent < 0 || features_[center].parent >= 0)
+      center = i;
+  }
+  return center;
+}
+
+int BuffDetector::FindHammer(int center, double center_rect_area) {
+  /* 筛选锤子 : [max(1.2 * 轮廓, 10 * R标)]  <  [锤子]  <  [60 * R标] */
+  int hammer = -1;
+  for (int i : order_) {
+    const auto &f = features_[i];
+    if (!f.valid || i == center) continue;
+    if (f.rect_area <= 1.2 * f.contour_area) continue;
+    if (f.rect_area <= 10 * center_rect_area) continue;
+    if (f.rect_area >= 60 * center_rect_area) continue;
+    hammer = i;
+  }
+  return hammer;
+}
+
+void BuffDetector::MatchBuff(FrameContext &ctx) {
   duration_armors_.Start();
-  float center_rect_area = params_.contour_center_area_low_th * 1.5;
   tbb::concurrent_vector<Armor> armors;
   hammer_ = cv::RotatedRect();
 
   frame_size_ = cv::Size(kIMAGE_WIDTH, kIMAGE_HEIGHT);
 
-  cv::Mat channels[3], img;
-  cv::split(frame, channels);
-
-#if 1
-  if (team_ == game::Team::kBLUE) {
-    img = channels[0] - channels[2];
-  } else if (team_ == game::Team::kRED) {
-    img = channels[2] - channels[0];
-  }
-#else
-  if (team_ == game::Team::kBLUE) {
-    result = channels[0];
-  } else if (team_ == game::Team::kRED) {
-    result = channels[2];
+  if (team_ == game::Team::kUNKNOWN) {
+    SPDLOG_ERROR("team_ is {}", game::ToString(team_));
+    return;
   }
-#endif
 
-  cv::threshold(img, img, params_.binary_th, 255., cv::THRESH_BINARY);
+  /* 差分图由上下文缓存，二值化结果另存，避免改写缓存 */
+  cv::Mat img;
+  cv::threshold(ctx.ColorDiff(team_), img, params_.binary_th, 255.,
+                cv::THRESH_BINARY);
 
   /*
     cv::Mat kernel = cv::getStructuringElement(
@@ -100,7 +176,8 @@ void BuffDetector::MatchBuff(const cv::Mat &frame) {
     cv::morphologyEx(img, img, cv::MORPH_CLOSE, kernel);
   */
 
-  cv::findContours(img, contours_, cv::RETR_TREE, cv::CHAIN_APPROX_NONE);
+  cv::findContours(img, contours_, hierarchy_, cv::RETR_TREE,
+                   cv::CHAIN_APPROX_NONE);
 
 #if 0
   contours_poly_.resize(contours_.size());
@@ -112,88 +189,87 @@ void BuffDetector::MatchBuff(const cv::Mat &frame) {
 
   SPDLOG_DEBUG("Found contours: {}", contours_.size());
 
-  auto check_armor = [&](const auto &contour) {
-    if (contour.size() < static_cast<std::size_t>(params_.contour_size_low_th))
-      return;
-
-    cv::RotatedRect rect = cv::minAreaRect(contour);
-    double rect_area = rect.size.area() + 1;
-    SPDLOG_WARN("[rect_area] is {}", rect_area);
-    double rect_ratio = rect.size.aspectRatio();
-
-    double contour_area = cv::contourArea(contour) + 1;
-    SPDLOG_DEBUG("[contour_area] is {}", contour_area);
-
-    if (contour_area > params_.contour_center_area_low_th &&
-        contour_area < params_.contour_center_area_high_th) {
-      if (rect_ratio < params_.rect_center_ratio_high_th &&
-          rect_ratio > params_.rect_center_ratio_low_th) {
-        buff_.SetCenter(rect.center);
-        center_rect_area = rect_area;
-        SPDLOG_WARN("center's area is {}", rect_area);
-        return;
-      }
-    }
+  CalcFeatures();
 
-    /* 筛选锤子 : [max(1.2 * 轮廓, 20 * R标)]  <  [锤子]  <  [80 * R标] */
-    if (rect_area > 1.2 * contour_area && rect_area > 10 * center_rect_area &&
-        rect_area < 60 * center_rect_area) {
-      hammer_ = rect;
-      SPDLOG_WARN("hammer_contour's area is {}", contour_area);
-      return;
-    }
+  /* 依次确定R标、锤子和装甲板，后一步使用前一步的最终结果 */
+  const int center = FindCenter();
+  double center_rect_area = params_.contour_center_area_low_th * 1.5;
+  if (center >= 0) {
+    buff_.SetCenter(features_[center].rect.center);
+    center_rect_area = features_[center].rect_area;
+    SPDLOG_DEBUG("center's area is {}", center_rect_area);
+  }
+
+  const int hammer = FindHammer(center, center_rect_area);
+  if (hammer >= 0) {
+    hammer_ = features_[hammer].rect;
+    SPDLOG_DEBUG("hammer_contour's area is {}",
+                 features_[hammer].contour_area);
+  }
+
+  /* 从大到小检查，已接受装甲板的子轮廓不再重复检查 */
+  std::vector<bool> accepted(contours_.size(), false);
+  int target = -1;
+  for (auto it = order_.rbegin(); it != order_.rend(); ++it) {
+    const int i = *it;
+    const auto &f = features_[i];
+    if (!f.valid || i == center || i == hammer) continue;
+    if (f.parent >= 0 && accepted[f.parent]) continue;
 
     /* 将宝剑在矩形列表中清除 */
     if (0 < hammer_.size.area()) {
-      if (contour_area > 1.2 * hammer_.size.area()) return;
-      if (rect_area > 0.7 * hammer_.size.area()) return;
+      if (f.contour_area > 1.2 * hammer_.size.area()) continue;
+      if (f.rect_area > 0.7 * hammer_.size.area()) continue;
     }
 
-    SPDLOG_DEBUG("rect_ratio is {}", rect_ratio);
-    if (rect_ratio < params_.rect_ratio_low_th) return;
-    if (rect_ratio > params_.rect_ratio_high_th) return;
+    if (f.rect_ratio < params_.rect_ratio_low_th) continue;
+    if (f.rect_ratio > params_.rect_ratio_high_th) continue;
 
-    SPDLOG_DEBUG("rect_area is {}, center_rect_area {}", rect_area,
-                 center_rect_area);
-    if (rect_area < 1 * center_rect_area) return;
-    if (rect_area > 30 * center_rect_area) return;
+    if (f.rect_area < 1 * center_rect_area) continue;
+    if (f.rect_area > 30 * center_rect_area) continue;
 
-    SPDLOG_DEBUG("contour_area is {}, rect_area {}", contour_area, rect_area);
-    if (contour_area > rect_area * 1.6) return;
-    if (contour_area < rect_area * 0.5) return;
+    if (f.contour_area > f.rect_area * 1.6) continue;
+    if (f.contour_area < f.rect_area * 0.5) continue;
 
-    SPDLOG_DEBUG("armor's area is {}", rect_area);
-    Armor armor = Armor(rect);
-    armor.SetModel(game::Model::kBUFF);
-    armors.emplace_back(armor);
-  };
+    SPDLOG_DEBUG("armor's area is {}", f.rect_area);
+    accepted[i] = true;
 
-  std::sort(
-      contours_.begin(), contours_.end(),
-      [](std::vector<cv::Point> contour1, std::vector<cv::Point> contour2) {
-        return cv::contourArea(contour1) < cv::contourArea(contour2);
-      });
+    /* 待击打装甲板位于锤子末端，是锤子轮廓内部的子轮廓 */
+    if (hammer >= 0 && f.parent == hammer) target = armors.size();
 
-  std::for_each(std::execution::par_unseq, contours_.begin(), contours_.end(),
-                check_armor);
+    Armor armor = Armor(f.rect);
+    armor.SetModel(game::Model::kBUFF);
+    armors.emplace_back(armor);
+  }
 
   duration_armors_.Calc("Find Armors");
 
-  SPDLOG_WARN("armors.size is {}", armors.size());
+  SPDLOG_DEBUG("armors.size is {}", armors.size());
   SPDLOG_DEBUG("the buff's hammer area is {}", hammer_.size.area());
 
   duration_buff_.Start();
   if (armors.size() > 0 && hammer_.size.area() > 0) {
-    buff_.SetTarget(armors[0]);
-    if (armors.size() > 1)
-      for (auto armor : armors)
-        if (cv::norm(hammer_.center - armor.ImageCenter()) <
-            cv::norm(hammer_.center - buff_.GetTarget().ImageCenter()))
-          buff_.SetTarget(armor);
+    if (target < 0) {
+      /* 层级关系不可用时退回到离锤子最近的装甲板 */
+      target = 0;
+      for (std::size_t i = 1; i < armors.size(); ++i)
+        if (cv::norm(hammer_.center - armors[i].ImageCenter()) <
+            cv::norm(hammer_.center - armors[target].ImageCenter()))
+          target = i;
+    }
+    buff_.SetTarget(armors[target]);
     buff_.SetArmors(armors);
-
-    SPDLOG_WARN("Find Target Buff Armor");
-    targets_.emplace_back(buff_);
+    SPDLOG_DEBUG("Find Target Buff Armor");
+
+    if (center >= 0) {
+      center_ = features_[center].rect.center;
+      center_rect_ = features_[center].rect;
+      target_ = armors[target].GetRect();
+      std::vector<double> angles;
+      tracking_ = FindBlades(ctx, angles);
+      blades_ = angles.size();
+      polar_frames_ = 0;
+    }
   } else {
     SPDLOG_WARN("can't find buff_armor");
   }
@@ -201,6 +277,163 @@ void BuffDetector::MatchBuff(const cv::Mat &frame) {
   duration_buff_.Calc("Find Buff");
 }
 
+const BuffDetector::PolarMap &BuffDetector::GetPolarMap(int radius) {
+  auto it = polar_maps_.find(radius);
+  if (it != polar_maps_.end()) return it->second;
+  if (polar_maps_.size() >= kPOLAR_CACHE) polar_maps_.clear();
+
+  /* 行为角度，列为半径，源图是以R标为中心、边长 2 * r_out + 1 的区域 */
+  PolarMap &map = polar_maps_[radius];
+  map.r_in = std::max(1, cvFloor(radius * (1. - kBAND_RATIO)));
+  map.r_out = cvCeil(radius * (1. + kBAND_RATIO));
+  cv::Mat map_x(kANGLE_BINS, map.r_out - map.r_in, CV_32FC1);
+  cv::Mat map_y(map_x.size(), CV_32FC1);
+  for (int i = 0; i < map_x.rows; ++i) {
+    const double theta = 2. * CV_PI * i / kANGLE_BINS;
+    const double c = std::cos(theta), s = std::sin(theta);
+    auto x = map_x.ptr<float>(i), y = map_y.ptr<float>(i);
+    for (int j = 0; j < map_x.cols; ++j) {
+      x[j] = map.r_out + (map.r_in + j) * c;
+      y[j] = map.r_out + (map.r_in + j) * s;
+    }
+  }
+  cv::convertMaps(map_x, map_y, map.map1, map.map2, CV_16SC2);
+  SPDLOG_DEBUG("Cached polar map for radius {}", radius);
+  return map;
+}
+
+bool BuffDetector::TrackCenter(FrameContext &ctx) {
+  /* R标只会小幅移动，只在上一帧位置附近的小窗口内计算差分并重新定位 */
+  const int half = cvCeil(
+      2 * std::max(center_rect_.size.width, center_rect_.size.height));
+  cv::Rect roi(cvRound(center_.x) - half, cvRound(center_.y) - half,
+               2 * half + 1, 2 * half + 1);
+  roi &= cv::Rect(cv::Point(0, 0), ctx.Frame().size());
+  if (roi.empty()) return false;
+
+  cv::Mat img;
+  cv::threshold(ctx.ColorDiff(team_, roi), img, params_.binary_th, 255.,
+                cv::THRESH_BINARY);
+  std::vector<std::vector<cv::Point>> contours;
+  cv::findContours(img, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE,
+                   roi.tl());
+
+  int best = -1;
+  cv::RotatedRect best_rect;
+  for (std::size_t i = 0; i < contours.size(); ++i) {
+    const double area = cv::contourArea(contours[i]) + 1;
+    if (area <= params_.contour_center_area_low_th) continue;
+    if (area >= params_.contour_center_area_high_th) continue;
+
+    const cv::RotatedRect rect = cv::minAreaRect(contours[i]);
+    const double ratio = rect.size.aspectRatio();
+    if (ratio >= params_.rect_center_ratio_high_th) continue;
+    if (ratio <= params_.rect_center_ratio_low_th) continue;
+
+    if (best < 0 || cv::norm(rect.center - center_) <
+                        cv::norm(best_rect.center - center_)) {
+      best = i;
+      best_rect = rect;
+    }
+  }
+  if (best < 0) return false;
+
+  const cv::Point2f shift = best_rect.center - center_;
+  center_ = best_rect.center;
+  center_rect_ = best_rect;
+  target_.center += shift;
+  hammer_.center += shift;
+  return true;
+}
+
+bool BuffDetector::FindBlades(FrameContext &ctx,
+                              std::vector<double> &angles) {
+  angles.clear();
+  const int radius =
+      cvRound(cv::norm(target_.center - center_) / kRADIUS_STEP) *
+      kRADIUS_STEP;
+  if (radius <= 0) return false;
+
+  const PolarMap &map = GetPolarMap(radius);
+  const cv::Rect roi(cvRound(center_.x) - map.r_out,
+                     cvRound(center_.y) - map.r_out, 2 * map.r_out + 1,
+                     2 * map.r_out + 1);
+  /* 环带超出画面时展开结果不完整 */
+  if ((roi & cv::Rect(cv::Point(0, 0), ctx.Frame().size())) != roi)
+    return false;
+
+  cv::Mat polar, profile;
+  cv::remap(ctx.ColorDiff(team_, roi), polar, map.map1, map.map2,
+            cv::INTER_LINEAR);
+  cv::threshold(polar, polar, params_.binary_th, 1., cv::THRESH_BINARY);
+  cv::reduce(polar, profile, 1, cv::REDUCE_SUM, CV_32S);
+
+  /* 环带上每片亮着的扇叶对应角度剖面上一段连续区间 */
+  const int fill = std::max(1, cvCeil(kFILL_RATIO * polar.cols));
+  auto lit = [&](int i) { return profile.at<int>(i % kANGLE_BINS) >= fill; };
+  int start = 0;
+  while (start < kANGLE_BINS && lit(start)) ++start;
+  if (start == kANGLE_BINS) return false;
+
+  for (int i = start; i < start + kANGLE_BINS; ++i) {
+    if (!lit(i)) continue;
+    int end = i;
+    while (end + 1 < start + kANGLE_BINS && lit(end + 1)) ++end;
+    if (end - i + 1 >= kMIN_RUN)
+      angles.emplace_back(std::remainder(
+          2. * CV_PI * (i + end) / 2. / kANGLE_BINS, 2. * CV_PI));
+    i = end;
+  }
+  return !angles.empty();
+}
+
+bool BuffDetector::MatchPolar(FrameContext &ctx) {
+  if (++polar_frames_ > kFULL_INTERVAL) return false;
+
+  duration_armors_.Start();
+  if (!TrackCenter(ctx)) {
+    SPDLOG_DEBUG("Lost buff center.");
+    return false;
+  }
+
+  std::vector<double> angles;
+  if (!FindBlades(ctx, angles)) return false;
+  /* 亮起的扇叶数变化说明击中后切换了目标，需要全图重新确认 */
+  if (angles.size() != blades_) {
+    SPDLOG_DEBUG("Blades changed from {} to {}.", blades_, angles.size());
+    return false;
+  }
+
+  const double last = AngleOf(target_.center, center_);
+  std::size_t target = 0;
+  for (std::size_t i = 1; i < angles.size(); ++i)
+    if (std::abs(std::remainder(angles[i] - last, 2. * CV_PI)) <
+        std::abs(std::remainder(angles[target] - last, 2. * CV_PI)))
+      target = i;
+  const double delta = std::remainder(angles[target] - last, 2. * CV_PI);
+  if (std::abs(delta) > kANGLE_GATE) return false;
+
+  /* 各扇叶装甲板由上一帧的目标绕R标旋转得到 */
+  tbb::concurrent_vector<Armor> armors;
+  for (double angle : angles) {
+    Armor armor(RotateRect(target_, center_,
+                           std::remainder(angle - last, 2. * CV_PI)));
+    armor.SetModel(game::Model::kBUFF);
+    armors.emplace_back(armor);
+  }
+  target_ = armors[target].GetRect();
+  hammer_ = RotateRect(hammer_, center_, delta);
+  contours_.clear();
+  duration_armors_.Calc("Polar Armors");
+
+  duration_buff_.Start();
+  buff_.SetCenter(center_);
+  buff_.SetTarget(armors[target]);
+  buff_.SetArmors(armors);
+  duration_buff_.Calc("Polar Buff");
+  return true;
+}
+
 void BuffDetector::VisualizeArmors(const cv::Mat &output, bool add_lable) {
   auto target_vertices = buff_.GetTarget().ImageVertices();
   auto draw_armor = [&](Armor &armor) {
@@ -229,6 +462,7 @@ BuffDetector::BuffDetector(const std::string &params_path,
 BuffDetector::~BuffDetector() { SPDLOG_TRACE("Destructed."); }
 
 void BuffDetector::SetTeam(game::Team enemy_team) {
+  tracking_ = false;
   if (enemy_team == game::Team::kRED)
     team_ = game::Team::kBLUE;
   else if (enemy_team == game::Team::kBLUE)
@@ -238,10 +472,18 @@ void BuffDetector::SetTeam(game::Team enemy_team) {
 }
 
 const tbb::concurrent_vector<Buff> &BuffDetector::Detect(const cv::Mat &frame) {
+  FrameContext ctx(frame);
+  return Detect(ctx);
+}
+
+const tbb::concurrent_vector<Buff> &BuffDetector::Detect(FrameContext &ctx) {
   targets_.clear();
   buff_ = Buff();
   SPDLOG_DEBUG("Detecting");
-  MatchBuff(frame);
+  if (!tracking_ || !MatchPolar(ctx)) {
+    tracking_ = false;
+    MatchBuff(ctx);
+  }
   SPDLOG_DEBUG("Detected.");
   if (buff_.GetTarget().GetRect().center.x != 0) targets_.emplace_back(buff_);
   return targets_;
@@ -1,24 +1,68 @@
 #pragma once
 
+#include <map>
+#include <vector>
+
 #include "armor_detector.hpp"
 #include "buff.hpp"
 #include "buff_param.hpp"
 #include "detector.hpp"
 #include "opencv2/opencv.hpp"
 
+/**
+ * @brief 单个轮廓的几何特征，每帧只计算一次
+ *
+ */
+struct ContourFeature {
+  cv::RotatedRect rect;
+  double contour_area;
+  double rect_area;
+  double rect_ratio;
+  int parent;
+  bool valid;
+};
+
 class BuffDetector : public Detector<Buff, BuffDetectorParam<double>> {
  private:
+  /**
+   * @brief 以R标为原点展开环带的映射表，只与半径有关
+   *
+   */
+  struct PolarMap {
+    cv::Mat map1, map2;
+    int r_in, r_out;
+  };
+
   Buff buff_;
   std::vector<std::vector<cv::Point>> contours_, contours_poly_;
+  std::vector<cv::Vec4i> hierarchy_;
+  std::vector<ContourFeature> features_;
+  std::vector<int> order_; /* 按轮廓面积从小到大排列的下标 */
   cv::RotatedRect hammer_;
   game::Team team_ = game::Team::kUNKNOWN;
 
+  /* 找到R标后在其周围的环带中跟踪，丢失时才回到全图搜索 */
+  bool tracking_ = false;
+  int polar_frames_ = 0;
+  std::size_t blades_ = 0;
+  cv::Point2f center_;
+  cv::RotatedRect center_rect_, target_;
+  std::map<int, PolarMap> polar_maps_;
+
   component::Timer duration_armors_, duration_buff_;
 
   void InitDefaultParams(const std::string &path);
   bool PrepareParams(const std::string &path);
 
-  void MatchBuff(const cv::Mat &frame);
+  void CalcFeatures();
+  int FindCenter();
+  int FindHammer(int center, double center_rect_area);
+  void MatchBuff(FrameContext &ctx);
+
+  const PolarMap &GetPolarMap(int radius);
+  bool TrackCenter(FrameContext &ctx);
+  bool FindBlades(FrameContext &ctx, std::vector<double> &angles);
+  bool MatchPolar(FrameContext &ctx);
 
   void VisualizeArmors(const cv::Mat &output, bool add_lable);
 
@@ -30,5 +74,6 @@ class BuffDetector : public Detector<Buff, BuffDetectorParam<double>> {
   void SetTeam(game::Team enemy_team);
 
   const tbb::concurrent_vector<Buff> &Detect(const cv::Mat &frame);
+  const tbb::concurrent_vector<Buff> &Detect(FrameContext &ctx);
   void VisualizeResult(const cv::Mat &frame, int verbose);
 };
@@ -0,0 +1,75 @@
+#include "cpu_engine.hpp"
+
+#include <cstdint>
+
+#include "onnx_reader.hpp"
+#include "spdlog/spdlog.h"
+
+bool CpuEngine::Forward(const cv::Mat &blob, std::vector<float> &output) {
+  if (net_.empty()) {
+    SPDLOG_ERROR("[CpuEngine] Model has not been loaded.");
+    return false;
+  }
+
+  cv::Mat prob;
+  try {
+    net_.setInput(blob);
+    prob = net_.forward(output_names_.front());
+  } catch (const cv::Exception &e) {
+    /* 导出时未设置动态 batch 的模型只能逐张推理 */
+    SPDLOG_ERROR("[CpuEngine] {}", e.what());
+    return false;
+  }
+
+  /* 输出形状如 [B, N, 5 + nc] 或 [B, 3, H, W, 5 + nc]，最后一维是一个预测框 */
+  const int stride = prob.size[prob.dims - 1];
+  if (stride_ != stride) stride_ = stride;
+  const float *data = prob.ptr<float>();
+  output.assign(data, data + prob.total());
+  return true;
+}
+
+CpuEngine::CpuEngine(int threads) : threads_(threads) {
+  SPDLOG_TRACE("Constructed.");
+}
+
+CpuEngine::~CpuEngine() { SPDLOG_TRACE("Destructed."); }
+
+bool CpuEngine::Load(const std::string &onnx_file_path) {
+  try {
+    net_ = cv::dnn::readNetFromONNX(onnx_file_path);
+  } catch (const cv::Exception &e) {
+    SPDLOG_ERROR("[CpuEngine] {}", e.what());
+    return false;
+  }
+  if (net_.empty()) return false;
+
+  net_.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
+  net_.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+  /* OpenCV 的线程数是全局设置，会影响同进程内其他并行算法 */
+  if (threads_ > 0) cv::setNumThreads(threads_);
+  output_names_ = net_.getUnconnectedOutLayersNames();
+
+  /* 输入尺寸以模型为准，动态尺寸时保留默认值 */
+  const std::vector<int64_t> shape = onnx::InputShape(onnx_file_path);
+  if (shape.size() == 4 && shape[2] > 0 && shape[3] > 0)
+    input_size_ = cv::Size(static_cast<int>(shape[3]),
+                           static_cast<int>(shape[2]));
+  else
+    SPDLOG_WARN("[CpuEngine] Dynamic input shape, use {}x{}.",
+                input_size_.width, input_size_.height);
+
+  /* 导出时 batch 为 -1 的模型才能一次推理多张图像 */
+  if (!shape.empty() && shape[0] > 0 && max_batch_ > 1) {
+    SPDLOG_WARN("[CpuEngine] ONNX batch is fixed to {}, max batch -> 1.",
+                shape[0]);
+    max_batch_ = 1;
+  }
+
+  SPDLOG_DEBUG("[CpuEngine] Loaded '{}' with input {}x{}, {} threads.",
+               onnx_file_path, input_size_.width, input_size_.height,
+               cv::getNumThreads());
+  return true;
+}
+
+nn::Backend CpuEngine::GetBackend() const { return nn::Backend::kCPU; }
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "inference_engine.hpp"
+#include "opencv2/opencv.hpp"
+
+/**
+ * @brief 基于 OpenCV DNN 的 CPU 推理后端
+ * 用于没有 GPU 的开发机和 CI，INT8 模型需先用 ONNX 量化工具导出
+ *
+ */
+class CpuEngine : public InferenceEngine {
+ private:
+  cv::dnn::Net net_;
+  int threads_;
+  std::vector<std::string> output_names_;
+
+  bool Forward(const cv::Mat &blob, std::vector<float> &output) override;
+
+ public:
+  explicit CpuEngine(int threads = 0);
+  ~CpuEngine();
+
+  bool Load(const std::string &onnx_file_path) override;
+  nn::Backend GetBackend() const override;
+};
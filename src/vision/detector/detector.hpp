@@ -3,6 +3,7 @@
 #include <vector>
 
 #include "common.hpp"
+#include "frame_context.hpp"
 #include "opencv2/opencv.hpp"
 #include "spdlog/spdlog.h"
 #include "tbb/concurrent_vector.h"
@@ -30,5 +31,15 @@ class Detector {
 
   virtual const tbb::concurrent_vector<Target> &Detect(
       const cv::Mat &frame) = 0;
+
+  /**
+   * @brief 使用单帧上下文检测，派生图像可与同一帧的其他模块共享
+   *
+   * @param ctx 单帧上下文
+   * @return const tbb::concurrent_vector<Target>& 检测结果
+   */
+  virtual const tbb::concurrent_vector<Target> &Detect(FrameContext &ctx) {
+    return Detect(ctx.Frame());
+  }
   virtual void VisualizeResult(const cv::Mat &output, int verbose = 1) = 0;
 };
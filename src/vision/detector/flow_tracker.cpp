@@ -0,0 +1,156 @@
+#include "flow_tracker.hpp"
+
+#include "opencv2/video/tracking.hpp"
+#include "spdlog/spdlog.h"
+
+void FlowTracker::InitDefaultParams(const std::string &params_path) {
+  cv::FileStorage fs(params_path,
+                     cv::FileStorage::WRITE | cv::FileStorage::FORMAT_JSON);
+
+  fs << "redetect_interval" << 5;
+  fs << "win_size" << 21;
+  fs << "max_level" << 3;
+  fs << "fb_error_th" << 1.;
+  fs << "area_ratio_th" << 0.3;
+  SPDLOG_DEBUG("Inited params.");
+}
+
+bool FlowTracker::PrepareParams(const std::string &params_path) {
+  cv::FileStorage fs(params_path,
+                     cv::FileStorage::READ | cv::FileStorage::FORMAT_JSON);
+  if (fs.isOpened()) {
+    params_.redetect_interval = fs["redetect_interval"];
+    params_.win_size = fs["win_size"];
+    params_.max_level = fs["max_level"];
+    params_.fb_error_th = fs["fb_error_th"];
+    params_.area_ratio_th = fs["area_ratio_th"];
+    return true;
+  } else {
+    SPDLOG_ERROR("Can not load params.");
+    return false;
+  }
+}
+
+void FlowTracker::BuildPyramid(FrameContext &ctx,
+                               std::vector<cv::Mat> &pyramid) {
+  cv::buildOpticalFlowPyramid(ctx.Gray(), pyramid,
+                              cv::Size(params_.win_size, params_.win_size),
+                              params_.max_level);
+}
+
+bool FlowTracker::Track(FrameContext &ctx) {
+  std::vector<cv::Mat> pyramid;
+  BuildPyramid(ctx, pyramid);
+
+  /* 角点转换到各自帧的局部坐标，允许两帧的感兴趣区域不同 */
+  std::vector<cv::Point2f> prev_pts, next_pts, back_pts;
+  for (const auto &armor : targets_) {
+    for (const auto &vertex : armor.ImageVertices()) {
+      prev_pts.emplace_back(vertex - prev_origin_);
+      next_pts.emplace_back(vertex - ctx.Origin());
+    }
+  }
+
+  const cv::Size win(params_.win_size, params_.win_size);
+  std::vector<uchar> status, back_status;
+  std::vector<float> err;
+  cv::calcOpticalFlowPyrLK(prev_pyramid_, pyramid, prev_pts, next_pts, status,
+                           err, win, params_.max_level,
+                           cv::TermCriteria(), cv::OPTFLOW_USE_INITIAL_FLOW);
+
+  /* 反向跟踪回上一帧，误差大说明跟丢 */
+  back_pts = prev_pts;
+  cv::calcOpticalFlowPyrLK(pyramid, prev_pyramid_, next_pts, back_pts,
+                           back_status, err, win, params_.max_level,
+                           cv::TermCriteria(), cv::OPTFLOW_USE_INITIAL_FLOW);
+
+  tbb::concurrent_vector<Armor> tracked;
+  for (std::size_t i = 0; i < targets_.size(); ++i) {
+    std::vector<cv::Point2f> vertices(4);
+    for (std::size_t j = 0; j < 4; ++j) {
+      const std::size_t k = i * 4 + j;
+      if (!status[k] || !back_status[k]) return false;
+      if (cv::norm(back_pts[k] - prev_pts[k]) > params_.fb_error_th)
+        return false;
+      vertices[j] = next_pts[k] + ctx.Origin();
+    }
+
+    Armor armor(vertices);
+    const double area_ratio = armor.GetArea() / targets_[i].GetArea();
+    if (std::abs(area_ratio - 1.) > params_.area_ratio_th) return false;
+
+    armor.SetModel(targets_[i].GetModel());
+    armor.SetModelConf(targets_[i].GetModelConf());
+    tracked.emplace_back(armor);
+  }
+
+  targets_ = tracked;
+  prev_pyramid_.swap(pyramid);
+  return true;
+}
+
+FlowTracker::FlowTracker(ArmorDetector &detector) : detector_(detector) {
+  SPDLOG_TRACE("Constructed.");
+}
+
+FlowTracker::FlowTracker(ArmorDetector &detector,
+                         const std::string &params_path)
+    : detector_(detector) {
+  LoadParams(params_path);
+  SPDLOG_TRACE("Constructed.");
+}
+
+FlowTracker::~FlowTracker() { SPDLOG_TRACE("Destructed."); }
+
+void FlowTracker::Reset(FrameContext &ctx,
+                        const tbb::concurrent_vector<Armor> &armors) {
+  targets_ = armors;
+  frame_size_ = ctx.Frame().size();
+  prev_origin_ = ctx.Origin();
+  frames_since_detect_ = 0;
+  BuildPyramid(ctx, prev_pyramid_);
+}
+
+bool FlowTracker::Detected() const { return detected_; }
+
+const tbb::concurrent_vector<Armor> &FlowTracker::Detect(
+    const cv::Mat &frame) {
+  FrameContext ctx(frame);
+  return Detect(ctx);
+}
+
+const tbb::concurrent_vector<Armor> &FlowTracker::Detect(FrameContext &ctx) {
+  duration_track_.Start();
+
+  /* 间隔到期、没有目标或者跟踪失败时运行完整检测 */
+  detected_ = frames_since_detect_ >= params_.redetect_interval ||
+              targets_.empty() || prev_pyramid_.empty() || !Track(ctx);
+
+  if (detected_) {
+    Reset(ctx, detector_.Detect(ctx));
+  } else {
+    ++frames_since_detect_;
+    prev_origin_ = ctx.Origin();
+  }
+
+  duration_track_.Calc(detected_ ? "Detect Armors" : "Track Armors");
+  return targets_;
+}
+
+void FlowTracker::VisualizeResult(const cv::Mat &output, int verbose) {
+  if (detected_) {
+    detector_.VisualizeResult(output, verbose);
+  } else {
+    for (auto armor : targets_) {
+      armor.Translate(-prev_origin_);
+      armor.VisualizeObject(output, verbose > 2, draw::kYELLOW);
+    }
+  }
+
+  if (verbose > 1) {
+    std::string label =
+        cv::format("%ld armors %s in %ld ms.", targets_.size(),
+                   detected_ ? "detected" : "tracked", duration_track_.Count());
+    draw::VisualizeLabel(output, label, 3);
+  }
+}
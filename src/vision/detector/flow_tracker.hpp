@@ -0,0 +1,66 @@
+#pragma once
+
+#include <vector>
+
+#include "armor.hpp"
+#include "armor_detector.hpp"
+#include "detector.hpp"
+#include "frame_context.hpp"
+#include "opencv2/opencv.hpp"
+
+struct FlowTrackerParam {
+  int redetect_interval; /* 每隔多少帧强制完整检测一次 */
+  int win_size;
+  int max_level;
+  double fb_error_th;    /* 前向-后向光流误差上限，单位像素 */
+  double area_ratio_th;  /* 跟踪前后面积变化比例上限 */
+};
+
+/**
+ * @brief 光流跟踪器
+ * 在两次完整检测之间，用金字塔 LK 光流跟踪上一次装甲板的四个角点，
+ * 每帧都能输出装甲板角点，而只在间隔到期或跟踪置信度下降时才运行完整检测
+ *
+ */
+class FlowTracker : public Detector<Armor, FlowTrackerParam> {
+ private:
+  ArmorDetector &detector_;
+
+  std::vector<cv::Mat> prev_pyramid_;
+  cv::Point2f prev_origin_;
+  int frames_since_detect_ = 0;
+  bool detected_ = false;
+
+  component::Timer duration_track_;
+
+  void InitDefaultParams(const std::string &path);
+  bool PrepareParams(const std::string &path);
+
+  void BuildPyramid(FrameContext &ctx, std::vector<cv::Mat> &pyramid);
+  bool Track(FrameContext &ctx);
+
+ public:
+  explicit FlowTracker(ArmorDetector &detector);
+  FlowTracker(ArmorDetector &detector, const std::string &params_path);
+  ~FlowTracker();
+
+  /**
+   * @brief 用外部检测结果初始化跟踪，例如异步检测器的输出
+   *
+   * @param ctx 检测结果所在的帧
+   * @param armors 检测到的装甲板，坐标为整幅图像坐标
+   */
+  void Reset(FrameContext &ctx, const tbb::concurrent_vector<Armor> &armors);
+
+  /**
+   * @brief 上一次 Detect 是否运行了完整检测
+   *
+   * @return true 结果来自完整检测
+   * @return false 结果来自光流跟踪
+   */
+  bool Detected() const;
+
+  const tbb::concurrent_vector<Armor> &Detect(const cv::Mat &frame);
+  const tbb::concurrent_vector<Armor> &Detect(FrameContext &ctx);
+  void VisualizeResult(const cv::Mat &output, int verbose = 1);
+};
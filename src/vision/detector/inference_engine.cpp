@@ -0,0 +1,145 @@
+#include "inference_engine.hpp"
+
+#include <algorithm>
+
+#include "common.hpp"
+#include "cpu_engine.hpp"
+#include "spdlog/spdlog.h"
+#include "yolo_post_process.hpp"
+
+#if BUILD_NN
+#include "trt_detector.hpp"
+#endif
+
+std::string nn::ToString(Backend backend) {
+  switch (backend) {
+    case Backend::kAUTO:
+      return "Auto";
+    case Backend::kTENSORRT:
+      return "TensorRT";
+    case Backend::kCPU:
+      return "CPU";
+    default:
+      return "Unknown";
+  }
+}
+
+const cv::Mat &InferenceEngine::Preprocess(const cv::Mat &image,
+                                           Letterbox &letterbox) const {
+  letterbox.SetInputSize(input_size_);
+  letterbox.SetDepth(input_depth_);
+  return letterbox.Process(image);
+}
+
+std::vector<nn::Detection> InferenceEngine::PostProcess(
+    const float *prob, std::size_t size, const nn::LetterboxInfo &info) const {
+  /* 输出对应网络输入尺寸，去掉填充后换算回原图 */
+  nn::DecodeParam param;
+  param.stride = stride_;
+  param.conf_thresh = conf_thresh_;
+  param.offset_x = info.pad.x;
+  param.offset_y = info.pad.y;
+  param.scale_x = param.scale_y = 1.f / info.scale;
+  auto dets = nn::Decode(prob, size, param);
+  nn::NonMaxSuppression(dets, nms_thresh_);
+  return dets;
+}
+
+void InferenceEngine::SetThresh(float conf_thresh, float nms_thresh) {
+  conf_thresh_ = conf_thresh;
+  nms_thresh_ = nms_thresh;
+  SPDLOG_DEBUG("Params has been set.");
+}
+
+cv::Size InferenceEngine::InputSize() const { return input_size_; }
+
+void InferenceEngine::SetMaxBatch(int max_batch) {
+  max_batch_ = std::max(max_batch, 1);
+}
+
+int InferenceEngine::MaxBatch() const { return max_batch_; }
+
+std::vector<nn::Detection> InferenceEngine::Infer(const cv::Mat &image) {
+  SPDLOG_DEBUG("[InferenceEngine] Infer.");
+
+  std::vector<float> output;
+  if (!Forward(Preprocess(image, letterbox_), output)) return {};
+
+  auto dets = PostProcess(output.data(), output.size(), letterbox_.Info());
+
+  SPDLOG_DEBUG("[InferenceEngine] Infered.");
+  return dets;
+}
+
+std::vector<std::vector<nn::Detection>> InferenceEngine::InferBatch(
+    const std::vector<cv::Mat> &images) {
+  std::vector<std::vector<nn::Detection>> results(images.size());
+  std::vector<nn::LetterboxInfo> infos;
+  std::vector<float> output;
+
+  letterbox_.SetInputSize(input_size_);
+  letterbox_.SetDepth(input_depth_);
+  int batch = 0;
+  for (std::size_t begin = 0; begin < images.size(); begin += batch) {
+    batch = std::min<std::size_t>(max_batch_, images.size() - begin);
+    const int dims[] = {batch, 3, input_size_.height, input_size_.width};
+    batch_blob_.create(4, dims, input_depth_);
+
+    infos.resize(batch);
+    for (int i = 0; i < batch; ++i)
+      infos[i] = letterbox_.Process(images[begin + i], batch_blob_, i);
+
+    if (Forward(batch_blob_, output)) {
+      /* 每张图像的输出长度相同，依次排列 */
+      const std::size_t size = output.size() / batch;
+      for (int i = 0; i < batch; ++i)
+        results[begin + i] =
+            PostProcess(output.data() + i * size, size, infos[i]);
+      continue;
+    }
+    if (batch == 1) continue;
+
+    /* 模型不支持这个 batch 时逐张推理，之后不再尝试批量 */
+    SPDLOG_WARN("[InferenceEngine] Batch of {} failed, max batch -> 1.",
+                batch);
+    max_batch_ = 1;
+    const int single[] = {1, 3, input_size_.height, input_size_.width};
+    for (int i = 0; i < batch; ++i) {
+      const cv::Mat blob(4, single, input_depth_, batch_blob_.ptr(i));
+      if (Forward(blob, output))
+        results[begin + i] =
+            PostProcess(output.data(), output.size(), infos[i]);
+    }
+  }
+  SPDLOG_DEBUG("[InferenceEngine] Infered {} images.", images.size());
+  return results;
+}
+
+std::unique_ptr<InferenceEngine> CreateInferenceEngine(
+    const std::string &onnx_file_path, const nn::EngineOption &option) {
+  std::unique_ptr<InferenceEngine> engine;
+  nn::Backend backend = option.backend;
+  if (backend == nn::Backend::kAUTO)
+    backend = BUILD_NN ? nn::Backend::kTENSORRT : nn::Backend::kCPU;
+
+  if (backend == nn::Backend::kTENSORRT) {
+#if BUILD_NN
+    engine = std::make_unique<TrtDetector>();
+#else
+    SPDLOG_WARN("Built without TensorRT, fall back to CPU.");
+    backend = nn::Backend::kCPU;
+#endif
+  }
+  if (backend == nn::Backend::kCPU)
+    engine = std::make_unique<CpuEngine>(option.threads);
+
+  engine->SetThresh(option.conf_thresh, option.nms_thresh);
+  engine->SetMaxBatch(option.max_batch);
+  if (!engine->Load(onnx_file_path)) {
+    SPDLOG_ERROR("Can not load '{}' with {} backend.", onnx_file_path,
+                 nn::ToString(backend));
+    return nullptr;
+  }
+  SPDLOG_INFO("Inference backend: {}", nn::ToString(backend));
+  return engine;
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "letterbox.hpp"
+#include "opencv2/opencv.hpp"
+
+namespace nn {
+
+enum class Backend {
+  kAUTO,     /* 编译了 TensorRT 时使用 TensorRT，否则使用 CPU */
+  kTENSORRT, /* 需要 BUILD_NN */
+  kCPU,      /* OpenCV DNN，支持 FP32 和量化后的 INT8 ONNX 模型 */
+};
+
+struct EngineOption {
+  Backend backend = Backend::kAUTO;
+  int threads = 0;   /* CPU 推理线程数，0 表示使用 OpenCV 默认值 */
+  int max_batch = 1; /* 一次推理的最大图像数 */
+  float conf_thresh = 0.5f;
+  float nms_thresh = 0.5f;
+};
+
+struct Detection {
+  float x_ctr;
+  float y_ctr;
+  float w;
+  float h;
+  float conf;  // bbox_conf * cls_conf
+  float class_id;
+};
+
+std::string ToString(Backend backend);
+
+}  // namespace nn
+
+/**
+ * @brief 推理引擎
+ * 预处理、后处理和 NMS 由基类完成，后端只负责把 NCHW 输入变成原始输出，
+ * 每个预测框为 [x_ctr, y_ctr, w, h, obj_conf, class_conf...]
+ *
+ */
+class InferenceEngine {
+  friend class InferencePipeline;
+
+ protected:
+  float conf_thresh_ = 0.5f, nms_thresh_ = 0.5f;
+  cv::Size input_size_ = cv::Size(640, 640);
+  int input_depth_ = CV_32F; /* 网络输入精度，CV_32F 或 CV_16F */
+  int stride_ = 0;           /* 每个预测框的长度，5 + 类别数 */
+  int max_batch_ = 1;
+  Letterbox letterbox_;
+  cv::Mat batch_blob_;
+
+  const cv::Mat &Preprocess(const cv::Mat &image, Letterbox &letterbox) const;
+
+  /**
+   * @brief 解码原始输出并做 NMS
+   *
+   * @param prob 一张图像的原始输出
+   * @param size 原始输出长度
+   * @param info 预处理时的缩放和填充
+   * @return std::vector<nn::Detection> 原图坐标下的预测框
+   */
+  std::vector<nn::Detection> PostProcess(const float *prob, std::size_t size,
+                                         const nn::LetterboxInfo &info) const;
+
+  /**
+   * @brief 执行一次推理
+   *
+   * @param blob NCHW 格式的输入，N 不超过 max_batch_
+   * @param output 原始输出，N 张图像的输出依次排列
+   * @return true 推理成功
+   * @return false 推理失败
+   */
+  virtual bool Forward(const cv::Mat &blob, std::vector<float> &output) = 0;
+
+ public:
+  virtual ~InferenceEngine() = default;
+
+  /**
+   * @brief 加载模型
+   *
+   * @param onnx_file_path ONNX 模型路径
+   * @return true 加载成功
+   * @return false 加载失败
+   */
+  virtual bool Load(const std::string &onnx_file_path) = 0;
+  virtual nn::Backend GetBackend() const = 0;
+
+  void SetThresh(float conf_thresh, float nms_thresh);
+  cv::Size InputSize() const;
+
+  /**
+   * @brief 设置一次推理的最大图像数，需在 Load 之前调用
+   *
+   * @param max_batch 最大图像数
+   */
+  void SetMaxBatch(int max_batch);
+  int MaxBatch() const;
+
+  std::vector<nn::Detection> Infer(const cv::Mat &image);
+
+  /**
+   * @brief 批量推理，超过 MaxBatch 时分多次推理
+   * 模型不支持当前 batch 时退回逐张推理，并把 MaxBatch 降为 1
+   *
+   * @param images BGR 图像
+   * @return std::vector<std::vector<nn::Detection>> 每张图像的预测框
+   */
+  std::vector<std::vector<nn::Detection>> InferBatch(
+      const std::vector<cv::Mat> &images);
+};
+
+/**
+ * @brief 按选项创建推理引擎并加载模型
+ *
+ * @param onnx_file_path ONNX 模型路径
+ * @param option 后端、线程数和阈值
+ * @return std::unique_ptr<InferenceEngine> 加载失败时为空
+ */
+std::unique_ptr<InferenceEngine> CreateInferenceEngine(
+    const std::string &onnx_file_path,
+    const nn::EngineOption &option = nn::EngineOption());
@@ -0,0 +1,110 @@
+#include "inference_pipeline.hpp"
+
+#include <algorithm>
+
+#include "spdlog/spdlog.h"
+
+void InferencePipeline::Stage(std::deque<std::size_t> &from,
+                              std::deque<std::size_t> &to, const bool &stop,
+                              const std::function<void(Slot &)> &work) {
+  while (true) {
+    std::size_t idx;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cond_.wait(lock, [&] { return stop || !from.empty(); });
+      if (from.empty()) return;
+      idx = from.front();
+      from.pop_front();
+    }
+
+    work(slots_[idx]);
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      to.push_back(idx);
+    }
+    cond_.notify_all();
+  }
+}
+
+InferencePipeline::InferencePipeline(InferenceEngine &engine,
+                                     std::size_t slot_count)
+    : engine_(engine), slots_(std::max<std::size_t>(slot_count, 2)) {
+  for (std::size_t i = 0; i < slots_.size(); ++i) free_.push_back(i);
+
+  thread_pre_ = std::thread([this] {
+    Stage(to_pre_, to_infer_, stop_pre_, [this](Slot &slot) {
+      slot.blob = engine_.Preprocess(slot.image, slot.letterbox);
+    });
+  });
+  thread_infer_ = std::thread([this] {
+    Stage(to_infer_, to_post_, stop_infer_, [this](Slot &slot) {
+      slot.ok = engine_.Forward(slot.blob, slot.output);
+    });
+  });
+  thread_post_ = std::thread([this] {
+    Stage(to_post_, free_, stop_post_, [this](Slot &slot) {
+      if (slot.ok)
+        slot.promise.set_value(engine_.PostProcess(
+            slot.output.data(), slot.output.size(), slot.letterbox.Info()));
+      else
+        slot.promise.set_value(std::vector<nn::Detection>());
+    });
+  });
+  SPDLOG_TRACE("Constructed.");
+}
+
+InferencePipeline::~InferencePipeline() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+  }
+  Stop(stop_pre_, thread_pre_);
+  Stop(stop_infer_, thread_infer_);
+  Stop(stop_post_, thread_post_);
+  SPDLOG_TRACE("Destructed.");
+}
+
+void InferencePipeline::Stop(bool &stop, std::thread &thread) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop = true;
+  }
+  cond_.notify_all();
+  thread.join();
+}
+
+std::future<std::vector<nn::Detection>> InferencePipeline::Submit(
+    const cv::Mat &image) {
+  std::size_t idx;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait(lock, [&] { return closed_ || !free_.empty(); });
+    if (closed_) {
+      std::promise<std::vector<nn::Detection>> closed;
+      closed.set_value(std::vector<nn::Detection>());
+      return closed.get_future();
+    }
+    idx = free_.front();
+    free_.pop_front();
+  }
+
+  Slot &slot = slots_[idx];
+  image.copyTo(slot.image);
+  slot.promise = std::promise<std::vector<nn::Detection>>();
+  auto result = slot.promise.get_future();
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closed_) {
+      slot.promise.set_value(std::vector<nn::Detection>());
+      free_.push_back(idx);
+      return result;
+    }
+    to_pre_.push_back(idx);
+  }
+  cond_.notify_all();
+  return result;
+}
+
+std::size_t InferencePipeline::SlotCount() const { return slots_.size(); }
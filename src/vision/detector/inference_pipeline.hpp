@@ -0,0 +1,79 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "inference_engine.hpp"
+#include "letterbox.hpp"
+#include "opencv2/opencv.hpp"
+
+/**
+ * @brief 异步推理流水线
+ * 预处理、推理、后处理各用一个线程，帧在多个槽位间轮转，
+ * 第 N 帧推理时同时预处理第 N+1 帧、后处理第 N-1 帧。
+ * 引擎只在推理线程中调用 Forward，流水线运行期间不要再直接调用 Infer
+ *
+ */
+class InferencePipeline {
+ private:
+  struct Slot {
+    cv::Mat image;
+    Letterbox letterbox;
+    cv::Mat blob; /* 指向 letterbox 中的输入缓冲区 */
+    std::vector<float> output;
+    bool ok = false;
+    std::promise<std::vector<nn::Detection>> promise;
+  };
+
+  InferenceEngine &engine_;
+  std::vector<Slot> slots_;
+
+  std::deque<std::size_t> free_, to_pre_, to_infer_, to_post_;
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  bool closed_ = false; /* 不再接受新帧 */
+  /* 各级依次停止，上一级退出后下一级才停止，在途的帧都能处理完 */
+  bool stop_pre_ = false, stop_infer_ = false, stop_post_ = false;
+
+  std::thread thread_pre_, thread_infer_, thread_post_;
+
+  /**
+   * @brief 从上一级队列取出槽位，处理后放入下一级队列
+   *
+   * @param from 上一级队列
+   * @param to 下一级队列
+   * @param stop 停止标志，置位后处理完上一级队列中剩余的槽位再退出
+   * @param work 对槽位的处理
+   */
+  void Stage(std::deque<std::size_t> &from, std::deque<std::size_t> &to,
+             const bool &stop, const std::function<void(Slot &)> &work);
+
+  void Stop(bool &stop, std::thread &thread);
+
+ public:
+  /**
+   * @brief Construct a new Inference Pipeline object
+   *
+   * @param engine 已加载模型的推理引擎，生命周期需长于流水线
+   * @param slot_count 同时在途的帧数，至少为 2
+   */
+  explicit InferencePipeline(InferenceEngine &engine,
+                             std::size_t slot_count = 3);
+  ~InferencePipeline();
+
+  /**
+   * @brief 提交一帧，没有空闲槽位时阻塞等待
+   * 流水线析构时阻塞中的提交立即返回空结果
+   *
+   * @param image BGR 图像，提交时拷贝
+   * @return std::future<std::vector<nn::Detection>> 原图坐标下的预测框
+   */
+  std::future<std::vector<nn::Detection>> Submit(const cv::Mat &image);
+
+  std::size_t SlotCount() const;
+};
@@ -0,0 +1,128 @@
+#include "letterbox.hpp"
+
+#include <algorithm>
+
+#include "spdlog/spdlog.h"
+
+namespace {
+
+const float kPAD_VALUE = 114.f / 255.f; /* 与 YOLOv5 训练时的填充一致 */
+const float kNORM = 1.f / 255.f;
+
+/**
+ * @brief 把缩放后的图像按行写入三个平面
+ *
+ */
+template <typename T>
+void PackRows(const cv::Mat &resized, const cv::Point &pad, cv::Mat &blob,
+              int index) {
+  const int height = blob.size[2], width = blob.size[3];
+  const std::size_t plane = static_cast<std::size_t>(height) * width;
+  T *const data = reinterpret_cast<T *>(blob.data) + index * 3 * plane;
+  const T pad_value = T(kPAD_VALUE);
+
+  cv::parallel_for_(cv::Range(0, height), [&](const cv::Range &range) {
+    for (int y = range.start; y < range.end; ++y) {
+      T *r = data + static_cast<std::size_t>(y) * width;
+      T *g = r + plane;
+      T *b = g + plane;
+
+      const int src_y = y - pad.y;
+      if (src_y < 0 || src_y >= resized.rows) {
+        std::fill(r, r + width, pad_value);
+        std::fill(g, g + width, pad_value);
+        std::fill(b, b + width, pad_value);
+        continue;
+      }
+
+      const uchar *src = resized.ptr<uchar>(src_y);
+      const int right = pad.x + resized.cols;
+      for (int x = 0; x < pad.x; ++x) r[x] = g[x] = b[x] = pad_value;
+      for (int x = pad.x; x < right; ++x, src += 3) {
+        b[x] = T(src[0] * kNORM);
+        g[x] = T(src[1] * kNORM);
+        r[x] = T(src[2] * kNORM);
+      }
+      for (int x = right; x < width; ++x) r[x] = g[x] = b[x] = pad_value;
+    }
+  });
+}
+
+}  // namespace
+
+cv::Point2f nn::LetterboxInfo::ToImage(const cv::Point2f &point) const {
+  return (point - pad) / scale;
+}
+
+cv::Rect2f nn::LetterboxInfo::ToImage(const cv::Rect2f &rect) const {
+  return cv::Rect2f(ToImage(rect.tl()), rect.size() / scale);
+}
+
+Letterbox::Letterbox(const cv::Size &input_size, int depth)
+    : input_size_(input_size) {
+  SetDepth(depth);
+  SPDLOG_TRACE("Constructed.");
+}
+
+Letterbox::~Letterbox() { SPDLOG_TRACE("Destructed."); }
+
+void Letterbox::SetInputSize(const cv::Size &input_size) {
+  input_size_ = input_size;
+}
+
+void Letterbox::SetDepth(int depth) {
+  if (depth != CV_32F && depth != CV_16F) {
+    SPDLOG_ERROR("Unsupported depth {}, use CV_32F.", depth);
+    depth = CV_32F;
+  }
+  depth_ = depth;
+}
+
+const cv::Mat &Letterbox::Process(const cv::Mat &image) {
+  const int dims[] = {1, 3, input_size_.height, input_size_.width};
+  blob_.create(4, dims, depth_);
+  info_ = Process(image, blob_, 0);
+  return blob_;
+}
+
+nn::LetterboxInfo Letterbox::Process(const cv::Mat &image, cv::Mat &blob,
+                                     int index) {
+  nn::LetterboxInfo info;
+  if (blob.dims != 4 || blob.size[1] != 3 ||
+      blob.size[2] != input_size_.height || blob.size[3] != input_size_.width ||
+      blob.depth() != depth_ || index < 0 || index >= blob.size[0]) {
+    SPDLOG_ERROR("Blob does not match the input size.");
+    return info;
+  }
+
+  if (image.empty() || image.type() != CV_8UC3) {
+    SPDLOG_ERROR("Letterbox needs a CV_8UC3 image.");
+    cv::Mat plane(3, input_size_.height * input_size_.width, depth_,
+                  blob.ptr(index));
+    plane.setTo(cv::Scalar::all(kPAD_VALUE));
+    return info;
+  }
+
+  info.scale = std::min(static_cast<float>(input_size_.width) / image.cols,
+                        static_cast<float>(input_size_.height) / image.rows);
+  const cv::Size size(cvRound(image.cols * info.scale),
+                      cvRound(image.rows * info.scale));
+  const cv::Point pad((input_size_.width - size.width) / 2,
+                      (input_size_.height - size.height) / 2);
+  info.pad = pad;
+
+  /* 尺寸一致时直接使用原图，不再拷贝 */
+  cv::Mat resized = image;
+  if (size != image.size()) {
+    cv::resize(image, resized_, size, 0., 0., cv::INTER_LINEAR);
+    resized = resized_;
+  }
+
+  if (depth_ == CV_16F)
+    PackRows<cv::float16_t>(resized, pad, blob, index);
+  else
+    PackRows<float>(resized, pad, blob, index);
+  return info;
+}
+
+const nn::LetterboxInfo &Letterbox::Info() const { return info_; }
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "opencv2/opencv.hpp"
+
+namespace nn {
+
+struct LetterboxInfo {
+  float scale = 1.f; /* 原图到网络输入的缩放 */
+  cv::Point2f pad;   /* 网络输入左侧和上方的填充 */
+
+  cv::Point2f ToImage(const cv::Point2f &point) const;
+  cv::Rect2f ToImage(const cv::Rect2f &rect) const;
+};
+
+}  // namespace nn
+
+/**
+ * @brief 等比缩放并填充到网络输入尺寸
+ * 缩放后在一次并行遍历中完成填充、BGR 转 RGB、归一化到 [0, 1]
+ * 和 NCHW 排布，输出写入复用的输入缓冲区
+ *
+ */
+class Letterbox {
+ private:
+  cv::Size input_size_;
+  int depth_;
+  cv::Mat resized_, blob_;
+  nn::LetterboxInfo info_;
+
+ public:
+  /**
+   * @brief Construct a new Letterbox object
+   *
+   * @param input_size 网络输入尺寸
+   * @param depth 输出精度，CV_32F 或 CV_16F
+   */
+  explicit Letterbox(const cv::Size &input_size = cv::Size(640, 640),
+                     int depth = CV_32F);
+  ~Letterbox();
+
+  void SetInputSize(const cv::Size &input_size);
+  void SetDepth(int depth);
+
+  /**
+   * @brief 预处理一帧 BGR 图像
+   *
+   * @param image CV_8UC3 图像
+   * @return const cv::Mat& 1x3xHxW 的输入，下次调用前有效
+   */
+  const cv::Mat &Process(const cv::Mat &image);
+
+  /**
+   * @brief 预处理一帧 BGR 图像，写入批量输入的第 index 张
+   *
+   * @param image CV_8UC3 图像
+   * @param blob 已分配的 Nx3xHxW 输入
+   * @param index 在批量中的序号
+   * @return nn::LetterboxInfo 该图像的缩放和填充
+   */
+  nn::LetterboxInfo Process(const cv::Mat &image, cv::Mat &blob, int index);
+  const nn::LetterboxInfo &Info() const;
+};
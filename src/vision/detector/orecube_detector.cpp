@@ -39,13 +39,12 @@ bool OreCubeDetector::PrepareParams(const std::string &params_path) {
   }
 }
 
-void OreCubeDetector::FindOreCube(const cv::Mat &frame) {
+void OreCubeDetector::FindOreCube(FrameContext &ctx) {
   targets_.clear();
   duration_cube_.Start();
 
   cv::Mat result;
-  cv::cvtColor(frame, result, cv::COLOR_BGR2HSV);
-  cv::inRange(result,
+  cv::inRange(ctx.HSV(),
               cv::Scalar(params_.hue_low_th, params_.saturation_low_th,
                          params_.value_low_th),
               cv::Scalar(params_.hue_high_th, params_.saturation_high_th,
@@ -100,8 +99,14 @@ OreCubeDetector::~OreCubeDetector() { SPDLOG_TRACE("Destructed."); }
 
 const tbb::concurrent_vector<OreCube> &OreCubeDetector::Detect(
     const cv::Mat &frame) {
+  FrameContext ctx(frame);
+  return Detect(ctx);
+}
+
+const tbb::concurrent_vector<OreCube> &OreCubeDetector::Detect(
+    FrameContext &ctx) {
   SPDLOG_WARN("Start Detect");
-  FindOreCube(frame);
+  FindOreCube(ctx);
   SPDLOG_WARN("Detected.");
   return targets_;
 }
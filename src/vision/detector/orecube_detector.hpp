@@ -23,7 +23,7 @@ class OreCubeDetector : public Detector<OreCube, OreCubeDetectorParam> {
   void InitDefaultParams(const std::string &path);
   bool PrepareParams(const std::string &path);
 
-  void FindOreCube(const cv::Mat &frame);
+  void FindOreCube(FrameContext &ctx);
 
  public:
   OreCubeDetector();
@@ -31,5 +31,6 @@ class OreCubeDetector : public Detector<OreCube, OreCubeDetectorParam> {
   ~OreCubeDetector();
 
   const tbb::concurrent_vector<OreCube> &Detect(const cv::Mat &frame);
+  const tbb::concurrent_vector<OreCube> &Detect(FrameContext &ctx);
   void VisualizeResult(const cv::Mat &output, int verbose = 1);
 };
@@ -29,6 +29,17 @@ const std::vector<cv::Point2f> kAREA_SELF_BASE = {
     cv::Point(600, 600), cv::Point(650, 600), cv::Point(650, 650),
     cv::Point(600, 650)};
 
+const int kTILE_OVERLAP = 96; /* 大于远处机器人在原图中的尺寸 */
+
+std::vector<cv::Rect> AlertRegions() {
+  std::vector<cv::Rect> regions;
+  for (const auto* area : {&kAREA_ENEMY_BUFF, &kAREA_ENEMY_SNIPE,
+                           &kAREA_ENEMY_SLOPE, &kAREA_SELF_OUTPOST,
+                           &kAREA_SELF_SENTRY, &kAREA_SELF_BASE})
+    regions.push_back(cv::boundingRect(*area));
+  return regions;
+}
+
 }  // namespace
 
 bool RadarDetector::Search(std::vector<cv::Point2f> contour,
@@ -58,10 +69,9 @@ bool RadarDetector::Search(std::vector<cv::Point2f> contour,
     return false;
 }
 
-game::Alert RadarDetector::DetectRegion(const cv::Mat& frame) {
+game::Alert RadarDetector::DetectRegion(
+    const std::vector<nn::Detection>& detections) {
   game::Alert alert;
-  auto detections = detector_.Infer(frame);
-
   if (detections.empty()) {
     SPDLOG_ERROR("Detections is empty.");
     return alert;
@@ -94,20 +104,111 @@ game::Alert RadarDetector::DetectRegion(const cv::Mat& frame) {
   return alert;
 }
 
+std::vector<std::vector<nn::Detection>> RadarDetector::Infer(
+    const std::vector<cv::Mat>& images) {
+  if (engine_->MaxBatch() > 1) return engine_->InferBatch(images);
+
+  /* 批量推理失败后 MaxBatch 也会降为 1，此时再建立流水线 */
+  if (!pipeline_) pipeline_ = std::make_unique<InferencePipeline>(*engine_);
+  std::vector<std::future<std::vector<nn::Detection>>> futures;
+  futures.reserve(images.size());
+  for (const auto& image : images)
+    futures.emplace_back(pipeline_->Submit(image));
+
+  std::vector<std::vector<nn::Detection>> results;
+  results.reserve(images.size());
+  for (auto& future : futures) results.emplace_back(future.get());
+  return results;
+}
+
+std::vector<std::vector<nn::Detection>> RadarDetector::InferTiled(
+    const std::vector<cv::Mat>& frames) {
+  if (schedulers_.size() < frames.size()) schedulers_.resize(frames.size());
+
+  /* 所有相机本帧的图块放在一起推理 */
+  std::vector<cv::Mat> tiles;
+  std::vector<std::pair<std::size_t, std::size_t>> owners;
+  for (std::size_t c = 0; c < frames.size(); ++c) {
+    auto& scheduler = schedulers_[c];
+    if (frames[c].empty()) continue;
+    if (!scheduler.Planned(frames[c].size()))
+      scheduler.Plan(frames[c].size(), engine_->InputSize(), kTILE_OVERLAP,
+                     AlertRegions());
+
+    for (std::size_t i : scheduler.Schedule(tile_budget_)) {
+      tiles.push_back(frames[c](scheduler.Tile(i)));
+      owners.emplace_back(c, i);
+    }
+  }
+
+  auto detections = Infer(tiles);
+  for (std::size_t k = 0; k < owners.size(); ++k)
+    schedulers_[owners[k].first].Update(owners[k].second, detections[k]);
+
+  std::vector<std::vector<nn::Detection>> results(frames.size());
+  for (std::size_t c = 0; c < frames.size(); ++c)
+    if (!frames[c].empty()) results[c] = schedulers_[c].Merge(nms_thresh_);
+  return results;
+}
+
 RadarDetector::RadarDetector() { SPDLOG_TRACE("Constructed."); }
 
 RadarDetector::RadarDetector(const std::string& onnx_file_path,
                              float conf_thresh, float nms_thresh) {
-  detector_.SetOnnxPath(onnx_file_path);
-  detector_.Init(conf_thresh, nms_thresh);
+  nn::EngineOption option;
+  option.conf_thresh = conf_thresh;
+  option.nms_thresh = nms_thresh;
+  LoadModel(onnx_file_path, option);
+  SPDLOG_TRACE("Constructed.");
+}
+
+RadarDetector::RadarDetector(const std::string& onnx_file_path,
+                             const nn::EngineOption& option) {
+  LoadModel(onnx_file_path, option);
   SPDLOG_TRACE("Constructed.");
 }
 
 RadarDetector::~RadarDetector() { SPDLOG_TRACE("Destructed."); }
 
+bool RadarDetector::LoadModel(const std::string& onnx_file_path,
+                              const nn::EngineOption& option) {
+  pipeline_.reset();
+  engine_ = CreateInferenceEngine(onnx_file_path, option);
+  nms_thresh_ = option.nms_thresh;
+  schedulers_.clear();
+  return engine_ != nullptr;
+}
+
+void RadarDetector::SetTiling(bool tiling, std::size_t tile_budget) {
+  tiling_ = tiling;
+  tile_budget_ = tile_budget;
+  schedulers_.clear();
+}
+
 game::Alert RadarDetector::Detect(const cv::Mat& frame) {
   SPDLOG_DEBUG("Detecting");
-  game::Alert result = DetectRegion(frame);
+  if (!engine_) {
+    SPDLOG_ERROR("Inference engine is not ready.");
+    return game::Alert();
+  }
+  if (tiling_) return Detect(std::vector<cv::Mat>{frame}).front();
+  game::Alert result = DetectRegion(engine_->Infer(frame));
   SPDLOG_DEBUG("Detected.");
   return result;
 }
+
+std::vector<game::Alert> RadarDetector::Detect(
+    const std::vector<cv::Mat>& frames) {
+  SPDLOG_DEBUG("Detecting {} frames", frames.size());
+  std::vector<game::Alert> alerts(frames.size());
+  if (!engine_) {
+    SPDLOG_ERROR("Inference engine is not ready.");
+    return alerts;
+  }
+
+  auto detections = tiling_ ? InferTiled(frames) : Infer(frames);
+  for (std::size_t i = 0; i < frames.size(); ++i)
+    alerts[i] = DetectRegion(detections[i]);
+  SPDLOG_DEBUG("Detected.");
+  return alerts;
+}
@@ -1,21 +1,81 @@
 #pragma once
 
+#include <memory>
+
 #include "common.hpp"
+#include "inference_engine.hpp"
+#include "inference_pipeline.hpp"
 #include "opencv2/opencv.hpp"
-#include "trt_detector.hpp"
+#include "tile_scheduler.hpp"
 
 class RadarDetector {
  private:
-  TrtDetector detector_;
+  std::unique_ptr<InferenceEngine> engine_;
+  std::unique_ptr<InferencePipeline> pipeline_; /* 需在 engine_ 之前析构 */
+  float nms_thresh_ = 0.5f;
+
+  bool tiling_ = false;
+  std::size_t tile_budget_ = 4;
+  std::vector<TileScheduler> schedulers_; /* 每个相机一个 */
 
   bool Search(std::vector<cv::Point2f> contour, cv::Rect2f anchor);
-  game::Alert DetectRegion(const cv::Mat& frame);
+  game::Alert DetectRegion(const std::vector<nn::Detection>& detections);
+
+  /**
+   * @brief 推理多张图像
+   * 模型只能逐张推理时经过流水线，预处理和后处理与推理重叠
+   *
+   * @param images BGR 图像
+   * @return std::vector<std::vector<nn::Detection>> 每张图像的预测框
+   */
+  std::vector<std::vector<nn::Detection>> Infer(
+      const std::vector<cv::Mat>& images);
+  std::vector<std::vector<nn::Detection>> InferTiled(
+      const std::vector<cv::Mat>& frames);
 
  public:
   RadarDetector();
   RadarDetector(const std::string& onnx_file_path, float conf_thresh = 0.5f,
                 float nms_thresh = 0.5f);
+
+  /**
+   * @brief 按选项在运行时选择推理后端
+   *
+   * @param onnx_file_path ONNX 模型路径
+   * @param option 后端、线程数和阈值
+   */
+  RadarDetector(const std::string& onnx_file_path,
+                const nn::EngineOption& option);
   ~RadarDetector();
 
+  /**
+   * @brief 加载模型
+   *
+   * @param onnx_file_path ONNX 模型路径
+   * @param option 后端、线程数、最大 batch 和阈值
+   * @return true 加载成功
+   * @return false 加载失败
+   */
+  bool LoadModel(const std::string& onnx_file_path,
+                 const nn::EngineOption& option);
+
+  /**
+   * @brief 设置分块推理
+   * 原分辨率画面切成网络输入大小的重叠图块，覆盖警报区域的图块每帧推理，
+   * 其余图块轮流推理
+   *
+   * @param tiling 是否分块推理
+   * @param tile_budget 每个相机每帧推理的图块数
+   */
+  void SetTiling(bool tiling, std::size_t tile_budget = 4);
+
   game::Alert Detect(const cv::Mat& frame);
+
+  /**
+   * @brief 多个相机的画面作为一个 batch 推理
+   *
+   * @param frames 各相机画面
+   * @return std::vector<game::Alert> 各相机的警报，与 frames 一一对应
+   */
+  std::vector<game::Alert> Detect(const std::vector<cv::Mat>& frames);
 };
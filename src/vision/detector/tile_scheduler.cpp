@@ -0,0 +1,118 @@
+#include "tile_scheduler.hpp"
+
+#include <algorithm>
+
+#include "spdlog/spdlog.h"
+#include "yolo_post_process.hpp"
+
+namespace {
+
+const float kEDGE_MARGIN = 2.f; /* 距图块内部边缘小于此值视为被截断 */
+
+/**
+ * @brief 一个方向上各图块的起点，最后一块与原图边缘对齐
+ *
+ */
+std::vector<int> Positions(int length, int tile, int overlap) {
+  std::vector<int> positions{0};
+  if (length <= tile) return positions;
+
+  const int step = std::max(tile - overlap, 1);
+  for (int p = step; p + tile < length; p += step) positions.push_back(p);
+  positions.push_back(length - tile);
+  return positions;
+}
+
+}  // namespace
+
+TileScheduler::TileScheduler() { SPDLOG_TRACE("Constructed."); }
+
+TileScheduler::~TileScheduler() { SPDLOG_TRACE("Destructed."); }
+
+void TileScheduler::Plan(const cv::Size &frame_size, const cv::Size &tile_size,
+                         int overlap, const std::vector<cv::Rect> &regions) {
+  frame_size_ = frame_size;
+  tiles_.clear();
+  priority_.clear();
+  others_.clear();
+  cursor_ = 0;
+
+  const int width = std::min(tile_size.width, frame_size.width);
+  const int height = std::min(tile_size.height, frame_size.height);
+  for (int y : Positions(frame_size.height, height, overlap))
+    for (int x : Positions(frame_size.width, width, overlap))
+      tiles_.emplace_back(x, y, width, height);
+
+  for (std::size_t i = 0; i < tiles_.size(); ++i) {
+    const bool hit =
+        std::any_of(regions.begin(), regions.end(), [&](const cv::Rect &r) {
+          return (tiles_[i] & r).area() > 0;
+        });
+    (hit ? priority_ : others_).push_back(i);
+  }
+  dets_.assign(tiles_.size(), {});
+
+  SPDLOG_INFO("{} tiles, {} cover alert regions.", tiles_.size(),
+              priority_.size());
+}
+
+bool TileScheduler::Planned(const cv::Size &frame_size) const {
+  return !tiles_.empty() && frame_size_ == frame_size;
+}
+
+std::vector<std::size_t> TileScheduler::Schedule(std::size_t budget) {
+  std::vector<std::size_t> scheduled = priority_;
+  if (others_.empty()) return scheduled;
+
+  /* 至少推理一块其余图块，保证整个画面都能轮到 */
+  std::size_t count = budget > priority_.size() ? budget - priority_.size() : 1;
+  count = std::min(count, others_.size());
+  for (std::size_t k = 0; k < count; ++k) {
+    scheduled.push_back(others_[cursor_]);
+    cursor_ = (cursor_ + 1) % others_.size();
+  }
+  return scheduled;
+}
+
+const cv::Rect &TileScheduler::Tile(std::size_t i) const {
+  return tiles_.at(i);
+}
+
+std::size_t TileScheduler::TileCount() const { return tiles_.size(); }
+
+void TileScheduler::Update(std::size_t i,
+                           const std::vector<nn::Detection> &dets) {
+  const cv::Rect &tile = tiles_.at(i);
+  /* 与原图边缘重合的图块边缘不会截断目标 */
+  const bool inner_left = tile.x > 0;
+  const bool inner_top = tile.y > 0;
+  const bool inner_right = tile.br().x < frame_size_.width;
+  const bool inner_bottom = tile.br().y < frame_size_.height;
+
+  auto &result = dets_[i];
+  result.clear();
+  for (const auto &det : dets) {
+    const float left = det.x_ctr - det.w / 2.f;
+    const float top = det.y_ctr - det.h / 2.f;
+    const float right = det.x_ctr + det.w / 2.f;
+    const float bottom = det.y_ctr + det.h / 2.f;
+    if ((inner_left && left < kEDGE_MARGIN) ||
+        (inner_top && top < kEDGE_MARGIN) ||
+        (inner_right && right > tile.width - kEDGE_MARGIN) ||
+        (inner_bottom && bottom > tile.height - kEDGE_MARGIN))
+      continue;
+
+    nn::Detection shifted = det;
+    shifted.x_ctr += tile.x;
+    shifted.y_ctr += tile.y;
+    result.push_back(shifted);
+  }
+}
+
+std::vector<nn::Detection> TileScheduler::Merge(float nms_thresh) const {
+  std::vector<nn::Detection> merged;
+  for (const auto &dets : dets_)
+    merged.insert(merged.end(), dets.begin(), dets.end());
+  nn::NonMaxSuppression(merged, nms_thresh);
+  return merged;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "inference_engine.hpp"
+#include "opencv2/opencv.hpp"
+
+/**
+ * @brief 高分辨率画面的分块推理调度
+ * 原图切成相互重叠的图块，与关注区域相交的图块每帧推理，
+ * 其余图块轮流推理，各图块最近一次的结果合并后做 NMS
+ *
+ */
+class TileScheduler {
+ private:
+  cv::Size frame_size_;
+  std::vector<cv::Rect> tiles_;
+  std::vector<std::size_t> priority_, others_;
+  std::vector<std::vector<nn::Detection>> dets_; /* 各图块最近一次的结果 */
+  std::size_t cursor_ = 0;
+
+ public:
+  TileScheduler();
+  ~TileScheduler();
+
+  /**
+   * @brief 划分图块
+   *
+   * @param frame_size 原图尺寸
+   * @param tile_size 图块尺寸，一般为网络输入尺寸
+   * @param overlap 相邻图块的重叠像素，应大于最大目标尺寸
+   * @param regions 需要每帧推理的关注区域
+   */
+  void Plan(const cv::Size &frame_size, const cv::Size &tile_size,
+            int overlap, const std::vector<cv::Rect> &regions);
+
+  bool Planned(const cv::Size &frame_size) const;
+
+  /**
+   * @brief 选出本帧推理的图块
+   *
+   * @param budget 每帧推理的图块数，关注区域较多时可能超出
+   * @return std::vector<std::size_t> 图块序号
+   */
+  std::vector<std::size_t> Schedule(std::size_t budget);
+
+  const cv::Rect &Tile(std::size_t i) const;
+  std::size_t TileCount() const;
+
+  /**
+   * @brief 更新图块的结果，丢弃被图块内部边缘截断的预测框
+   *
+   * @param i 图块序号
+   * @param dets 图块坐标下的预测框
+   */
+  void Update(std::size_t i, const std::vector<nn::Detection> &dets);
+
+  /**
+   * @brief 合并所有图块的结果
+   *
+   * @param nms_thresh IOU 阈值
+   * @return std::vector<nn::Detection> 原图坐标下的预测框
+   */
+  std::vector<nn::Detection> Merge(float nms_thresh) const;
+};
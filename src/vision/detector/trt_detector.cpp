@@ -1,4 +1,3 @@
-
 #include "trt_detector.hpp"
 
 #include <NvOnnxParser.h>
@@ -10,6 +9,7 @@
 #include <vector>
 
 #include "cuda_runtime_api.h"
+#include "onnx_reader.hpp"
 #include "opencv2/opencv.hpp"
 #include "spdlog/spdlog.h"
 
@@ -47,82 +47,6 @@ int TRTLogger::GetVerbosity() { return static_cast<int>(Severity::kVERBOSE); }
 
 }  // namespace TRT
 
-cv::Mat Preprocess(cv::Mat raw) {
-  cv::Mat image;
-  raw.convertTo(image, CV_32FC3, 1.0 / 255.0, 0);
-  std::vector<cv::Mat1f> ch(3);
-  cv::split(image, ch);
-  cv::Mat final;
-  cv::merge(ch, final);
-  return final;
-}
-
-static float IOU(const TRT::Detection &det1, const TRT::Detection &det2) {
-  const float left =
-      std::max(det1.x_ctr - det1.w / 2., det2.x_ctr - det2.w / 2.);
-  const float right =
-      std::min(det1.x_ctr + det1.w / 2., det2.x_ctr + det2.w / 2.);
-  const float top =
-      std::max(det1.y_ctr - det1.h / 2., det2.y_ctr - det2.h / 2.);
-  const float bottom =
-      std::min(det1.y_ctr + det1.h / 2., det2.y_ctr + det2.h / 2.);
-
-  if (top > bottom || left > right) return 0.;
-
-  const float inter_box_s = (right - left) * (bottom - top);
-  return inter_box_s / (det1.w * det1.h + det2.w * det2.h - inter_box_s);
-}
-
-void NonMaxSuppression(std::vector<TRT::Detection> &dets, float nms_thresh) {
-  if (dets.empty()) return;
-
-  std::vector<TRT::Detection> keep;
-
-  std::sort(dets.begin(), dets.end(),
-            [](const TRT::Detection &det1, const TRT::Detection &det2) {
-              return det1.conf < det2.conf;
-            });
-
-  while (!dets.empty()) {
-    auto highest = dets.back();
-    keep.push_back(highest);
-    dets.pop_back();
-
-    for (auto it = dets.begin(); it != dets.end(); ++it) {
-      if (IOU(highest, *it) > nms_thresh) {
-        dets.erase(it);
-      }
-    }
-  }
-  dets = keep;
-}
-
-std::vector<TRT::Detection> TrtDetector::PostProcess(std::vector<float> prob) {
-  std::vector<TRT::Detection> dets;
-
-  for (auto it = prob.begin(); it != prob.end(); it += dim_out_.d[4]) {
-    if (*(it + 4) > conf_thresh_) {
-      auto max_conf = std::max_element(it + 4, it + dim_out_.d[4]);
-      auto class_id = std::distance(it + 4, max_conf);
-
-      TRT::Detection det{
-          *it,
-          *(it + 1),
-          *(it + 2),
-          *(it + 3),
-          *max_conf * *(it + 4),
-          static_cast<float>(class_id),
-      };
-      dets.push_back(det);
-    }
-  }
-  // [4] obj conf
-  // [5] [6] [7] [8] class_conf
-  // [5] [6] [7] [8] *= [4] conf = obj_conf * class_conf;
-  // [0] [1] [2] [3] = x_ctr y_ctr w h
-  return dets;
-}
-
 bool TrtDetector::CreateEngine() {
   SPDLOG_DEBUG("[TrtDetector] CreateEngine.");
 
@@ -134,8 +58,6 @@ bool TrtDetector::CreateEngine() {
     SPDLOG_DEBUG("[TrtDetector] createInferBuilder OK.");
   }
 
-  builder->setMaxBatchSize(1);
-
   const auto explicit_batch =
       1U << static_cast<uint32_t>(
           NetworkDefinitionCreationFlag::kEXPLICIT_BATCH);
@@ -177,13 +99,24 @@ bool TrtDetector::CreateEngine() {
     SPDLOG_DEBUG("[TrtDetector] parseFromFile OK.");
   }
 
+  /* 导出时 batch 为 -1 的模型才能使用动态 batch */
+  auto input = network->getInput(0);
+  const Dims dims = input->getDimensions();
+  if (dims.d[0] != -1 && max_batch_ > 1) {
+    SPDLOG_WARN("[TrtDetector] ONNX batch is fixed to {}, max batch -> 1.",
+                dims.d[0]);
+    max_batch_ = 1;
+  }
+  const int height = dims.d[2] > 0 ? dims.d[2] : input_size_.height;
+  const int width = dims.d[3] > 0 ? dims.d[3] : input_size_.width;
+
   auto profile = builder->createOptimizationProfile();
-  profile->setDimensions(network->getInput(0)->getName(),
-                         OptProfileSelector::kMIN, Dims4{1, 3, 640, 640});
-  profile->setDimensions(network->getInput(0)->getName(),
-                         OptProfileSelector::kOPT, Dims4{1, 3, 640, 640});
-  profile->setDimensions(network->getInput(0)->getName(),
-                         OptProfileSelector::kMAX, Dims4{1, 3, 640, 640});
+  profile->setDimensions(input->getName(), OptProfileSelector::kMIN,
+                         Dims4{1, dims.d[1], height, width});
+  profile->setDimensions(input->getName(), OptProfileSelector::kOPT,
+                         Dims4{max_batch_, dims.d[1], height, width});
+  profile->setDimensions(input->getName(), OptProfileSelector::kMAX,
+                         Dims4{max_batch_, dims.d[1], height, width});
   config->addOptimizationProfile(profile);
 
   if (builder->platformHasFastFp16()) config->setFlag(BuilderFlag::kFP16);
@@ -278,24 +211,44 @@ bool TrtDetector::InitMemory() {
   idx_out_ = engine_->getBindingIndex("output");
   dim_in_ = engine_->getBindingDimensions(idx_in_);
   dim_out_ = engine_->getBindingDimensions(idx_out_);
-  nc = dim_out_.d[4] - 5;
+  /* 动态 batch 的维度为 -1，按配置文件中的最大值分配显存 */
+  if (dim_in_.d[0] == -1) {
+    const Dims max_dims =
+        engine_->getProfileDimensions(idx_in_, 0, OptProfileSelector::kMAX);
+    engine_batch_ = max_dims.d[0];
+  } else {
+    engine_batch_ = dim_in_.d[0];
+  }
+  max_batch_ = engine_batch_;
+  nc = dim_out_.d[dim_out_.nbDims - 1] - 5;
+  stride_ = dim_out_.d[dim_out_.nbDims - 1];
+  input_size_ = cv::Size(dim_in_.d[3], dim_in_.d[2]);
 
   for (int32_t i = 0; i < engine_->getNbBindings(); ++i) {
     Dims dim = engine_->getBindingDimensions(i);
 
+    /* 第 0 维为 batch，先算单张图像的大小 */
     size_t volume = 1;
-    for (int32_t j = 0; j < dim.nbDims; ++j) volume *= dim.d[j];
+    for (int32_t j = 1; j < dim.nbDims; ++j) volume *= dim.d[j];
     DataType type = engine_->getBindingDataType(i);
     switch (type) {
       case DataType::kFLOAT:
         volume *= sizeof(float);
         break;
+      case DataType::kHALF:
+        volume *= sizeof(cv::float16_t);
+        if (i == idx_in_) input_depth_ = CV_16F;
+        break;
       default:
         SPDLOG_ERROR("[TrtDetector] Do not support input type: {}",
                      static_cast<int>(type));
         break;
     }
 
+    if (i == idx_in_) in_sample_size_ = volume;
+    if (i == idx_out_) out_sample_size_ = volume;
+    volume *= engine_batch_;
+
     void *device_memory = nullptr;
     cudaMalloc(&device_memory, volume);
     bindings_.push_back(device_memory);
@@ -326,43 +279,74 @@ TrtDetector::~TrtDetector() {
 }
 void TrtDetector::SetOnnxPath(const std::string &onnx_file_path) {
   onnx_file_path_ = onnx_file_path;
-  engine_path_.assign(onnx_file_path, 0, onnx_file_path.find(".onnx"));
-  engine_path_ = engine_path_ + std::string(".engine");
+  /* batch 固定的模型先降为 1，引擎文件名与实际 batch 一致 */
+  const std::vector<int64_t> shape = onnx::InputShape(onnx_file_path);
+  if (!shape.empty() && shape[0] > 0 && max_batch_ > 1) {
+    SPDLOG_WARN("[TrtDetector] ONNX batch is fixed to {}, max batch -> 1.",
+                shape[0]);
+    max_batch_ = 1;
+  }
+  SetEnginePath();
   SPDLOG_DEBUG("Onnx and engine file has been loaded");
 }
 
-void TrtDetector::Init(float conf_thresh, float nms_thresh) {
-  conf_thresh_ = conf_thresh;
-  nms_thresh_ = nms_thresh;
-  SPDLOG_DEBUG("Params has been set.");
+void TrtDetector::SetEnginePath() {
+  engine_path_.assign(onnx_file_path_, 0, onnx_file_path_.find(".onnx"));
+  /* 不同最大 batch 的引擎分开缓存 */
+  if (max_batch_ > 1) engine_path_ += "_b" + std::to_string(max_batch_);
+  engine_path_ = engine_path_ + std::string(".engine");
+}
+
+bool TrtDetector::Init(float conf_thresh, float nms_thresh) {
+  SetThresh(conf_thresh, nms_thresh);
 
   if (!LoadEngine()) {
-    CreateEngine();
+    if (!CreateEngine()) return false;
+    /* 固定 batch 的模型在建引擎时降为 1，按实际 batch 命名缓存 */
+    SetEnginePath();
     SaveEngine();
   }
-  CreateContex();
-  InitMemory();
+  return CreateContex() && InitMemory();
 }
 
-bool TrtDetector::TestInfer() {
-  SPDLOG_DEBUG("[TrtDetector] TestInfer.");
-  cv::Mat image = cv::imread("./image/test.jpg");
-  cv::resize(image, image, cv::Size(608, 608));
-  cv::cvtColor(image, image, cv::COLOR_BGR2RGB);
-  cv::imwrite("./image/test_tensorrt_in.jpg", image);
+bool TrtDetector::Load(const std::string &onnx_file_path) {
+  SetOnnxPath(onnx_file_path);
+  return Init(conf_thresh_, nms_thresh_);
+}
 
-  // image = Preprocess(image);
+nn::Backend TrtDetector::GetBackend() const { return nn::Backend::kTENSORRT; }
 
-  std::vector<float> output(bingings_size_.at(idx_out_) / sizeof(float));
+bool TrtDetector::Forward(const cv::Mat &blob, std::vector<float> &output) {
+  const int batch = blob.size[0];
+  const size_t in_size = blob.total() * blob.elemSize();
+  /* 退回逐张推理只改变调度的 batch，显存仍按引擎的 batch 分配 */
+  const bool fixed = dim_in_.d[0] != -1;
+  if (batch > engine_batch_ || (fixed && batch != engine_batch_) ||
+      in_size != in_sample_size_ * batch) {
+    SPDLOG_ERROR("[TrtDetector] Input size mismatch.");
+    return false;
+  }
+  if (dim_in_.d[0] == -1) {
+    Dims dims = dim_in_;
+    dims.d[0] = batch;
+    context_->setBindingDimensions(idx_in_, dims);
+  }
+  const size_t out_size = out_sample_size_ * batch;
+  output.resize(out_size / sizeof(float));
 
-  cudaMemcpy(bindings_.at(idx_in_), image.data, bingings_size_.at(idx_in_),
-             cudaMemcpyHostToDevice);
-  context_->executeV2(bindings_.data());
-  cudaMemcpy(output.data(), bindings_.at(idx_out_), bingings_size_.at(idx_out_),
+  cudaMemcpy(bindings_.at(idx_in_), blob.data, in_size, cudaMemcpyHostToDevice);
+  if (!context_->executeV2(bindings_.data())) return false;
+  cudaMemcpy(output.data(), bindings_.at(idx_out_), out_size,
              cudaMemcpyDeviceToHost);
+  return true;
+}
 
-  auto dets = PostProcess(output);
-  NonMaxSuppression(dets, nms_thresh_);
+bool TrtDetector::TestInfer() {
+  SPDLOG_DEBUG("[TrtDetector] TestInfer.");
+  cv::Mat image = cv::imread("./image/test.jpg");
+  if (image.empty()) return false;
+
+  auto dets = Infer(image);
 
   for (auto it = dets.begin(); it != dets.end(); ++it) {
     const cv::Point org(it->x_ctr - it->w / 2, it->y_ctr - it->h / 2);
@@ -378,22 +362,3 @@ bool TrtDetector::TestInfer() {
   SPDLOG_DEBUG("[TrtDetector] TestInfer done.");
   return true;
 }
-
-std::vector<TRT::Detection> TrtDetector::Infer(const cv::Mat &raw) {
-  SPDLOG_DEBUG("[TrtDetector] Infer.");
-
-  std::vector<float> output(bingings_size_.at(idx_out_) / sizeof(float));
-  auto image = Preprocess(raw);
-
-  cudaMemcpy(bindings_.at(idx_in_), image.data, bingings_size_.at(idx_in_),
-             cudaMemcpyHostToDevice);
-  context_->executeV2(bindings_.data());
-  cudaMemcpy(output.data(), bindings_.at(idx_out_), bingings_size_.at(idx_out_),
-             cudaMemcpyDeviceToHost);
-
-  auto dets = PostProcess(output);
-  NonMaxSuppression(dets, nms_thresh_);
-
-  SPDLOG_DEBUG("[TrtDetector] Infered.");
-  return dets;
-}
@@ -7,6 +7,7 @@
 #include <string>
 #include <vector>
 
+#include "inference_engine.hpp"
 #include "opencv2/opencv.hpp"
 
 namespace TRT {
@@ -26,18 +27,15 @@ class TRTLogger : public nvinfer1::ILogger {
   int GetVerbosity();
 };
 
-struct Detection {
-  float x_ctr;
-  float y_ctr;
-  float w;
-  float h;
-  float conf;  // bbox_conf * cls_conf
-  float class_id;
-};
+using Detection = nn::Detection;
 
 }  // namespace TRT
 
-class TrtDetector {
+/**
+ * @brief 基于 TensorRT 的推理后端
+ *
+ */
+class TrtDetector : public InferenceEngine {
   template <typename T>
   using UniquePtr = std::unique_ptr<T, TRT::TRTDeleter>;
 
@@ -50,21 +48,23 @@ class TrtDetector {
   UniquePtr<nvinfer1::ICudaEngine> engine_;
   UniquePtr<nvinfer1::IExecutionContext> context_;
 
-  float conf_thresh_, nms_thresh_;
-
   std::vector<void *> bindings_;
   std::vector<size_t> bingings_size_;
+  size_t in_sample_size_, out_sample_size_; /* 单张图像的输入输出字节数 */
+  int engine_batch_;                        /* 显存按此 batch 分配 */
   int idx_in_, idx_out_;
   nvinfer1::Dims dim_in_, dim_out_;
   int nc;
 
-  std::vector<TRT::Detection> PostProcess(std::vector<float> prob);
-
   bool CreateEngine();
   bool LoadEngine();
   bool SaveEngine();
   bool CreateContex();
   bool InitMemory();
+  void SetEnginePath();
+
+ protected:
+  bool Forward(const cv::Mat &blob, std::vector<float> &output) override;
 
  public:
   TrtDetector();
@@ -73,9 +73,10 @@ class TrtDetector {
   ~TrtDetector();
 
   void SetOnnxPath(const std::string &onnx_file_path);
-  void Init(float conf_thresh = 0.5f, float nms_thresh = 0.5f);
+  bool Init(float conf_thresh = 0.5f, float nms_thresh = 0.5f);
 
-  std::vector<TRT::Detection> Infer(const cv::Mat &);
+  bool Load(const std::string &onnx_file_path) override;
+  nn::Backend GetBackend() const override;
 
   bool TestInfer();
 };
@@ -0,0 +1,122 @@
+#include "yolo_post_process.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+#include "opencv2/core/hal/intrin.hpp"
+
+namespace {
+
+const int kOBJ_OFFSET = 4; /* obj_conf 在预测框中的位置 */
+const int kCLS_OFFSET = 5; /* 第一个类别置信度的位置 */
+
+bool GreaterConf(const nn::Detection &det1, const nn::Detection &det2) {
+  return det1.conf > det2.conf;
+}
+
+/**
+ * @brief 找出 obj_conf 超过阈值的预测框序号
+ * 每次按步长取出 nlanes 个预测框的 obj_conf 并行比较，尾部用标量处理
+ *
+ */
+void SelectCandidates(const float *data, int count, int stride, float thresh,
+                      std::vector<int> &candidates) {
+  int i = 0;
+#if CV_SIMD
+  const int lanes = cv::v_float32::nlanes;
+  int offsets[cv::v_float32::nlanes];
+  for (int k = 0; k < lanes; ++k) offsets[k] = k * stride + kOBJ_OFFSET;
+
+  const cv::v_float32 v_thresh = cv::vx_setall_f32(thresh);
+  for (; i + lanes <= count; i += lanes) {
+    const cv::v_float32 obj = cv::vx_lut(data + i * stride, offsets);
+    int mask = cv::v_signmask(obj > v_thresh);
+    for (int k = i; mask != 0; ++k, mask >>= 1)
+      if (mask & 1) candidates.push_back(k);
+  }
+#endif
+  for (; i < count; ++i)
+    if (data[i * stride + kOBJ_OFFSET] > thresh) candidates.push_back(i);
+}
+
+}  // namespace
+
+float nn::IOU(const Detection &det1, const Detection &det2) {
+  const float left =
+      std::max(det1.x_ctr - det1.w / 2., det2.x_ctr - det2.w / 2.);
+  const float right =
+      std::min(det1.x_ctr + det1.w / 2., det2.x_ctr + det2.w / 2.);
+  const float top =
+      std::max(det1.y_ctr - det1.h / 2., det2.y_ctr - det2.h / 2.);
+  const float bottom =
+      std::min(det1.y_ctr + det1.h / 2., det2.y_ctr + det2.h / 2.);
+
+  if (top > bottom || left > right) return 0.;
+
+  const float inter_box_s = (right - left) * (bottom - top);
+  const float union_s = det1.w * det1.h + det2.w * det2.h - inter_box_s;
+  return union_s > 0. ? inter_box_s / union_s : 0.;
+}
+
+std::vector<nn::Detection> nn::Decode(const float *data, std::size_t size,
+                                      const DecodeParam &param) {
+  std::vector<Detection> dets;
+  const int stride = param.stride;
+  if (data == nullptr || stride <= kCLS_OFFSET) return dets;
+
+  std::vector<int> candidates;
+  SelectCandidates(data, static_cast<int>(size / stride), stride,
+                   param.conf_thresh, candidates);
+
+  dets.reserve(candidates.size());
+  for (int i : candidates) {
+    const float *box = data + static_cast<std::size_t>(i) * stride;
+    const float *max_conf = std::max_element(box + kCLS_OFFSET, box + stride);
+    dets.push_back(Detection{
+        (box[0] - param.offset_x) * param.scale_x,
+        (box[1] - param.offset_y) * param.scale_y,
+        box[2] * param.scale_x,
+        box[3] * param.scale_y,
+        *max_conf * box[kOBJ_OFFSET],
+        static_cast<float>(max_conf - box - kCLS_OFFSET),
+    });
+  }
+
+  /* 只保留置信度最高的 top_k 个，避免 NMS 的平方复杂度 */
+  if (param.top_k > 0 && dets.size() > param.top_k) {
+    std::nth_element(dets.begin(), dets.begin() + param.top_k, dets.end(),
+                     GreaterConf);
+    dets.resize(param.top_k);
+  }
+  std::sort(dets.begin(), dets.end(), GreaterConf);
+  return dets;
+}
+
+void nn::NonMaxSuppression(std::vector<Detection> &dets, float nms_thresh,
+                           bool class_aware) {
+  const std::size_t n = dets.size();
+  if (n < 2) return;
+
+  if (!std::is_sorted(dets.begin(), dets.end(), GreaterConf))
+    std::stable_sort(dets.begin(), dets.end(), GreaterConf);
+
+  std::vector<uint64_t> suppressed((n + 63) / 64, 0);
+  auto is_suppressed = [&](std::size_t i) {
+    return (suppressed[i / 64] >> (i % 64)) & 1;
+  };
+
+  std::vector<Detection> keep;
+  keep.reserve(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    if (is_suppressed(i)) continue;
+    keep.push_back(dets[i]);
+
+    for (std::size_t j = i + 1; j < n; ++j) {
+      if (is_suppressed(j)) continue;
+      if (class_aware && dets[j].class_id != dets[i].class_id) continue;
+      if (IOU(dets[i], dets[j]) > nms_thresh)
+        suppressed[j / 64] |= uint64_t(1) << (j % 64);
+    }
+  }
+  dets.swap(keep);
+}
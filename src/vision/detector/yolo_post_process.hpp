@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "inference_engine.hpp"
+
+namespace nn {
+
+struct DecodeParam {
+  int stride = 0; /* 每个预测框的长度，5 + 类别数 */
+  float conf_thresh = 0.5f;
+  std::size_t top_k = 300; /* 进入 NMS 的最大预测框数，0 表示不限制 */
+  float offset_x = 0.f;    /* 网络输入中的填充，先减去再缩放 */
+  float offset_y = 0.f;
+  float scale_x = 1.f;     /* 网络输入坐标到原图坐标的缩放 */
+  float scale_y = 1.f;
+};
+
+float IOU(const Detection &det1, const Detection &det2);
+
+/**
+ * @brief 解码 YOLO 原始输出
+ * 先用 SIMD 按 obj_conf 过滤，再只对剩余预测框求类别，
+ * 结果按置信度降序排列，最多 top_k 个
+ *
+ * @param data 原始输出，每个预测框为 [x_ctr, y_ctr, w, h, obj_conf, cls...]
+ * @param size 原始输出长度
+ * @param param 解码参数
+ * @return std::vector<Detection> 预测框
+ */
+std::vector<Detection> Decode(const float *data, std::size_t size,
+                              const DecodeParam &param);
+
+/**
+ * @brief 非极大值抑制
+ * 按置信度降序遍历，用位图记录被抑制的预测框，不在循环中删除元素
+ *
+ * @param dets 预测框，原地保留抑制后的结果
+ * @param nms_thresh IOU 阈值
+ * @param class_aware 为 true 时只在同类别间抑制
+ */
+void NonMaxSuppression(std::vector<Detection> &dets, float nms_thresh,
+                       bool class_aware = true);
+
+}  // namespace nn
@@ -48,6 +48,13 @@ const cv::Matx43d kCOORD_BUFF_ARMOR(
 
 const cv::Point3f kHIT_TARGET(0., 0., kHIT_DEPTH);
 
+/* 装甲板坐标相对整幅图像，ctx 为感兴趣区域时需移回其坐标系 */
+std::vector<cv::Point2f> LocalVertices(std::vector<cv::Point2f> vertices,
+                                       const FrameContext &ctx) {
+  for (auto &vertex : vertices) vertex -= ctx.Origin();
+  return vertices;
+}
+
 }  // namespace
 
 cv::RotatedRect Armor::FormRect(const LightBar &left_bar,
@@ -84,6 +91,17 @@ Armor::Armor(const cv::RotatedRect &rect) {
   SPDLOG_TRACE("Constructed.");
 }
 
+Armor::Armor(const std::vector<cv::Point2f> &vertices) {
+  rect_ = cv::minAreaRect(vertices);
+  Init();
+
+  /* 透视下的四边形不是矩形，PnP 需要原始角点和顺序 */
+  image_vertices_ = vertices;
+  image_center_ = (vertices[0] + vertices[1] + vertices[2] + vertices[3]) / 4;
+  rect_.center = image_center_;
+  SPDLOG_TRACE("Constructed.");
+}
+
 Armor::~Armor() { SPDLOG_TRACE("Destructed."); }
 
 game::Model Armor::GetModel() const { return model_; }
@@ -99,26 +117,43 @@ void Armor::SetModel(game::Model model) {
   }
 }
 
+double Armor::GetModelConf() const { return model_conf_; }
+void Armor::SetModelConf(double conf) { model_conf_ = conf; }
+
 const cv::RotatedRect Armor::GetRect() const { return rect_; }
 
+void Armor::Translate(const cv::Point2f &offset) {
+  ImageObject::Translate(offset);
+  rect_.center += offset;
+}
+
+const std::vector<cv::Point2f> &Armor::FaceVertices() const {
+  return ImageAspectRatio() > 1.2 ? kDST_POV_BIG : kDST_POV_SMALL;
+}
+
 cv::Mat Armor::Face(const cv::Mat &frame) {
+  FrameContext ctx(frame);
+  return Face(ctx);
+}
+
+cv::Mat Armor::Face(FrameContext &ctx) {
   double len;
   cv::Mat face;
   std::vector<cv::Point2f> pts(4);
 
+  const auto vertices = LocalVertices(ImageVertices(), ctx);
   if (ImageAspectRatio() > 1.2) {
-    trans_ = cv::getPerspectiveTransform(ImageVertices(), kDST_POV_BIG);
+    trans_ = cv::getPerspectiveTransform(vertices, kDST_POV_BIG);
     len = kARMOR_LENGTH_BIG;
   } else {
-    trans_ = cv::getPerspectiveTransform(ImageVertices(), kDST_POV_SMALL);
+    trans_ = cv::getPerspectiveTransform(vertices, kDST_POV_SMALL);
     len = kARMOR_LENGTH_SMALL;
   }
   face_size_ = cv::Size(len, kARMOR_WIDTH);
 
-  cv::warpPerspective(frame, face, trans_, face_size_);
+  /* 直接对整帧共享的灰度图做透视变换，单通道插值也更快 */
+  cv::warpPerspective(ctx.FaceGray(), face, trans_, face_size_);
 
-  cv::cvtColor(face, face, cv::COLOR_RGB2GRAY);
-  cv::medianBlur(face, face, 1);
 #if 0
   cv::equalizeHist(face, face); /* Tried. No help. */
 #endif
@@ -131,6 +166,37 @@ cv::Mat Armor::Face(const cv::Mat &frame) {
   face = face(cv::Rect(offset_w, offset_h, min_edge, min_edge));
   return face;
 }
+
+cv::Mat Armor::Face(FrameContext &ctx, const cv::Size &size) {
+  const bool big = ImageAspectRatio() > 1.2;
+  const auto &pov = big ? kDST_POV_BIG : kDST_POV_SMALL;
+  const double len = big ? kARMOR_LENGTH_BIG : kARMOR_LENGTH_SMALL;
+
+  /* 中间正方形直接映射到目标尺寸，省去整幅图案的变换和二次缩放 */
+  const double offset = (len - kARMOR_WIDTH) / 2.;
+  const double scale_x = size.width / kARMOR_WIDTH;
+  const double scale_y = size.height / kARMOR_WIDTH;
+  std::vector<cv::Point2f> dst_pts(pov.size());
+  for (std::size_t i = 0; i < pov.size(); ++i)
+    dst_pts[i] = cv::Point2f((pov[i].x - offset) * scale_x, pov[i].y * scale_y);
+  trans_ =
+      cv::getPerspectiveTransform(LocalVertices(ImageVertices(), ctx), dst_pts);
+  face_size_ = size;
+
+  /* 只插值目标尺寸的单通道像素 */
+  cv::Mat face;
+  cv::warpPerspective(ctx.FaceGray(), face, trans_, size);
+  cv::threshold(face, face, 0., 255., cv::THRESH_BINARY | cv::THRESH_TRIANGLE);
+  return face;
+}
+
+void Armor::FaceBlob(FrameContext &ctx, const cv::Size &input_size,
+                     double scale, float *dst) {
+  /* 缩放后直接写入输入张量 */
+  cv::Mat blob(input_size, CV_32F, dst);
+  Face(ctx, input_size).convertTo(blob, CV_32F, scale);
+}
+
 double Armor::GetArea() { return rect_.size.width * rect_.size.height; }
 component::Euler Armor::GetAimEuler() const { return aiming_euler_; }
 void Armor::SetAimEuler(const component::Euler &elur) { aiming_euler_ = elur; }
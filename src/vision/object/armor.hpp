@@ -3,6 +3,7 @@
 #include <vector>
 
 #include "common.hpp"
+#include "frame_context.hpp"
 #include "light_bar.hpp"
 #include "object.hpp"
 #include "opencv2/opencv.hpp"
@@ -10,6 +11,7 @@
 class Armor : public ImageObject, public PhysicObject {
  private:
   game::Model model_ = game::Model::kUNKNOWN;
+  double model_conf_ = 0.; /* 分类置信度 */
   component::Euler aiming_euler_;
   cv::RotatedRect rect_;
 
@@ -20,12 +22,50 @@ class Armor : public ImageObject, public PhysicObject {
   Armor();
   Armor(const LightBar &left_bar, const LightBar &right_bar);
   explicit Armor(const cv::RotatedRect &rect);
+
+  /**
+   * @brief 由四个角点构造，保留角点顺序，例如光流跟踪得到的角点
+   *
+   * @param vertices 与 ImageVertices 顺序一致的四个角点
+   */
+  explicit Armor(const std::vector<cv::Point2f> &vertices);
   ~Armor();
 
   game::Model GetModel() const;
   void SetModel(game::Model model);
+  double GetModelConf() const;
+  void SetModelConf(double conf);
   const cv::RotatedRect GetRect() const;
+  void Translate(const cv::Point2f &offset);
   cv::Mat Face(const cv::Mat &frame);
+  cv::Mat Face(FrameContext &ctx);
+
+  /**
+   * @brief 正视图案的四个角点，与图像角点一一对应
+   *
+   * @return const std::vector<cv::Point2f>& 按长宽比选择大、小装甲板
+   */
+  const std::vector<cv::Point2f> &FaceVertices() const;
+
+  /**
+   * @brief 把中间正方形图案直接变换到指定尺寸并二值化
+   *
+   * @param ctx 帧上下文
+   * @param size 输出尺寸
+   * @return cv::Mat 二值图案
+   */
+  cv::Mat Face(FrameContext &ctx, const cv::Size &size);
+
+  /**
+   * @brief 把中间正方形图案直接变换到网络输入尺寸，二值化后写入输入张量
+   *
+   * @param ctx 帧上下文
+   * @param input_size 网络输入尺寸
+   * @param scale 像素值缩放系数
+   * @param dst 输入张量中对应的单通道平面，大小为 input_size.area()
+   */
+  void FaceBlob(FrameContext &ctx, const cv::Size &input_size, double scale,
+                float *dst);
   double GetArea();
   component::Euler GetAimEuler() const;
   void SetAimEuler(const component::Euler &elur);
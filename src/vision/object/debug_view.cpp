@@ -0,0 +1,222 @@
+#include "debug_view.hpp"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+
+#include "spdlog/spdlog.h"
+
+namespace {
+
+const char kHTTP_HEADER[] =
+    "HTTP/1.0 200 OK\r\n"
+    "Cache-Control: no-cache\r\n"
+    "Connection: close\r\n"
+    "Content-Type: multipart/x-mixed-replace; boundary=frame\r\n\r\n";
+
+const int kJPEG_QUALITY = 70;
+const auto kIDLE_WAIT = std::chrono::milliseconds(100);
+
+bool SendAll(int fd, const void *data, std::size_t size) {
+  auto ptr = static_cast<const char *>(data);
+  while (size > 0) {
+    const ssize_t sent = send(fd, ptr, size, MSG_NOSIGNAL);
+    if (sent <= 0) return false;
+    ptr += sent;
+    size -= sent;
+  }
+  return true;
+}
+
+}  // namespace
+
+void draw::DrawList::AddPolygon(const std::vector<cv::Point2f> &vertices,
+                                const cv::Scalar &color) {
+  polygons_.emplace_back(Polygon{vertices, color});
+}
+
+void draw::DrawList::AddMarker(const cv::Point2f &point,
+                               const cv::Scalar &color, cv::MarkerTypes type) {
+  markers_.emplace_back(Marker{point, color, type});
+}
+
+void draw::DrawList::AddLabel(const std::string &text, int level,
+                              const cv::Scalar &color) {
+  labels_.emplace_back(Label{text, level, color});
+}
+
+void draw::DrawList::AddObject(const ImageObject &object,
+                               const cv::Scalar &color) {
+  AddPolygon(object.ImageVertices(), color);
+  AddMarker(object.ImageCenter(), color, cv::MarkerTypes::MARKER_DIAMOND);
+}
+
+void draw::DrawList::Render(const cv::Mat &output) const {
+  for (const auto &polygon : polygons_) {
+    const auto &vertices = polygon.vertices;
+    for (std::size_t i = 0; i < vertices.size(); ++i)
+      cv::line(output, vertices[i], vertices[(i + 1) % vertices.size()],
+               polygon.color);
+  }
+  for (const auto &marker : markers_)
+    cv::drawMarker(output, marker.point, marker.color, marker.type);
+  for (const auto &label : labels_)
+    VisualizeLabel(output, label.text, label.level, label.color);
+}
+
+bool draw::DrawList::Empty() const {
+  return polygons_.empty() && markers_.empty() && labels_.empty();
+}
+
+void draw::DrawList::Clear() {
+  polygons_.clear();
+  markers_.clear();
+  labels_.clear();
+}
+
+bool DebugView::OpenServer(unsigned short port) {
+  server_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+  if (server_fd_ < 0) {
+    SPDLOG_ERROR("Can not create socket.");
+    return false;
+  }
+
+  int reuse = 1;
+  setsockopt(server_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+  fcntl(server_fd_, F_SETFL, fcntl(server_fd_, F_GETFL) | O_NONBLOCK);
+
+  /* 只监听本机，远程查看可通过 ssh 端口转发 */
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (bind(server_fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) <
+          0 ||
+      listen(server_fd_, 4) < 0) {
+    SPDLOG_ERROR("Can not listen on port {}.", port);
+    close(server_fd_);
+    server_fd_ = -1;
+    return false;
+  }
+  SPDLOG_INFO("Debug view at http://127.0.0.1:{}/", port);
+  return true;
+}
+
+void DebugView::AcceptClients() {
+  if (server_fd_ < 0) return;
+
+  int fd;
+  while ((fd = accept(server_fd_, nullptr, nullptr)) >= 0) {
+    /* 不解析请求，直接回复视频流 */
+    if (SendAll(fd, kHTTP_HEADER, sizeof(kHTTP_HEADER) - 1)) {
+      clients_.emplace_back(fd);
+      SPDLOG_INFO("Debug view client connected.");
+    } else {
+      close(fd);
+    }
+  }
+  client_count_ = clients_.size();
+}
+
+void DebugView::Serve(const cv::Mat &image) {
+  if (sink_ == Sink::kWINDOW) {
+    cv::imshow(window_name_, image);
+    cv::waitKey(1);
+    return;
+  }
+
+  std::vector<uchar> jpeg;
+  cv::imencode(".jpg", image, jpeg, {cv::IMWRITE_JPEG_QUALITY, kJPEG_QUALITY});
+  const std::string part = cv::format(
+      "--frame\r\nContent-Type: image/jpeg\r\nContent-Length: %zu\r\n\r\n",
+      jpeg.size());
+
+  for (auto it = clients_.begin(); it != clients_.end();) {
+    if (SendAll(*it, part.data(), part.size()) &&
+        SendAll(*it, jpeg.data(), jpeg.size()) && SendAll(*it, "\r\n", 2)) {
+      ++it;
+    } else {
+      close(*it);
+      it = clients_.erase(it);
+      SPDLOG_INFO("Debug view client disconnected.");
+    }
+  }
+  client_count_ = clients_.size();
+}
+
+void DebugView::RenderThread() {
+  /* 只在 CPU 空闲时运行，不和瞄准抢占 */
+  sched_param param{};
+  param.sched_priority = 0;
+  if (pthread_setschedparam(pthread_self(), SCHED_IDLE, &param) != 0)
+    SPDLOG_WARN("Can not set SCHED_IDLE for debug view.");
+
+  while (running_) {
+    if (sink_ == Sink::kMJPEG) AcceptClients();
+
+    cv::Mat frame;
+    draw::DrawList list;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      if (!signal_.wait_for(lock, kIDLE_WAIT, [this] { return fresh_; }))
+        continue;
+      frame = frame_;
+      std::swap(list, list_);
+      frame_.release();
+      fresh_ = false;
+    }
+
+    if (!Active() || frame.empty()) continue;
+
+    cv::Mat canvas = frame.clone();
+    list.Render(canvas);
+    Serve(canvas);
+  }
+}
+
+DebugView::DebugView(const std::string &window_name)
+    : sink_(Sink::kWINDOW), window_name_(window_name) {
+  running_ = true;
+  thread_ = std::thread(&DebugView::RenderThread, this);
+  SPDLOG_TRACE("Constructed.");
+}
+
+DebugView::DebugView(unsigned short port) : sink_(Sink::kMJPEG) {
+  if (OpenServer(port)) {
+    running_ = true;
+    thread_ = std::thread(&DebugView::RenderThread, this);
+  }
+  SPDLOG_TRACE("Constructed.");
+}
+
+DebugView::~DebugView() {
+  running_ = false;
+  if (thread_.joinable()) thread_.join();
+  for (int fd : clients_) close(fd);
+  if (server_fd_ >= 0) close(server_fd_);
+  SPDLOG_TRACE("Destructed.");
+}
+
+bool DebugView::Active() const {
+  if (!running_) return false;
+  return sink_ == Sink::kWINDOW || client_count_ > 0;
+}
+
+void DebugView::Publish(const cv::Mat &frame, draw::DrawList &&list) {
+  if (!Active()) return;
+
+  /* 渲染线程正在取数据时直接放弃这一帧 */
+  std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+  if (!lock.owns_lock()) return;
+  frame_ = frame;
+  list_ = std::move(list);
+  fresh_ = true;
+  lock.unlock();
+  signal_.notify_one();
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "object.hpp"
+#include "opencv2/opencv.hpp"
+
+namespace draw {
+
+/**
+ * @brief 绘制列表
+ * 只记录要画的图元，由渲染线程在帧上统一绘制，生产者不直接操作图像
+ *
+ */
+class DrawList {
+ private:
+  struct Polygon {
+    std::vector<cv::Point2f> vertices;
+    cv::Scalar color;
+  };
+  struct Marker {
+    cv::Point2f point;
+    cv::Scalar color;
+    cv::MarkerTypes type;
+  };
+  struct Label {
+    std::string text;
+    int level;
+    cv::Scalar color;
+  };
+
+  std::vector<Polygon> polygons_;
+  std::vector<Marker> markers_;
+  std::vector<Label> labels_;
+
+ public:
+  void AddPolygon(const std::vector<cv::Point2f> &vertices,
+                  const cv::Scalar &color = kGREEN);
+  void AddMarker(const cv::Point2f &point, const cv::Scalar &color = kGREEN,
+                 cv::MarkerTypes type = cv::MarkerTypes::MARKER_CROSS);
+  void AddLabel(const std::string &text, int level = 1,
+                const cv::Scalar &color = kGREEN);
+  void AddObject(const ImageObject &object, const cv::Scalar &color = kGREEN);
+
+  void Render(const cv::Mat &output) const;
+  bool Empty() const;
+  void Clear();
+};
+
+}  // namespace draw
+
+/**
+ * @brief 调试画面服务
+ * 生产者发布帧和绘制列表后立即返回，低优先级线程负责绘制并输出到窗口，
+ * 或在本机端口上以 MJPEG 流提供给浏览器查看；没有观看者时不进行绘制
+ *
+ */
+class DebugView {
+ public:
+  enum class Sink {
+    kWINDOW,
+    kMJPEG,
+  };
+
+ private:
+  Sink sink_;
+  std::string window_name_;
+  int server_fd_ = -1;
+  std::vector<int> clients_;
+  std::atomic<std::size_t> client_count_{0};
+
+  std::thread thread_;
+  std::atomic<bool> running_{false};
+  std::mutex mutex_;
+  std::condition_variable signal_;
+  cv::Mat frame_;
+  draw::DrawList list_;
+  bool fresh_ = false;
+
+  bool OpenServer(unsigned short port);
+  void AcceptClients();
+  void Serve(const cv::Mat &image);
+  void RenderThread();
+
+ public:
+  /**
+   * @brief 输出到窗口
+   *
+   * @param window_name 窗口名
+   */
+  explicit DebugView(const std::string &window_name = "debug");
+
+  /**
+   * @brief 在 127.0.0.1:port 提供 MJPEG 流
+   *
+   * @param port 端口号
+   */
+  explicit DebugView(unsigned short port);
+  ~DebugView();
+
+  /**
+   * @brief 是否有人在看，没有时生产者可以跳过构建绘制列表
+   *
+   * @return true 有观看者
+   * @return false 没有观看者
+   */
+  bool Active() const;
+
+  /**
+   * @brief 发布一帧，不阻塞；渲染线程繁忙时直接丢弃
+   *
+   * @param frame 原图，发布后不应再被写入
+   * @param list 绘制列表
+   */
+  void Publish(const cv::Mat &frame, draw::DrawList &&list);
+};
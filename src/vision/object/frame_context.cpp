@@ -0,0 +1,124 @@
+#include "frame_context.hpp"
+
+#include "opencv2/opencv.hpp"
+#include "spdlog/spdlog.h"
+
+FrameContext::FrameContext() { SPDLOG_TRACE("Constructed."); }
+
+FrameContext::FrameContext(const cv::Mat &frame, const cv::Point2f &origin) {
+  SetFrame(frame, origin);
+  SPDLOG_TRACE("Constructed.");
+}
+
+FrameContext::~FrameContext() { SPDLOG_TRACE("Destructed."); }
+
+void FrameContext::SetFrame(const cv::Mat &frame, const cv::Point2f &origin) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  frame_ = frame;
+  origin_ = origin;
+
+  channels_.clear();
+  for (auto &diff : color_diff_) diff.release();
+  gray_.release();
+  face_gray_.release();
+  hsv_.release();
+  resized_.release();
+  pyramid_.clear();
+}
+
+const cv::Mat &FrameContext::Frame() const { return frame_; }
+
+const cv::Point2f &FrameContext::Origin() const { return origin_; }
+
+const std::vector<cv::Mat> &FrameContext::Channels() {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  if (channels_.empty() && !frame_.empty()) cv::split(frame_, channels_);
+  return channels_;
+}
+
+const cv::Mat &FrameContext::ColorDiff(game::Team team) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  if (team != game::Team::kBLUE && team != game::Team::kRED) {
+    SPDLOG_ERROR("team is {}", game::ToString(team));
+    return empty_;
+  }
+
+  auto &diff = color_diff_[team == game::Team::kBLUE ? 0 : 1];
+  if (diff.empty()) {
+    const auto &channels = Channels();
+    if (channels.size() < 3) return empty_;
+    if (team == game::Team::kBLUE)
+      cv::subtract(channels[0], channels[2], diff);
+    else
+      cv::subtract(channels[2], channels[0], diff);
+  }
+  return diff;
+}
+
+cv::Mat FrameContext::ColorDiff(game::Team team, const cv::Rect &roi) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  if (team != game::Team::kBLUE && team != game::Team::kRED) {
+    SPDLOG_ERROR("team is {}", game::ToString(team));
+    return cv::Mat();
+  }
+
+  const auto &cached = color_diff_[team == game::Team::kBLUE ? 0 : 1];
+  if (!cached.empty()) return cached(roi);
+  if (frame_.channels() < 3) return cv::Mat();
+
+  std::vector<cv::Mat> channels;
+  cv::split(frame_(roi), channels);
+  cv::Mat diff;
+  if (team == game::Team::kBLUE)
+    cv::subtract(channels[0], channels[2], diff);
+  else
+    cv::subtract(channels[2], channels[0], diff);
+  return diff;
+}
+
+const cv::Mat &FrameContext::Gray() {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  if (gray_.empty() && !frame_.empty()) {
+    if (frame_.channels() == 1)
+      gray_ = frame_;
+    else
+      cv::cvtColor(frame_, gray_, cv::COLOR_BGR2GRAY);
+  }
+  return gray_;
+}
+
+const cv::Mat &FrameContext::FaceGray() {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  if (face_gray_.empty() && !frame_.empty()) {
+    if (frame_.channels() == 1)
+      face_gray_ = frame_;
+    else
+      cv::cvtColor(frame_, face_gray_, cv::COLOR_RGB2GRAY);
+  }
+  return face_gray_;
+}
+
+const cv::Mat &FrameContext::HSV() {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  if (hsv_.empty() && !frame_.empty())
+    cv::cvtColor(frame_, hsv_, cv::COLOR_BGR2HSV);
+  return hsv_;
+}
+
+const cv::Mat &FrameContext::Pyramid(std::size_t level) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  if (pyramid_.empty()) pyramid_.emplace_back(frame_);
+  while (pyramid_.size() <= level) {
+    cv::Mat down;
+    cv::pyrDown(pyramid_.back(), down);
+    pyramid_.emplace_back(down);
+  }
+  return pyramid_[level];
+}
+
+const cv::Mat &FrameContext::Resized(const cv::Size &size) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  if (frame_.size() == size) return frame_;
+  if (resized_.size() != size) cv::resize(frame_, resized_, size);
+  return resized_;
+}
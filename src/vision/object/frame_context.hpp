@@ -0,0 +1,104 @@
+#pragma once
+
+#include <array>
+#include <mutex>
+#include <vector>
+
+#include "common.hpp"
+#include "opencv2/opencv.hpp"
+
+/**
+ * @brief 单帧上下文
+ * 持有当前帧，并在第一次请求时计算、缓存派生图像，
+ * 同一帧内的检测器、分类器和录像共享这些结果，避免重复转换
+ *
+ */
+class FrameContext {
+ private:
+  cv::Mat frame_;
+  cv::Point2f origin_;
+
+  std::vector<cv::Mat> channels_;
+  std::array<cv::Mat, 2> color_diff_;
+  cv::Mat gray_, face_gray_, hsv_, resized_, empty_;
+  std::vector<cv::Mat> pyramid_;
+
+  std::recursive_mutex mutex_;
+
+ public:
+  FrameContext();
+
+  /**
+   * @brief Construct a new FrameContext object
+   *
+   * @param frame 原图（BGR）
+   * @param origin 原图左上角在整幅传感器图像中的坐标
+   */
+  explicit FrameContext(const cv::Mat &frame,
+                        const cv::Point2f &origin = cv::Point2f(0., 0.));
+  ~FrameContext();
+
+  /**
+   * @brief 更换帧并清空所有缓存
+   *
+   * @param frame 原图（BGR）
+   * @param origin 原图左上角在整幅传感器图像中的坐标
+   */
+  void SetFrame(const cv::Mat &frame,
+                const cv::Point2f &origin = cv::Point2f(0., 0.));
+
+  const cv::Mat &Frame() const;
+  const cv::Point2f &Origin() const;
+
+  /**
+   * @brief B、G、R 三个通道
+   *
+   * @return const std::vector<cv::Mat>& 通道图
+   */
+  const std::vector<cv::Mat> &Channels();
+
+  /**
+   * @brief 指定队伍颜色的差分图，蓝色为 B - R，红色为 R - B
+   *
+   * @param team 需要提取的颜色
+   * @return const cv::Mat& 差分图，队伍未知时为空
+   */
+  const cv::Mat &ColorDiff(game::Team team);
+
+  /**
+   * @brief 只计算局部区域的差分图，用于跟踪时的小窗口搜索
+   * 全图差分已缓存时直接截取，否则只转换区域内的像素，结果不缓存
+   *
+   * @param team 需要提取的颜色
+   * @param roi 区域，需在画面内
+   * @return cv::Mat 区域差分图，队伍未知时为空
+   */
+  cv::Mat ColorDiff(game::Team team, const cv::Rect &roi);
+
+  const cv::Mat &Gray();
+
+  /**
+   * @brief 提取装甲板图案用的灰度图
+   * 分类器训练时按 RGB2GRAY 的权重处理 BGR 原图，这里保持一致
+   *
+   * @return const cv::Mat& 灰度图
+   */
+  const cv::Mat &FaceGray();
+  const cv::Mat &HSV();
+
+  /**
+   * @brief 降采样金字塔
+   *
+   * @param level 层数，0 层为原图，每层边长减半
+   * @return const cv::Mat& 对应层图像
+   */
+  const cv::Mat &Pyramid(std::size_t level);
+
+  /**
+   * @brief 缩放到指定尺寸的图像，仅缓存最近一次请求的尺寸
+   *
+   * @param size 目标尺寸
+   * @return const cv::Mat& 缩放后图像
+   */
+  const cv::Mat &Resized(const cv::Size &size);
+};
@@ -18,6 +18,11 @@ double ImageObject::ImageAngle() const { return image_angle_; }
 
 double ImageObject::ImageAspectRatio() const { return image_ratio_; }
 
+void ImageObject::Translate(const cv::Point2f &offset) {
+  for (auto &vertex : image_vertices_) vertex += offset;
+  image_center_ += offset;
+}
+
 void ImageObject::VisualizeObject(const cv::Mat &output, bool add_lable,
                                   const cv::Scalar color,
                                   cv::MarkerTypes type) {
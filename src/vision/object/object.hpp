@@ -37,6 +37,13 @@ class ImageObject {
 
   double ImageAspectRatio() const;
 
+  /**
+   * @brief 平移图像坐标，用于把感兴趣区域内的坐标映射回整幅图像
+   *
+   * @param offset 偏移量
+   */
+  virtual void Translate(const cv::Point2f &offset);
+
   void VisualizeObject(const cv::Mat &output, bool add_lable,
                        const cv::Scalar color = draw::kGREEN,
                        cv::MarkerTypes type = cv::MarkerTypes::MARKER_DIAMOND);
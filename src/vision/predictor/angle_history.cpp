@@ -0,0 +1,89 @@
+#include "angle_history.hpp"
+
+#include <cmath>
+
+namespace {
+
+const double kBLADE_STEP = 2. * M_PI / 5.;
+const double kJUMP_TH = 0.5; /* 帧间角度变化超过此值视为切换扇叶 */
+const std::size_t kMIN_SAMPLES = 10; /* 判断方向所需的最少样本 */
+const double kMIN_SPEED = 0.1;       /* 判断方向所需的最低平均转速 */
+
+}  // namespace
+
+void AngleHistory::Accumulate(const Sample &sample, double sign) {
+  const double t = sample.t - start_;
+  sum_t_ += sign * t;
+  sum_tt_ += sign * t * t;
+  sum_omega_ += sign * sample.omega;
+  sum_t_omega_ += sign * t * sample.omega;
+}
+
+void AngleHistory::Reset() {
+  head_ = size_ = 0;
+  has_angle_ = false;
+  theta_ = 0.;
+  sum_t_ = sum_tt_ = sum_omega_ = sum_t_omega_ = 0.;
+}
+
+void AngleHistory::Push(double t, double angle) {
+  if (!has_angle_) {
+    has_angle_ = true;
+    start_ = last_t_ = t;
+    last_angle_ = angle;
+    return;
+  }
+  if (t <= last_t_) return;
+
+  double delta = std::remainder(angle - last_angle_, 2. * M_PI);
+  /* 击中后目标换到另一片扇叶，扣除整数片扇叶的角度 */
+  if (std::abs(delta) > kJUMP_TH)
+    delta -= std::round(delta / kBLADE_STEP) * kBLADE_STEP;
+  theta_ += delta;
+
+  const Sample sample{t, theta_, delta / (t - last_t_)};
+  last_t_ = t;
+  last_angle_ = angle;
+
+  if (size_ == kCAPACITY) {
+    Accumulate(samples_[head_], -1.);
+    samples_[head_] = sample;
+    head_ = (head_ + 1) % kCAPACITY;
+  } else {
+    samples_[(head_ + size_) % kCAPACITY] = sample;
+    ++size_;
+  }
+  Accumulate(sample, 1.);
+}
+
+std::size_t AngleHistory::Size() const { return size_; }
+
+bool AngleHistory::Ready() const { return size_ >= kMIN_SAMPLES; }
+
+double AngleHistory::Theta() const { return theta_; }
+
+double AngleHistory::Time() const { return last_t_; }
+
+double AngleHistory::MeanSpeed() const {
+  return size_ > 0 ? sum_omega_ / size_ : 0.;
+}
+
+double AngleHistory::Acceleration() const {
+  const double denom = size_ * sum_tt_ - sum_t_ * sum_t_;
+  if (size_ < 2 || std::abs(denom) < 1e-9) return 0.;
+  return (size_ * sum_t_omega_ - sum_t_ * sum_omega_) / denom;
+}
+
+double AngleHistory::Speed() const {
+  if (size_ < 2) return MeanSpeed();
+  const double mean_t = sum_t_ / size_;
+  return MeanSpeed() + Acceleration() * (last_t_ - start_ - mean_t);
+}
+
+component::Direction AngleHistory::GetDirection() const {
+  if (!Ready()) return component::Direction::kUNKNOWN;
+  const double speed = MeanSpeed();
+  if (speed > kMIN_SPEED) return component::Direction::kCCW;  // 逆时针
+  if (speed < -kMIN_SPEED) return component::Direction::kCW;  // 顺时针
+  return component::Direction::kUNKNOWN;
+}
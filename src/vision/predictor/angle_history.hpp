@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include "common.hpp"
+
+/**
+ * @brief 能量机关扇叶角度历史
+ * 固定容量的环形缓冲区，保存带时间戳的展开角度和角速度。
+ * 入队时同步更新累加和，方向、平均转速和角加速度都是 O(1) 得到
+ *
+ */
+class AngleHistory {
+ public:
+  static constexpr std::size_t kCAPACITY = 64;
+
+ private:
+  struct Sample {
+    double t;
+    double theta;
+    double omega;
+  };
+
+  std::array<Sample, kCAPACITY> samples_;
+  std::size_t head_ = 0; /* 最早样本的位置 */
+  std::size_t size_ = 0;
+
+  bool has_angle_ = false;
+  double start_ = 0.;
+  double last_t_ = 0.;
+  double last_angle_ = 0.;
+  double theta_ = 0.;
+
+  /* 以 start_ 为零点的时间，用于角速度对时间的线性回归 */
+  double sum_t_ = 0.;
+  double sum_tt_ = 0.;
+  double sum_omega_ = 0.;
+  double sum_t_omega_ = 0.;
+
+  void Accumulate(const Sample &sample, double sign);
+
+ public:
+  void Reset();
+
+  /**
+   * @brief 添加一次观测
+   * 角度在内部展开，击中后切换扇叶造成的 72° 跳变会被扣除
+   *
+   * @param t 时间，单位秒
+   * @param angle 扇叶角度，单位弧度
+   */
+  void Push(double t, double angle);
+
+  std::size_t Size() const;
+  bool Ready() const;
+
+  /**
+   * @brief 最新的展开角度，可直接用于转速拟合
+   *
+   * @return double 角度，单位弧度
+   */
+  double Theta() const;
+  double Time() const;
+
+  double MeanSpeed() const;
+  double Acceleration() const;
+
+  /**
+   * @brief 由角速度回归直线外推到最新时刻的转速
+   *
+   * @return double 转速，单位弧度每秒
+   */
+  double Speed() const;
+  component::Direction GetDirection() const;
+};
@@ -2,17 +2,58 @@
 
 #include <execution>
 
+namespace {
+
+const double kT = 0.03; /* 没有上一帧时的默认帧间隔 */
+
+}  // namespace
+
+void ArmorPredictor::SelectTarget() {
+  /* 当前目标仍被确认时保持不变，避免在目标之间来回切换 */
+  const ArmorTracker::Track *target = filter_.Find(target_id_);
+  if (target != nullptr && target->state == ArmorTracker::State::kCONFIRMED)
+    return;
+
+  /* 按装甲板优先级选择第一个已确认的跟踪 */
+  for (std::size_t i = 0; i < armors_.size(); ++i) {
+    const ArmorTracker::Track *track = filter_.Find(filter_.TrackOf(i));
+    if (track != nullptr && track->state == ArmorTracker::State::kCONFIRMED) {
+      if (track->id != target_id_)
+        SPDLOG_DEBUG("Target switched from {} to {}.", target_id_, track->id);
+      target_id_ = track->id;
+      return;
+    }
+  }
+
+  /* 没有其他可选目标时，丢失的目标继续外推 */
+  if (target == nullptr) target_id_ = -1;
+}
+
 void ArmorPredictor::MatchArmor() {
   duration_predict_.Start();
 
-  cv::Point2d center = armor_.ImageCenter();
-  cv::Size2d size = armor_.GetRect().size;
-  cv::Point2d predict_pt = filter_.Predict(center);
-  cv::RotatedRect rect(predict_pt, size, armor_.GetRect().angle);
-
-  Armor armor(rect);
-  armor.SetModel(armor_.GetModel());
-  predicts_.emplace_back(armor);
+  filter_.Update(armors_, dt_);
+  if (target_id_ < 0 && !armors_.empty() && !locking_) {
+    duration_lock_.Start();
+    locking_ = true;
+  }
+  SelectTarget();
+
+  const ArmorTracker::Track *target = filter_.Find(target_id_);
+  if (target != nullptr) {
+    /* 从看到装甲板到给出第一个预测的时间 */
+    if (locking_) {
+      duration_lock_.Calc("Lock Target");
+      locking_ = false;
+    }
+
+    const cv::RotatedRect last = target->armor.GetRect();
+    cv::RotatedRect rect(target->Position(), last.size, last.angle);
+
+    Armor armor(rect);
+    armor.SetModel(target->armor.GetModel());
+    predicts_.emplace_back(armor);
+  }
 
   duration_predict_.Calc("Predict Armor");
 }
@@ -39,21 +80,33 @@ bool ArmorPredictor::PrepareParams(const std::string &params_path) {
   }
 }
 
-ArmorPredictor::ArmorPredictor() { SPDLOG_TRACE("Constructed."); }
+ArmorPredictor::ArmorPredictor() : dt_(kT) { SPDLOG_TRACE("Constructed."); }
 
-ArmorPredictor::ArmorPredictor(const std::string &param) {
+ArmorPredictor::ArmorPredictor(const std::string &param) : dt_(kT) {
   LoadParams(param);
   SPDLOG_TRACE("Constructed.");
 }
 
 ArmorPredictor::~ArmorPredictor() { SPDLOG_TRACE("Destructed."); }
 
-void ArmorPredictor::SetArmor(const Armor &armor) { armor_ = armor; }
+void ArmorPredictor::SetArmor(const Armor &armor,
+                              std::chrono::steady_clock::time_point stamp) {
+  SetArmors({armor}, stamp);
+}
 
-void ArmorPredictor::SetArmors(const tbb::concurrent_vector<Armor> &armors) {
+void ArmorPredictor::SetArmors(const tbb::concurrent_vector<Armor> &armors,
+                               std::chrono::steady_clock::time_point stamp) {
   armors_ = armors;
+
+  /* 时间戳不递增时沿用上一次的帧间隔 */
+  if (stamped_ && stamp > stamp_)
+    dt_ = std::chrono::duration<double>(stamp - stamp_).count();
+  if (!stamped_ || stamp > stamp_) stamp_ = stamp;
+  stamped_ = true;
 }
 
+int ArmorPredictor::GetTargetId() const { return target_id_; }
+
 const tbb::concurrent_vector<Armor> &ArmorPredictor::Predict() {
   predicts_.clear();
   MatchArmor();
@@ -73,5 +126,7 @@ void ArmorPredictor::VisualizePrediction(const cv::Mat &output, int verbose) {
     std::string label =
         cv::format("Find predict in %ld ms.", duration_predict_.Count());
     draw::VisualizeLabel(output, label, 3);
+    label = cv::format("Locked target in %ld ms.", duration_lock_.Count());
+    draw::VisualizeLabel(output, label, 4);
   }
 }
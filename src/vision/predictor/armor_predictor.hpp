@@ -5,7 +5,7 @@
 
 #include "armor.hpp"
 #include "armor_detector.hpp"
-#include "kalman.hpp"
+#include "armor_tracker.hpp"
 #include "predictor.hpp"
 #include "timer.hpp"
 
@@ -14,12 +14,24 @@ struct ArmorPredictParam {
   double b;
 };
 
-class ArmorPredictor : public Predictor<Armor, ArmorPredictParam, Kalman> {
+/**
+ * @brief 装甲板预测
+ * filter_ 跟踪画面中所有装甲板，只在已确认的跟踪中选择目标，
+ * 切换目标时新目标的滤波器已经收敛
+ *
+ */
+class ArmorPredictor
+    : public Predictor<Armor, ArmorPredictParam, ArmorTracker> {
  private:
-  Armor armor_;
-  tbb::concurrent_vector<Armor> armors_;
-  component::Timer duration_direction_, duration_predict_;
+  tbb::concurrent_vector<Armor> armors_; /* 按优先级排序的本帧装甲板 */
+  int target_id_ = -1;
+  bool locking_ = false; /* 看到装甲板但尚未给出预测 */
+  std::chrono::steady_clock::time_point stamp_; /* 本帧时间戳 */
+  bool stamped_ = false;
+  double dt_; /* 与上一帧的间隔 */
+  component::Timer duration_direction_, duration_predict_, duration_lock_;
 
+  void SelectTarget();
   void MatchArmor();
 
   void InitDefaultParams(const std::string &path);
@@ -30,8 +42,24 @@ class ArmorPredictor : public Predictor<Armor, ArmorPredictParam, Kalman> {
   explicit ArmorPredictor(const std::string &param);
   ~ArmorPredictor();
 
-  void SetArmor(const Armor &armor);
-  void SetArmors(const tbb::concurrent_vector<Armor> &armors);
+  /**
+   * @brief 设置本帧装甲板
+   *
+   * @param stamp 帧时间戳，与上一帧之差作为跟踪器的时间步长
+   */
+  void SetArmor(const Armor &armor,
+                std::chrono::steady_clock::time_point stamp =
+                    std::chrono::steady_clock::now());
+  void SetArmors(const tbb::concurrent_vector<Armor> &armors,
+                 std::chrono::steady_clock::time_point stamp =
+                     std::chrono::steady_clock::now());
+
+  /**
+   * @brief 当前目标的跟踪编号
+   *
+   * @return int 没有目标时为 -1
+   */
+  int GetTargetId() const;
 
   const tbb::concurrent_vector<Armor> &Predict();
 
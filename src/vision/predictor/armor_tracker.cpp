@@ -0,0 +1,142 @@
+#include "armor_tracker.hpp"
+
+#include <algorithm>
+#include <tuple>
+
+#include "spdlog/spdlog.h"
+
+namespace {
+
+const double kPROCESS_NOISE = 1e4;     /* 像素加速度的功率谱密度 */
+const double kMEASUREMENT_NOISE = 4.;  /* 像素观测方差 */
+const double kVELOCITY_VARIANCE = 1e6; /* 初始速度方差 */
+
+ArmorTracker::Filter::Measurement Measure(const Armor &armor) {
+  const cv::Point2f &center = armor.ImageCenter();
+  return ArmorTracker::Filter::Measurement(center.x, center.y);
+}
+
+/* 两个装甲板都已分类时型号必须一致 */
+bool Compatible(const Armor &armor1, const Armor &armor2) {
+  return armor1.GetModel() == game::Model::kUNKNOWN ||
+         armor2.GetModel() == game::Model::kUNKNOWN ||
+         armor1.GetModel() == armor2.GetModel();
+}
+
+}  // namespace
+
+cv::Point2d ArmorTracker::Track::Position() const {
+  const auto &x = filter.GetState();
+  return cv::Point2d(x(0), x(2));
+}
+
+cv::Point2d ArmorTracker::Track::Velocity() const {
+  const auto &x = filter.GetState();
+  return cv::Point2d(x(1), x(3));
+}
+
+void ArmorTracker::Associate(const tbb::concurrent_vector<Armor> &armors) {
+  /* 门限内的候选按代价从小到大贪心分配 */
+  std::vector<std::tuple<double, std::size_t, std::size_t>> candidates;
+  for (std::size_t t = 0; t < tracks_.size(); ++t) {
+    for (std::size_t i = 0; i < armors.size(); ++i) {
+      if (!Compatible(tracks_[t].armor, armors[i])) continue;
+      const double cost = tracks_[t].filter.Mahalanobis(Measure(armors[i]));
+      if (cost < gate_) candidates.emplace_back(cost, t, i);
+    }
+  }
+  std::sort(candidates.begin(), candidates.end());
+
+  std::vector<bool> assigned(tracks_.size(), false);
+  for (const auto &[cost, t, i] : candidates) {
+    if (assigned[t] || matches_[i] >= 0) continue;
+    assigned[t] = true;
+
+    Track &track = tracks_[t];
+    matches_[i] = track.id;
+    track.filter.Update(Measure(armors[i]));
+    track.armor = armors[i];
+    track.missed = 0;
+    ++track.hits;
+    if (track.state == State::kLOST || track.hits >= confirm_hits_)
+      track.state = State::kCONFIRMED;
+  }
+
+  for (std::size_t t = 0; t < tracks_.size(); ++t) {
+    if (assigned[t]) continue;
+    Track &track = tracks_[t];
+    ++track.missed;
+    if (track.state == State::kCONFIRMED) track.state = State::kLOST;
+  }
+}
+
+void ArmorTracker::Spawn(const Armor &armor, double dt) {
+  /* 第一帧只知道位置，速度的不确定度给大 */
+  const auto z = Measure(armor);
+  Filter::State x;
+  x << z(0), 0., z(1), 0.;
+  Filter::State variance;
+  variance << kMEASUREMENT_NOISE, kVELOCITY_VARIANCE, kMEASUREMENT_NOISE,
+      kVELOCITY_VARIANCE;
+
+  Track track;
+  track.id = next_id_++;
+  track.armor = armor;
+  Model::Configure(track.filter, dt, kPROCESS_NOISE, kMEASUREMENT_NOISE);
+  track.filter.Init(x, variance.asDiagonal());
+  if (track.hits >= confirm_hits_) track.state = State::kCONFIRMED;
+  tracks_.emplace_back(track);
+}
+
+ArmorTracker::ArmorTracker(double gate, int confirm_hits, int max_missed)
+    : gate_(gate), confirm_hits_(confirm_hits), max_missed_(max_missed) {
+  SPDLOG_TRACE("Constructed.");
+}
+
+ArmorTracker::~ArmorTracker() { SPDLOG_TRACE("Destructed."); }
+
+void ArmorTracker::Update(const tbb::concurrent_vector<Armor> &armors,
+                          double dt) {
+  for (auto &track : tracks_) {
+    Model::Configure(track.filter, dt, kPROCESS_NOISE, kMEASUREMENT_NOISE);
+    track.filter.Predict();
+  }
+
+  matches_.assign(armors.size(), -1);
+  Associate(armors);
+
+  /* 未确认的跟踪一旦丢失即删除，确认过的外推一段时间 */
+  tracks_.erase(std::remove_if(tracks_.begin(), tracks_.end(),
+                               [&](const Track &track) {
+                                 if (track.missed == 0) return false;
+                                 return track.state == State::kTENTATIVE ||
+                                        track.missed > max_missed_;
+                               }),
+                tracks_.end());
+
+  for (std::size_t i = 0; i < armors.size(); ++i) {
+    if (matches_[i] >= 0) continue;
+    Spawn(armors[i], dt);
+    matches_[i] = tracks_.back().id;
+  }
+  SPDLOG_DEBUG("{} tracks.", tracks_.size());
+}
+
+int ArmorTracker::TrackOf(std::size_t i) const {
+  return i < matches_.size() ? matches_[i] : -1;
+}
+
+const ArmorTracker::Track *ArmorTracker::Find(int id) const {
+  for (const auto &track : tracks_)
+    if (track.id == id) return &track;
+  return nullptr;
+}
+
+const std::vector<ArmorTracker::Track> &ArmorTracker::GetTracks() const {
+  return tracks_;
+}
+
+void ArmorTracker::Clear() {
+  tracks_.clear();
+  matches_.clear();
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <vector>
+
+#include "armor.hpp"
+#include "kalman_t.hpp"
+#include "opencv2/opencv.hpp"
+#include "tbb/concurrent_vector.h"
+
+/**
+ * @brief 多目标装甲板跟踪
+ * 每个装甲板有独立的滤波器和稳定的编号。每帧先预测所有跟踪，
+ * 再按马氏距离在门限内贪心关联。连续关联数帧后确认，
+ * 确认后的跟踪丢失时继续外推，重新关联时沿用原滤波器，不需要重新收敛
+ *
+ */
+class ArmorTracker {
+ public:
+  using Model = kalman::ConstantVelocity<2>;
+  using Filter = Model::Filter;
+
+  enum class State {
+    kTENTATIVE, /* 新出现，尚未确认 */
+    kCONFIRMED, /* 本帧关联成功 */
+    kLOST,      /* 确认过，本帧未关联 */
+  };
+
+  struct Track {
+    int id;
+    State state = State::kTENTATIVE;
+    Armor armor; /* 最近一次关联的装甲板 */
+    Filter filter;
+    int hits = 1;   /* 累计关联帧数 */
+    int missed = 0; /* 连续未关联的帧数 */
+
+    cv::Point2d Position() const;
+    cv::Point2d Velocity() const;
+  };
+
+ private:
+  std::vector<Track> tracks_;
+  std::vector<int> matches_; /* 每个装甲板关联的跟踪编号，-1 为未关联 */
+  int next_id_ = 0;
+
+  double gate_;
+  int confirm_hits_;
+  int max_missed_;
+
+  void Associate(const tbb::concurrent_vector<Armor> &armors);
+  void Spawn(const Armor &armor, double dt);
+
+ public:
+  /**
+   * @brief Construct a new Armor Tracker object
+   *
+   * @param gate 关联门限，马氏距离平方
+   * @param confirm_hits 确认所需的关联帧数
+   * @param max_missed 确认的跟踪最多外推的帧数
+   */
+  explicit ArmorTracker(double gate = 13.8, int confirm_hits = 2,
+                        int max_missed = 10);
+  ~ArmorTracker();
+
+  /**
+   * @brief 用本帧装甲板更新所有跟踪
+   *
+   * @param armors 本帧装甲板
+   * @param dt 距上一帧的时间，单位秒
+   */
+  void Update(const tbb::concurrent_vector<Armor> &armors, double dt);
+
+  /**
+   * @brief 本帧第 i 个装甲板关联的跟踪编号
+   *
+   * @param i 装甲板序号
+   * @return int 跟踪编号，未关联或已删除时为 -1
+   */
+  int TrackOf(std::size_t i) const;
+
+  /**
+   * @brief 按编号查找跟踪
+   *
+   * @param id 跟踪编号
+   * @return const Track* 不存在时为 nullptr
+   */
+  const Track *Find(int id) const;
+
+  const std::vector<Track> &GetTracks() const;
+  void Clear();
+};
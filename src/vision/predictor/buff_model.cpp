@@ -0,0 +1,221 @@
+#include "buff_model.hpp"
+
+#include <cmath>
+
+#include "spdlog/spdlog.h"
+
+namespace {
+
+const double kRADIUS = 700.;        /* R标到装甲板中心的距离，单位毫米 */
+const double kARMOR_LENGTH = 230.;  /* 与 Armor 中能量机关装甲板的尺寸一致 */
+const double kARMOR_WIDTH = 125.;
+
+const int kREFINE_INTERVAL = 30; /* 每隔多少帧重新解算一次平面位姿 */
+const double kPOSE_ALPHA = 0.2;  /* 位姿修正的平滑系数 */
+const double kRADIUS_ALPHA = 0.05;
+
+cv::Vec3d Ray(const cv::Point2f &point, const cv::Mat &cam_mat,
+              const cv::Mat &distor_coff) {
+  std::vector<cv::Point2f> out;
+  cv::undistortPoints(std::vector<cv::Point2f>{point}, out, cam_mat,
+                      distor_coff);
+  return cv::Vec3d(out.front().x, out.front().y, 1.);
+}
+
+}  // namespace
+
+/**
+ * @brief 求图像点的视线与转子平面的交点
+ *
+ * @param point 图像坐标
+ * @param plane_point 交点在平面坐标系下的坐标
+ * @return true 视线与平面相交于相机前方
+ * @return false 视线与平面近似平行
+ */
+bool BuffModel::Intersect(const cv::Point2f &point,
+                          cv::Vec3d &plane_point) const {
+  const cv::Vec3d ray = Ray(point, cam_mat_, distor_coff_);
+  const cv::Vec3d normal(rot_(0, 2), rot_(1, 2), rot_(2, 2));
+  const double denom = normal.dot(ray);
+  if (std::abs(denom) < 1e-6) return false;
+
+  const double scale = normal.dot(center_) / denom;
+  if (scale <= 0.) return false;
+  plane_point = rot_.t() * (scale * ray - center_);
+  return true;
+}
+
+/**
+ * @brief 以R标和目标装甲板四个角点解算平面位姿
+ *
+ * @param buff 检测结果
+ * @param angle 目标扇叶在平面坐标系下的角度
+ * @param rot 平面坐标系到相机坐标系的旋转
+ * @param center R标在相机坐标系下的位置
+ * @return true 解算成功
+ * @return false 角点无法与模型对应
+ */
+bool BuffModel::SolvePose(const Buff &buff, double angle, cv::Matx33d &rot,
+                          cv::Vec3d &center) const {
+  /* 按径向和切向把图像角点与模型角点对应起来，不依赖 RotatedRect 的顶点顺序 */
+  const cv::Point2f target = buff.GetTarget().ImageCenter();
+  cv::Point2f radial = target - buff.GetCenter();
+  const double len = cv::norm(radial);
+  if (len < 1.) return false;
+  radial /= len;
+  const cv::Point2f tangent(-radial.y, radial.x);
+
+  std::vector<cv::Point2f> image_points(5);
+  std::vector<bool> filled(4, false);
+  for (const auto &vertex : buff.GetTarget().ImageVertices()) {
+    const cv::Point2f d = vertex - target;
+    const bool x = d.dot(tangent) > 0, y = d.dot(radial) < 0;
+    const int i = y ? (x ? 2 : 3) : (x ? 1 : 0);
+    if (filled[i]) return false;
+    filled[i] = true;
+    image_points[i] = vertex;
+  }
+  image_points[4] = buff.GetCenter();
+
+  std::vector<cv::Point3d> object_points = PlaneVertices(angle);
+  object_points.emplace_back(0., 0., 0.);
+
+  cv::Mat rot_vec, trans_vec;
+  if (!cv::solvePnP(object_points, image_points, cam_mat_, distor_coff_,
+                    rot_vec, trans_vec, false, cv::SOLVEPNP_ITERATIVE))
+    return false;
+
+  cv::Mat rot_mat;
+  cv::Rodrigues(rot_vec, rot_mat);
+  rot = cv::Matx33d(rot_mat);
+  center = cv::Vec3d(trans_vec);
+  return true;
+}
+
+/**
+ * @brief 装甲板四个角点在平面坐标系下的坐标
+ * 角点顺序与 Armor 中能量机关装甲板的物理坐标一致，装甲板的长边沿切向
+ *
+ * @param angle 扇叶角度
+ * @return std::vector<cv::Point3d> 角点
+ */
+std::vector<cv::Point3d> BuffModel::PlaneVertices(double angle) const {
+  const cv::Vec3d radial(std::cos(angle), std::sin(angle), 0.);
+  const cv::Vec3d tangent(-radial[1], radial[0], 0.);
+  const cv::Vec3d center = radius_ * radial;
+  const double x = kARMOR_LENGTH / 2., y = kARMOR_WIDTH / 2.;
+
+  std::vector<cv::Point3d> vertices;
+  for (const auto &v : {cv::Vec2d(-x, -y), cv::Vec2d(x, -y), cv::Vec2d(x, y),
+                        cv::Vec2d(-x, y)})
+    vertices.emplace_back(center + v[0] * tangent - v[1] * radial);
+  return vertices;
+}
+
+BuffModel::BuffModel() {
+  Reset();
+  SPDLOG_TRACE("Constructed.");
+}
+
+BuffModel::~BuffModel() { SPDLOG_TRACE("Destructed."); }
+
+void BuffModel::LoadCameraMat(const std::string &path) {
+  cv::FileStorage fs(path,
+                     cv::FileStorage::READ | cv::FileStorage::FORMAT_JSON);
+
+  if (fs.isOpened()) {
+    cam_mat_ = fs["cam_mat"].mat();
+    distor_coff_ = fs["distor_coff"].mat();
+    if (cam_mat_.empty() && distor_coff_.empty()) {
+      SPDLOG_ERROR("Can not load cali data.");
+    } else {
+      SPDLOG_DEBUG("Loaded cali data.");
+    }
+  } else {
+    SPDLOG_ERROR("Can not open file: '{}'", path);
+  }
+  Reset();
+}
+
+void BuffModel::Reset() {
+  rot_ = cv::Matx33d::eye();
+  center_ = cv::Vec3d();
+  radius_ = kRADIUS;
+  angle_ = 0.;
+  ready_ = false;
+  frames_ = 0;
+}
+
+bool BuffModel::Update(const Buff &buff) {
+  if (cam_mat_.empty()) return false;
+  const cv::Point2f target = buff.GetTarget().ImageCenter();
+
+  if (!ready_) {
+    const cv::Point2f rel = target - buff.GetCenter();
+    const double angle = std::atan2(rel.y, rel.x);
+    if (!SolvePose(buff, angle, rot_, center_)) return false;
+    angle_ = angle;
+    ready_ = true;
+    frames_ = 0;
+    SPDLOG_DEBUG("Buff plane at {}, {}, {}", center_[0], center_[1],
+                 center_[2]);
+    return true;
+  }
+
+  /* 云台转动时平面整体随相机转动，用R标的视线方向修正，保持距离不变 */
+  const cv::Vec3d from = cv::normalize(center_);
+  const cv::Vec3d to =
+      cv::normalize(Ray(buff.GetCenter(), cam_mat_, distor_coff_));
+  const cv::Vec3d axis = from.cross(to);
+  const double sin_turn = cv::norm(axis);
+  if (sin_turn > 1e-9) {
+    cv::Matx33d turn;
+    cv::Rodrigues(axis / sin_turn * std::atan2(sin_turn, from.dot(to)), turn);
+    center_ = turn * center_;
+    rot_ = turn * rot_;
+  }
+
+  cv::Vec3d point;
+  if (!Intersect(target, point)) return false;
+  angle_ = std::atan2(point[1], point[0]);
+  radius_ += kRADIUS_ALPHA * (std::hypot(point[0], point[1]) - radius_);
+
+  if (++frames_ >= kREFINE_INTERVAL) {
+    frames_ = 0;
+    cv::Matx33d rot;
+    cv::Vec3d center;
+    if (SolvePose(buff, angle_, rot, center)) {
+      cv::Vec3d delta;
+      cv::Rodrigues(rot * rot_.t(), delta);
+      cv::Matx33d step;
+      cv::Rodrigues(kPOSE_ALPHA * delta, step);
+      rot_ = step * rot_;
+      center_ += kPOSE_ALPHA * (center - center_);
+    }
+  }
+  return true;
+}
+
+bool BuffModel::Ready() const { return ready_; }
+
+double BuffModel::Angle() const { return angle_; }
+
+double BuffModel::Radius() const { return radius_; }
+
+Armor BuffModel::Predict(double angle) const {
+  cv::Vec3d rot_vec;
+  cv::Rodrigues(rot_, rot_vec);
+  std::vector<cv::Point2f> image_points;
+  cv::projectPoints(PlaneVertices(angle), rot_vec, center_, cam_mat_,
+                    distor_coff_, image_points);
+
+  Armor armor(cv::minAreaRect(image_points));
+  armor.SetModel(game::Model::kBUFF);
+
+  /* 装甲板坐标系：x 沿切向，y 指向R标，z 为平面法向 */
+  const double c = std::cos(angle), s = std::sin(angle);
+  const cv::Matx33d local(-s, -c, 0., c, -s, 0., 0., 0., 1.);
+  armor.SetRotMat(cv::Mat(rot_ * local));
+  armor.SetTransVec(cv::Mat(rot_ * (radius_ * cv::Vec3d(c, s, 0.)) + center_));
+  return armor;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "buff.hpp"
+#include "opencv2/opencv.hpp"
+
+/**
+ * @brief 能量机关转子平面模型
+ * 平面坐标系原点在R标，z轴为平面法向，装甲板中心位于半径 radius 的圆上。
+ * 首次观测时用一次 solvePnP 得到平面位姿，之后每帧只需把装甲板中心的视线
+ * 与平面求交得到扇叶角度，位姿和半径隔一段时间再缓慢修正
+ *
+ */
+class BuffModel {
+ private:
+  cv::Mat cam_mat_, distor_coff_;
+
+  cv::Matx33d rot_;   /* 平面坐标系到相机坐标系的旋转 */
+  cv::Vec3d center_;  /* R标在相机坐标系下的位置，单位毫米 */
+  double radius_;
+  double angle_ = 0.;
+  bool ready_ = false;
+  int frames_ = 0;
+
+  bool Intersect(const cv::Point2f &point, cv::Vec3d &plane_point) const;
+  bool SolvePose(const Buff &buff, double angle, cv::Matx33d &rot,
+                 cv::Vec3d &center) const;
+  std::vector<cv::Point3d> PlaneVertices(double angle) const;
+
+ public:
+  BuffModel();
+  ~BuffModel();
+
+  void LoadCameraMat(const std::string &path);
+  void Reset();
+
+  /**
+   * @brief 使用一帧的检测结果更新模型和当前扇叶角度
+   *
+   * @param buff 检测结果
+   * @return true 更新成功
+   * @return false 没有相机参数或几何退化
+   */
+  bool Update(const Buff &buff);
+
+  bool Ready() const;
+
+  /**
+   * @brief 当前扇叶角度，方向与图像坐标系中的旋转方向一致
+   *
+   * @return double 角度，单位弧度
+   */
+  double Angle() const;
+  double Radius() const;
+
+  /**
+   * @brief 构造扇叶转到指定角度时的装甲板，带有相机坐标系下的位姿
+   *
+   * @param angle 扇叶角度，单位弧度
+   * @return Armor 投影得到的装甲板
+   */
+  Armor Predict(double angle) const;
+};
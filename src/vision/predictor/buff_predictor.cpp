@@ -6,6 +6,7 @@
 #include "common.hpp"
 
 using std::chrono::high_resolution_clock;
+using std::chrono::steady_clock;
 
 namespace {
 
@@ -13,6 +14,18 @@ const double kRMUT_TIME = 90.;
 const double kRMUC_TIME = 420.;
 const double kDELTA = 3;  // 总延迟时间
 
+const double kPROCESS_NOISE = 1e4;     /* 像素加速度的功率谱密度 */
+const double kMEASUREMENT_NOISE = 4.;  /* 像素观测方差 */
+const double kVELOCITY_VARIANCE = 1e6; /* 初始速度方差 */
+const double kMAX_GAP = 0.5;           /* 中心丢失超过此时长后重新起始 */
+
+using CenterModel = kalman::ConstantVelocity<2>;
+using CenterFilter = CenterModel::Filter;
+
+double Seconds(steady_clock::duration duration) {
+  return std::chrono::duration<double>(duration).count();
+}
+
 }  // namespace
 
 /**
@@ -55,11 +68,8 @@ static double PredictIntegralRotatedAngle(double t) {
 void BuffPredictor::InitDefaultParams(const std::string &params_path) {
   cv::FileStorage fs(params_path,
                      cv::FileStorage::WRITE | cv::FileStorage::FORMAT_JSON);
-  SPDLOG_WARN("filter method: {}", game::ToString(filter_.method_));
-  if (filter_.method_ != component::FilterMethod::kUNKNOWN) {
-    fs << "delay_time" << 0.1542;
-    fs << "error_frame" << 5;
-  }
+  fs << "delay_time" << 0.1542;
+  fs << "error_frame" << 5;
   SPDLOG_DEBUG("Inited params.");
 }
 
@@ -82,45 +92,15 @@ bool BuffPredictor::PrepareParams(const std::string &params_path) {
  *
  */
 void BuffPredictor::MatchDirection() {
-  SPDLOG_WARN("Start MatchDirection");
+  SPDLOG_DEBUG("Start MatchDirection");
 
   if (direction_ == component::Direction::kUNKNOWN) {
     duration_direction_.Start();
-    cv::Point2f center = buff_.GetCenter();
-    double angle, sum = 0;
-    std::vector<double> angles;
-
-    for (auto point : circumference_) {
-      angle = CalRotatedAngle(point, center);
-      angles.emplace_back(angle);
-      SPDLOG_WARN("angle[i], {}", angle);
-    }
-
-    for (auto i = circumference_.size() - 1; i > circumference_.size() - 29;
-         i--) {
-      double delta = angles[i] - angles[i - 1];
-      if (std::abs(delta) > M_PI / 4) delta = 0;
-      SPDLOG_WARN("delta {}: {} - {} =  {},", i, angles[i], angles[i - 1],
-                  delta);
-      sum += delta;
-    }
-
-    if (sum > 0)
-      direction_ = component::Direction::kCCW;  // 逆时针
-    else if (sum == 0)
-      direction_ = component::Direction::kUNKNOWN;
-    else
-      direction_ = component::Direction::kCW;  // 顺时针
-
-    circumference_.emplace_back(buff_.GetTarget().ImageCenter());
-    SPDLOG_WARN(" sum is {}", sum);
-  } else if (circumference_.size() < 30) {
-    circumference_.emplace_back(buff_.GetTarget().ImageCenter());
-  } else {
-    circumference_.erase(circumference_.begin());
+    direction_ = history_.GetDirection();
+    SPDLOG_DEBUG("mean speed is {}", history_.MeanSpeed());
+    duration_direction_.Calc("Predict Direction");
   }
-  SPDLOG_WARN("Buff's Direction is {}", game::ToString(direction_));
-  duration_direction_.Calc("Predict Direction");
+  SPDLOG_DEBUG("Buff's Direction is {}", game::ToString(direction_));
 }
 
 /**
@@ -161,19 +141,37 @@ void BuffPredictor::MatchPredict() {
   if (component::Direction::kUNKNOWN == direction_) return;
   game::BuffState state = GetState();
   double theta = 0;
+  /* 预测时长为飞行时间加系统延迟和本帧已经过的时间 */
+  const double dt = flight_time_ + params_.delay_time +
+                    Seconds(steady_clock::now() - frame_time_);
   if (state == game::BuffState::kSMALL) {
     // theta = PredictIntegralRotatedAngle(2);
-    theta = 10;
-    theta = theta / 180 * CV_PI;
+    if (history_.Ready()) {
+      theta = std::abs(history_.MeanSpeed()) * dt;
+    } else {
+      theta = 10;
+      theta = theta / 180 * CV_PI;
+    }
   } else if (state == game::BuffState::kBIG) {
-    theta = std::abs(
-        CalRotatedAngle(filter_.Predict(buff_.GetTarget().ImageCenter()),
-                        buff_.GetCenter()) -
-        CalRotatedAngle(buff_.GetTarget().ImageCenter(), buff_.GetCenter()));
+    if (fitter_.Ready()) {
+      /* 对拟合的转速积分 */
+      theta =
+          std::abs(fitter_.Integrate(Seconds(frame_time_ - start_time_), dt));
+    } else {
+      /* 拟合完成前按当前转速和角加速度外推 */
+      theta = std::abs(history_.Speed() * dt +
+                       history_.Acceleration() * dt * dt / 2.);
+    }
   }
   if (direction_ == component::Direction::kCCW) theta = -theta;
-  Armor armor = RotateArmor(theta);
-  armor.SetModel(game::Model::kHERO);
+  Armor armor;
+  if (model_.Ready()) {
+    /* 在转子平面上转动后投影，同时带有装甲板的三维位姿 */
+    armor = model_.Predict(model_.Angle() + theta);
+  } else {
+    armor = RotateArmor(theta);
+    armor.SetModel(game::Model::kHERO);
+  }
   predicts_.emplace_back(armor);
   SPDLOG_WARN("Buff has been predicted. {}", game::ToString(direction_));
 
@@ -185,9 +183,7 @@ void BuffPredictor::MatchPredict() {
  *
  */
 BuffPredictor::BuffPredictor() {
-  std::vector<double> init_vec = {4., 2.};
-  filter_.Init(init_vec);
-  SPDLOG_DEBUG("filter init");
+  start_time_ = steady_clock::now();
   race_ = game::Race::kUNKNOWN;
   SetTime(-200);
   SPDLOG_TRACE("Constructed.");
@@ -197,40 +193,21 @@ BuffPredictor::BuffPredictor() {
  * @brief Construct a new Buff Predictor:: Buff Predictor object
  *
  * 1st. 初始化后不必修改
- *    1. filter 2. param
+ *    1. param
  * 2nd. 需要robot设置
- *    3. race   4. end_time
+ *    2. race   3. end_time
  * 3rd. 需要每帧更新
- *    5. buff   6. state    7.circumference
+ *    4. buff   5. state    6.history
+ *
+ * 滤波器在第一帧中心到来时起始，见 SmoothCenter
  *
  * @param param 参数文件路径
  */
 BuffPredictor::BuffPredictor(const std::string &param) {
   SPDLOG_WARN("Start construct");
-#if 0
-  //* 1. filter init
-  if (filter_.method_ == FilterMethod::kUNKNOWN) {
-    if (params_.is_EKF)
-      filter_.method_ = FilterMethod::kEKF;
-    else if (params_.is_KF)
-      filter_.method_ = FilterMethod::kKF;
-  }
-  SPDLOG_DEBUG("Filter method : {}", filter_.method_);
-  std::vector<double> init_vec;
-  if (filter_.method_ == FilterMethod::kKF) {
-    init_vec.push_back(4.);
-    init_vec.push_back(2.);
-  } else if (filter_.method_ == FilterMethod::kEKF) {
-    for (std::size_t i = 0; i < 5; i++) init_vec.push_back(0.);
-  }
-  filter_.Init(init_vec);
-  SPDLOG_DEBUG("Filter init");
-#else
-  //* 1st. filter init
-  std::vector<double> init_vec = {4., 2.};
-  filter_.Init(init_vec);
-  SPDLOG_INFO("Filter init");
-#endif
+  start_time_ = steady_clock::now();
+
+  //* 1st. param init
   LoadParams(param);
   SPDLOG_INFO("Param init");
 
@@ -242,7 +219,8 @@ BuffPredictor::BuffPredictor(const std::string &param) {
   //* 3rd. buff init
   state_ = game::BuffState::kUNKNOWN;
   buff_ = Buff();
-  circumference_.clear();
+  history_.Reset();
+  center_ready_ = false;
   SPDLOG_INFO("Buff init");
 
   SPDLOG_TRACE("Constructed.");
@@ -262,19 +240,69 @@ BuffPredictor::~BuffPredictor() { SPDLOG_TRACE("Destructed."); }
 void BuffPredictor::SetBuff(const Buff &buff) {
   state_ = GetState();
   buff_ = buff;
-  if (circumference_.size() < 5) {
-    circumference_.push_back(buff_.GetTarget().ImageCenter());
-    SPDLOG_DEBUG("Get Buff Center {},{} ", buff_.GetTarget().ImageCenter().x,
-                 buff_.GetTarget().ImageCenter().y);
+  const auto last_time = frame_time_;
+  frame_time_ = steady_clock::now();
+
+  if (cv::Point2f(0, 0) == buff_.GetCenter() ||
+      cv::Point2f(0, 0) == buff_.GetTarget().ImageCenter())
+    return;
+  SmoothCenter(Seconds(frame_time_ - last_time));
+
+  /* 每帧只计算一次角度，方向、转速和拟合都使用同一份展开后的历史 */
+  history_.Push(
+      Seconds(frame_time_ - start_time_),
+      CalRotatedAngle(buff_.GetTarget().ImageCenter(), buff_.GetCenter()));
+  if (state_ == game::BuffState::kBIG)
+    fitter_.AddSample(history_.Time(), history_.Theta());
+  model_.Update(buff_);
+}
+
+/**
+ * @brief 用匀速模型平滑能量机关中心，结果写回 buff_
+ * 中心在画面中只随云台运动，逐帧检测的抖动会直接变成角度噪声
+ *
+ * @param dt 距上一帧的时间，单位秒
+ */
+void BuffPredictor::SmoothCenter(double dt) {
+  const cv::Point2f &center = buff_.GetCenter();
+  const CenterFilter::Measurement z(center.x, center.y);
+
+  /* 第一帧或中断过久时只知道位置，速度的不确定度给大 */
+  if (!center_ready_ || dt > kMAX_GAP) {
+    CenterFilter::State x;
+    x << z(0), 0., z(1), 0.;
+    CenterFilter::State variance;
+    variance << kMEASUREMENT_NOISE, kVELOCITY_VARIANCE, kMEASUREMENT_NOISE,
+        kVELOCITY_VARIANCE;
+    filter_.Init(x, variance.asDiagonal());
+    center_ready_ = true;
+    return;
   }
+
+  CenterModel::Configure(filter_, dt, kPROCESS_NOISE, kMEASUREMENT_NOISE);
+  filter_.Predict();
+  const auto &x = filter_.Update(z);
+  buff_.SetCenter(cv::Point2f(x(0), x(2)));
+}
+
+/**
+ * @brief 清空角度历史和转速拟合，旋转模式或方向改变后旧的样本不再适用
+ *
+ */
+void BuffPredictor::ResetFit() {
+  history_.Reset();
+  fitter_.Reset();
 }
 
 void BuffPredictor::ChangeDirection(bool direction) {
+  const auto last = direction_;
   if (direction) {
     direction_ = component::Direction::kCW;
   } else {
     direction_ = component::Direction::kCCW;
   }
+  if (direction_ == last) return;
+  ResetFit();
   SPDLOG_CRITICAL("Direction changed, now : {}", game::ToString(direction_));
 }
 
@@ -286,6 +314,7 @@ void BuffPredictor::ChangeDirection(bool direction) {
 game::BuffState &BuffPredictor::GetState() {
   SPDLOG_DEBUG("{}, {}", game::ToString(race_), game::ToString(state_));
 
+  const game::BuffState last = state_;
   if (race_ == game::Race::kRMUT) {
     state_ = game::BuffState::kBIG;
   } else if (race_ == game::Race::kRMUC) {
@@ -298,6 +327,7 @@ game::BuffState &BuffPredictor::GetState() {
       state_ = game::BuffState::kBIG;
   }
 
+  if (state_ != last) ResetFit();
   SPDLOG_DEBUG("Now state : {}", game::ToString(state_));
   return state_;
 }
@@ -308,6 +338,7 @@ game::BuffState &BuffPredictor::GetState() {
  * @param state 当前能量机关旋转状态
  */
 void BuffPredictor::SetState(game::BuffState state) {
+  if (state != state_) ResetFit();
   state_ = state;
   SPDLOG_DEBUG("State has been set.");
 }
@@ -364,6 +395,24 @@ void BuffPredictor::SetRace(game::Race race) {
   SPDLOG_DEBUG("Race type : {}", game::ToString(race));
 }
 
+/**
+ * @brief 加载相机参数，用于建立能量机关转子平面模型
+ *
+ * @param path 相机标定文件路径
+ */
+void BuffPredictor::LoadCameraMat(const std::string &path) {
+  model_.LoadCameraMat(path);
+}
+
+/**
+ * @brief 设置子弹飞行时间，预测时与系统延迟一起计入
+ *
+ * @param flight_time 飞行时间，单位秒
+ */
+void BuffPredictor::SetFlightTime(double flight_time) {
+  flight_time_ = flight_time;
+}
+
 /**
  * @brief 预测主函数
  *
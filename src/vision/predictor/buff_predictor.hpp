@@ -3,9 +3,12 @@
 #include <chrono>
 #include <vector>
 
+#include "angle_history.hpp"
 #include "buff.hpp"
 #include "buff_detector.hpp"
-#include "kalman.hpp"
+#include "buff_model.hpp"
+#include "buff_speed_fitter.hpp"
+#include "kalman_t.hpp"
 #include "opencv2/opencv.hpp"
 #include "predictor.hpp"
 
@@ -16,16 +19,24 @@ struct BuffPredictorParam {
   int error_frame;
 };
 
-class BuffPredictor : public Predictor<Armor, BuffPredictorParam, Kalman> {
+class BuffPredictor
+    : public Predictor<Armor, BuffPredictorParam,
+                       kalman::ConstantVelocity<2>::Filter> {
  private:
   game::Race race_;
   game::BuffState state_;
 
   Buff buff_;
   std::chrono::system_clock::time_point end_time_;
-  std::vector<cv::Point2f> circumference_;
+  AngleHistory history_;
   component::Timer duration_direction_, duration_predict_;
 
+  BuffSpeedFitter fitter_;
+  BuffModel model_;
+  std::chrono::steady_clock::time_point start_time_, frame_time_;
+  double flight_time_ = 0.;
+  bool center_ready_ = false;
+
   void InitDefaultParams(const std::string &path);
   bool PrepareParams(const std::string &path);
 
@@ -41,6 +52,19 @@ class BuffPredictor : public Predictor<Armor, BuffPredictorParam, Kalman> {
    */
   void MatchPredict();
 
+  /**
+   * @brief 清空角度历史和转速拟合
+   *
+   */
+  void ResetFit();
+
+  /**
+   * @brief 用 filter_ 平滑能量机关中心
+   *
+   * @param dt 距上一帧的时间，单位秒
+   */
+  void SmoothCenter(double dt);
+
   /**
    * @brief 根据原装甲板和能量机关中心夹角角度模拟旋转装甲板
    *
@@ -117,6 +141,20 @@ class BuffPredictor : public Predictor<Armor, BuffPredictorParam, Kalman> {
    */
   void SetRace(game::Race race);
 
+  /**
+   * @brief 加载相机参数，用于建立能量机关转子平面模型
+   *
+   * @param path 相机标定文件路径
+   */
+  void LoadCameraMat(const std::string &path);
+
+  /**
+   * @brief 设置子弹飞行时间，预测时与系统延迟一起计入
+   *
+   * @param flight_time 飞行时间，单位秒
+   */
+  void SetFlightTime(double flight_time);
+
   /**
    * @brief 预测主函数
    *
@@ -0,0 +1,191 @@
+#include "buff_speed_fitter.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include "ceres/ceres.h"
+#include "spdlog/spdlog.h"
+
+namespace {
+
+const double kSPEED_SUM = 2.090;
+const double kA_LOW = 0.780;
+const double kA_HIGH = 1.045;
+const double kW_LOW = 1.884;
+const double kW_HIGH = 2.000;
+
+const double kWINDOW = 3.5;           /* 保留约一个周期的样本，单位秒 */
+const std::size_t kMIN_SAMPLES = 30;  /* 开始拟合所需的最少样本 */
+const std::size_t kREFIT_SAMPLES = 5; /* 每新增多少样本重新拟合 */
+const int kPHASE_GUESS = 8; /* 首次拟合时相位的初值个数 */
+
+struct AngleResidual {
+  AngleResidual(double t, double theta) : t_(t), theta_(theta) {}
+
+  /* theta(t) = c + b * t - a / w * cos(w * t + phi) */
+  template <typename T>
+  bool operator()(const T *const p, T *residual) const {
+    using std::cos;
+    const T &a = p[0], &w = p[1], &phi = p[2], &c = p[3];
+    const T b = T(kSPEED_SUM) - a;
+    residual[0] = T(theta_) - (c + b * T(t_) - a / w * cos(w * T(t_) + phi));
+    return true;
+  }
+
+  double t_, theta_;
+};
+
+double Solve(const std::vector<std::pair<double, double>> &samples,
+             double *p, double time_budget) {
+  ceres::Problem problem;
+  for (const auto &s : samples) {
+    problem.AddResidualBlock(
+        new ceres::AutoDiffCostFunction<AngleResidual, 1, 4>(
+            new AngleResidual(s.first, s.second)),
+        new ceres::CauchyLoss(0.1), p);
+  }
+  problem.SetParameterLowerBound(p, 0, kA_LOW);
+  problem.SetParameterUpperBound(p, 0, kA_HIGH);
+  problem.SetParameterLowerBound(p, 1, kW_LOW);
+  problem.SetParameterUpperBound(p, 1, kW_HIGH);
+
+  ceres::Solver::Options options;
+  options.linear_solver_type = ceres::DENSE_QR;
+  options.max_num_iterations = 50;
+  options.max_solver_time_in_seconds = time_budget;
+  options.minimizer_progress_to_stdout = false;
+  options.logging_type = ceres::SILENT;
+
+  ceres::Solver::Summary summary;
+  ceres::Solve(options, &problem, &summary);
+  return summary.IsSolutionUsable() ? summary.final_cost : -1.;
+}
+
+}  // namespace
+
+void BuffSpeedFitter::FitThread() {
+  while (running_) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      signal_.wait_for(lock, std::chrono::milliseconds(100), [this] {
+        return !running_ || new_samples_ >= kREFIT_SAMPLES;
+      });
+      if (!running_) return;
+      if (new_samples_ < kREFIT_SAMPLES) continue;
+      new_samples_ = 0;
+    }
+    Fit();
+  }
+}
+
+BuffSpeedFitter::BuffSpeedFitter() {
+  running_ = true;
+  thread_ = std::thread(&BuffSpeedFitter::FitThread, this);
+  SPDLOG_TRACE("Constructed.");
+}
+
+BuffSpeedFitter::~BuffSpeedFitter() {
+  running_ = false;
+  signal_.notify_all();
+  if (thread_.joinable()) thread_.join();
+  SPDLOG_TRACE("Destructed.");
+}
+
+void BuffSpeedFitter::Reset() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  samples_.clear();
+  sign_ = 1.;
+  new_samples_ = 0;
+  params_ = Params();
+  ready_ = false;
+}
+
+void BuffSpeedFitter::AddSample(double t, double theta) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  samples_.emplace_back(Sample{t, theta});
+  while (!samples_.empty() && t - samples_.front().t > kWINDOW)
+    samples_.pop_front();
+
+  ++new_samples_;
+  if (new_samples_ >= kREFIT_SAMPLES) signal_.notify_one();
+}
+
+bool BuffSpeedFitter::Fit() {
+  std::vector<std::pair<double, double>> samples;
+  Params init;
+  double budget;
+  bool warm;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (samples_.size() < kMIN_SAMPLES) return false;
+
+    /* 统一成正向旋转再拟合，方向由整体变化量决定 */
+    const double sign =
+        samples_.back().theta >= samples_.front().theta ? 1. : -1.;
+    for (const auto &s : samples_) samples.emplace_back(s.t, sign * s.theta);
+    warm = ready_ && sign == sign_;
+    sign_ = sign;
+    init = params_;
+    budget = time_budget_;
+  }
+
+  double best[4] = {init.a, init.w, init.phi, init.c};
+  double best_cost = -1.;
+  const int guesses = warm ? 1 : kPHASE_GUESS;
+  for (int i = 0; i < guesses; ++i) {
+    double p[4] = {init.a, init.w, init.phi, init.c};
+    if (!warm) {
+      p[2] = 2. * M_PI * i / guesses;
+      p[3] = samples.front().second;
+    }
+    const double cost = Solve(samples, p, budget / guesses);
+    if (cost >= 0. && (best_cost < 0. || cost < best_cost)) {
+      best_cost = cost;
+      std::copy(p, p + 4, best);
+    }
+  }
+
+  if (best_cost < 0.) {
+    SPDLOG_WARN("Buff speed fitting failed.");
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  params_.a = best[0];
+  params_.w = best[1];
+  params_.phi = std::remainder(best[2], 2. * M_PI);
+  params_.c = best[3];
+  ready_ = true;
+  SPDLOG_DEBUG("Buff speed: a {}, w {}, phi {}, cost {}", params_.a,
+               params_.w, params_.phi, best_cost);
+  return true;
+}
+
+void BuffSpeedFitter::SetTimeBudget(double seconds) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  time_budget_ = seconds;
+}
+
+bool BuffSpeedFitter::Ready() const { return ready_; }
+
+BuffSpeedFitter::Params BuffSpeedFitter::GetParams() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return params_;
+}
+
+double BuffSpeedFitter::Speed(double t) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const double b = kSPEED_SUM - params_.a;
+  return sign_ * (params_.a * std::sin(params_.w * t + params_.phi) + b);
+}
+
+double BuffSpeedFitter::Integrate(double t, double dt) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const double b = kSPEED_SUM - params_.a;
+  const double a_w = params_.a / params_.w;
+  return sign_ * (b * dt + a_w * (std::cos(params_.w * t + params_.phi) -
+                                  std::cos(params_.w * (t + dt) + params_.phi)));
+}
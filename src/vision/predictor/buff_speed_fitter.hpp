@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+/**
+ * @brief 大能量机关转速拟合器
+ * 转速满足 spd = a * sin(w * t + phi) + b，其中 b = 2.090 - a，
+ * a 取值 [0.780, 1.045]，w 取值 [1.884, 2.000]。
+ * 记录带时间戳的展开角度（来自 AngleHistory），在后台线程中用 Ceres
+ * 拟合 a、w、phi，每次以上一次的解作为初值，并限制单次求解时间
+ *
+ */
+class BuffSpeedFitter {
+ public:
+  struct Params {
+    double a = 0.9125;
+    double w = 1.942;
+    double phi = 0.;
+    double c = 0.;
+  };
+
+ private:
+  struct Sample {
+    double t;
+    double theta;
+  };
+
+  mutable std::mutex mutex_;
+  std::deque<Sample> samples_;
+  double sign_ = 1.;
+
+  Params params_;
+  std::atomic<bool> ready_{false};
+  double time_budget_ = 0.01;
+  std::size_t new_samples_ = 0;
+
+  std::thread thread_;
+  std::atomic<bool> running_{false};
+  std::condition_variable signal_;
+
+  void FitThread();
+
+ public:
+  BuffSpeedFitter();
+  ~BuffSpeedFitter();
+
+  /**
+   * @brief 清空历史，例如能量机关状态切换时
+   *
+   */
+  void Reset();
+
+  /**
+   * @brief 添加一次观测
+   *
+   * @param t 时间，单位秒
+   * @param theta 已展开的扇叶角度，单位弧度
+   */
+  void AddSample(double t, double theta);
+
+  /**
+   * @brief 使用当前窗口同步拟合一次，后台线程也调用此函数
+   *
+   * @return true 拟合成功
+   * @return false 样本不足或求解失败
+   */
+  bool Fit();
+
+  /**
+   * @brief 单次求解的时间上限
+   *
+   * @param seconds 时间，单位秒
+   */
+  void SetTimeBudget(double seconds);
+
+  bool Ready() const;
+  Params GetParams() const;
+
+  /**
+   * @brief 拟合得到的转速
+   *
+   * @param t 时间，单位秒
+   * @return double 转速，单位弧度每秒，方向与观测一致
+   */
+  double Speed(double t) const;
+
+  /**
+   * @brief 对转速积分，得到一段时间内转过的角度
+   *
+   * @param t 起始时间，单位秒
+   * @param dt 时长，单位秒
+   * @return double 转过的角度，单位弧度，方向与观测一致
+   */
+  double Integrate(double t, double dt) const;
+};
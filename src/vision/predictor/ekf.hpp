@@ -1,58 +1,259 @@
 #pragma once
 
 #include <Eigen/Dense>
+#include <array>
+#include <chrono>
+#include <cmath>
 
 #include "ceres/jet.h"
-#include "filter.hpp"
-#include "opencv2/core/eigen.hpp"
 
-class EKF : public Filter {
+/**
+ * @brief 扩展卡尔曼滤波
+ * 过程模型和观测模型以仿函数传入，雅可比矩阵由 ceres::Jet 自动求导。
+ * Jet 放在定长数组中，矩阵都是定长 Eigen 矩阵，每步不申请堆内存。
+ *
+ * 过程模型提供 kSTATES 和
+ * template <typename T> void operator()(const T *x0, const T &dt, T *x1);
+ * 观测模型提供 kSTATES、kMEASUREMENTS 和
+ * template <typename T> void operator()(const T *x, T *y);
+ *
+ * @tparam Process 过程模型
+ * @tparam Measure 观测模型
+ */
+template <typename Process, typename Measure>
+class EKF {
  public:
-  using EMatx55d = Eigen::Matrix<double, 5, 5>;
-  using EMatx35d = Eigen::Matrix<double, 3, 5>;
-  using EMatx53d = Eigen::Matrix<double, 5, 3>;
-  using EMatx33d = Eigen::Matrix<double, 3, 3>;
-  using EMatx51d = Eigen::Matrix<double, 5, 1>;
-  using EMatx31d = Eigen::Matrix<double, 3, 1>;
-
-  using Matx33d = cv::Matx33d;
-  using Matx35d = cv::Matx<double, 3, 5>;
-  using Matx53d = cv::Matx<double, 5, 3>;
-  using Matx55d = cv::Matx<double, 5, 5>;
-  using Matx31d = cv::Matx<double, 3, 1>;
-  using Matx51d = cv::Matx<double, 5, 1>;
+  static constexpr int kSTATES = Process::kSTATES;
+  static constexpr int kMEASUREMENTS = Measure::kMEASUREMENTS;
+  static_assert(Measure::kSTATES == kSTATES,
+                "Process and measurement models must share the state.");
+
+  using State = Eigen::Matrix<double, kSTATES, 1>;
+  using Measurement = Eigen::Matrix<double, kMEASUREMENTS, 1>;
+  using StateMatrix = Eigen::Matrix<double, kSTATES, kSTATES>;
+  using MeasurementMatrix = Eigen::Matrix<double, kMEASUREMENTS, kSTATES>;
+  using MeasurementCov = Eigen::Matrix<double, kMEASUREMENTS, kMEASUREMENTS>;
+  using Gain = Eigen::Matrix<double, kSTATES, kMEASUREMENTS>;
+  using Clock = std::chrono::steady_clock;
 
  private:
-  cv::Mat Xe;  // Matx51d state_pre_;             /* 估计状态变量 */
-  cv::Mat Xp;  // Matx51d state_next_;            /* 预测状态变量 */
-  // Matx55d F;   // Matx55d predict_mat_;           /* 预测雅克比 */
-  // Matx35d H;   // Matx35d measurement_mat_;       /* 观测雅克比 */
-  // Matx55d P;   // Matx55d state_cov_;             /* 状态协方差 */
-  // Matx55d Q;   // Matx55d process_noi_cov_mat_;   /* 预测过程协方差 */
-  // Matx33d R;   // Matx33d measure_noi_cov_mat_;   /* 观测过程协方差 */
-  // Matx53d K;   // Matx35d kalman_gain_;           /* 卡尔曼增益 */
-  // Matx31d Yp;  // Matx31d predict_obs_;           /* 预测观测量 */
-
-  EMatx51d EXe;
-  EMatx51d EXp;
-  EMatx55d EF;
-  EMatx35d EH;
-  EMatx55d EP;
-  EMatx55d EQ;
-  EMatx33d ER;
-  EMatx53d EK;
-  EMatx31d EYp;
-
-  double delta_t_;
-
-  void InnerInit(const Matx51d& Xe);
+  using Jet = ceres::Jet<double, kSTATES>;
+
+  Process process_;
+  Measure measure_;
+
+  State x_;
+  StateMatrix P_, Q_, F_;
+  MeasurementMatrix H_;
+  MeasurementCov R_;
+  Measurement y_; /* 由预测状态得到的观测 */
+
+  Clock::time_point stamp_;
+  bool stamped_ = false;
 
  public:
-  explicit EKF(const Matx51d& Xe = Matx51d::zeros());
-  ~EKF();
+  explicit EKF(const Process &process = Process(),
+               const Measure &measure = Measure())
+      : process_(process),
+        measure_(measure),
+        x_(State::Zero()),
+        P_(StateMatrix::Identity()),
+        Q_(StateMatrix::Identity()),
+        F_(StateMatrix::Identity()),
+        H_(MeasurementMatrix::Zero()),
+        R_(MeasurementCov::Identity()),
+        y_(Measurement::Zero()) {}
+
+  /**
+   * @brief 设置初始状态和协方差，并清除时间戳
+   *
+   * @param x 状态
+   * @param P 协方差
+   */
+  void Init(const State &x, const StateMatrix &P) {
+    x_ = x;
+    P_ = P;
+    stamped_ = false;
+  }
+
+  /**
+   * @brief 设置单位时间的过程噪声，预测时按 dt 缩放
+   *
+   * @param Q 过程噪声协方差
+   */
+  void SetProcessNoise(const StateMatrix &Q) { Q_ = Q; }
+  void SetMeasurementNoise(const MeasurementCov &R) { R_ = R; }
+
+  /**
+   * @brief 预测
+   *
+   * @param dt 距上一步的时间，单位秒
+   * @return const State& 预测状态
+   */
+  const State &Predict(double dt) {
+    std::array<Jet, kSTATES> x0, x1;
+    for (int i = 0; i < kSTATES; ++i) x0[i] = Jet(x_(i), i);
+    process_(x0.data(), Jet(dt), x1.data());
+    for (int i = 0; i < kSTATES; ++i) {
+      x_(i) = x1[i].a;
+      F_.row(i) = x1[i].v.transpose();
+    }
+    P_ = F_ * P_ * F_.transpose() + Q_ * dt;
+    return x_;
+  }
+
+  /**
+   * @brief 预测到指定时刻，第一次调用只记录时间戳，早于上一时刻的忽略
+   *
+   * @param stamp 时间戳
+   * @return const State& 预测状态
+   */
+  const State &Predict(Clock::time_point stamp) {
+    if (stamped_) {
+      if (stamp <= stamp_) return x_;
+      Predict(std::chrono::duration<double>(stamp - stamp_).count());
+    }
+    stamp_ = stamp;
+    stamped_ = true;
+    return x_;
+  }
 
-  void Init(const std::vector<double>& vec);
+  const State &Update(const Measurement &z) {
+    std::array<Jet, kSTATES> x;
+    std::array<Jet, kMEASUREMENTS> y;
+    for (int i = 0; i < kSTATES; ++i) x[i] = Jet(x_(i), i);
+    measure_(x.data(), y.data());
+    for (int i = 0; i < kMEASUREMENTS; ++i) {
+      y_(i) = y[i].a;
+      H_.row(i) = y[i].v.transpose();
+    }
 
-  const cv::Mat& Predict(const cv::Mat& measurements);
-  const cv::Mat& Update(const cv::Mat& upgrade);
+    const MeasurementCov S = H_ * P_ * H_.transpose() + R_;
+    const Gain K = P_ * H_.transpose() * S.inverse();
+    x_ += K * (z - y_);
+
+    /* Joseph 形式保持协方差对称正定 */
+    const StateMatrix I_KH = StateMatrix::Identity() - K * H_;
+    P_ = I_KH * P_ * I_KH.transpose() + K * R_ * K.transpose();
+    return x_;
+  }
+
+  const State &GetState() const { return x_; }
+  const StateMatrix &GetCovariance() const { return P_; }
+
+  /**
+   * @brief 最近一次预测时过程模型的雅可比矩阵
+   *
+   * @return const StateMatrix& 雅可比矩阵
+   */
+  const StateMatrix &GetProcessJacobian() const { return F_; }
+
+  /**
+   * @brief 最近一次更新时观测模型的雅可比矩阵
+   *
+   * @return const MeasurementMatrix& 雅可比矩阵
+   */
+  const MeasurementMatrix &GetMeasurementJacobian() const { return H_; }
 };
+
+namespace ekf {
+
+/**
+ * @brief 各轴独立的匀速模型，状态为 [p0, v0, p1, v1, ...]
+ *
+ * @tparam Axes 轴数
+ */
+template <int Axes>
+struct ConstantVelocity {
+  static constexpr int kSTATES = 2 * Axes;
+
+  template <typename T>
+  void operator()(const T *x0, const T &dt, T *x1) const {
+    for (int a = 0; a < Axes; ++a) {
+      x1[2 * a] = x0[2 * a] + dt * x0[2 * a + 1];
+      x1[2 * a + 1] = x0[2 * a + 1];
+    }
+  }
+};
+
+/**
+ * @brief 匀速转弯模型（CTRV），状态为 [x, y, v, yaw, yaw_rate]
+ * 角速度接近 0 时退化为直线运动，避免除以 0
+ *
+ */
+struct ConstantTurnRate {
+  static constexpr int kSTATES = 5;
+  static constexpr double kMIN_YAW_RATE = 1e-4;
+
+  template <typename T>
+  void operator()(const T *x0, const T &dt, T *x1) const {
+    using std::cos;
+    using std::sin;
+    const T &v = x0[2];
+    const T &yaw = x0[3];
+    const T &w = x0[4];
+    const T yaw1 = yaw + w * dt;
+    if (w * w > T(kMIN_YAW_RATE * kMIN_YAW_RATE)) {
+      x1[0] = x0[0] + v / w * (sin(yaw1) - sin(yaw));
+      x1[1] = x0[1] + v / w * (cos(yaw) - cos(yaw1));
+    } else {
+      x1[0] = x0[0] + v * dt * cos(yaw);
+      x1[1] = x0[1] + v * dt * sin(yaw);
+    }
+    x1[2] = v;
+    x1[3] = yaw1;
+    x1[4] = w;
+  }
+};
+
+/**
+ * @brief 观测匀速模型中各轴的位置
+ *
+ * @tparam Axes 轴数
+ */
+template <int Axes>
+struct Position {
+  static constexpr int kSTATES = 2 * Axes;
+  static constexpr int kMEASUREMENTS = Axes;
+
+  template <typename T>
+  void operator()(const T *x, T *y) const {
+    for (int a = 0; a < Axes; ++a) y[a] = x[2 * a];
+  }
+};
+
+/**
+ * @brief 观测匀速转弯模型的平面位置
+ *
+ */
+struct TurnRatePosition {
+  static constexpr int kSTATES = ConstantTurnRate::kSTATES;
+  static constexpr int kMEASUREMENTS = 2;
+
+  template <typename T>
+  void operator()(const T *x, T *y) const {
+    y[0] = x[0];
+    y[1] = x[1];
+  }
+};
+
+/**
+ * @brief 由三维匀速模型的位置换算 pitch、yaw 和距离
+ *
+ */
+struct Spherical {
+  static constexpr int kSTATES = ConstantVelocity<3>::kSTATES;
+  static constexpr int kMEASUREMENTS = 3;
+
+  template <typename T>
+  void operator()(const T *x, T *y) const {
+    using std::atan2;
+    using std::sqrt;
+    const T horizon = sqrt(x[0] * x[0] + x[2] * x[2]);
+    y[0] = atan2(x[4], horizon);
+    y[1] = atan2(x[2], x[0]);
+    y[2] = sqrt(horizon * horizon + x[4] * x[4]);
+  }
+};
+
+}  // namespace ekf
@@ -15,6 +15,7 @@ const cv::Point3d kSIZE3(kWIDTH / kSCALIONGFACTOR, kHEIGHT / kSCALIONGFACTOR,
                          std::sqrt(kWIDTH* kHEIGHT) / kSCALIONGFACTOR);
 
 const double kT = 0.03;
+const unsigned int kINIT_FRAMES = 2; /* 两点起始 */
 const double kvar_u1 = 0.08;
 const double kvar_u2 = 0.08;
 const double kvar_v1 = 0.01;
@@ -27,6 +28,7 @@ void Kalman::InnerInit(int states = 4, int measurements = 2) {
   measurements_ = measurements;
   error_frame_ = 0;
   start_frame_ = 0;
+  coords_.clear();
 
   cv::Mat empty_matx(cv::Mat_<double>::zeros(2, 1));
   cur_predict_matx_ = empty_matx.clone();
@@ -72,7 +74,7 @@ void Kalman::InnerInit(int states = 4, int measurements = 2) {
   temp_Q.at<double>(3, 3) = std::pow(kT, 4) * std::pow(kvar_u2, 2) / 4;
   kalman_filter_.processNoiseCov = temp_Q;
 
-  //* P 后验错误估计协方差矩阵
+  //* P 后验错误估计协方差矩阵，即两点起始的协方差
   /* cv::setIdentity(kalman_filter_.errorCovPost, cv::Scalar::all(1)); */
   cv::Mat temp_P = cv::Mat_<double>::zeros(states, states);
   temp_P.at<double>(0, 0) = std::pow(kvar_v1, 2);
@@ -120,22 +122,24 @@ void Kalman::Init(const std::vector<double>& vec) {
 }
 
 bool Kalman::Config(const cv::Point2d& measurements_point) {
-  if (start_frame_ < 30) {
-    start_frame_++;
-    coords_.emplace_back(measurements_point);
-    return false;
-  } else if (start_frame_ == 30) {
-    cv::Mat temp_X = cv::Mat_<double>(states_, 1);
-    temp_X.at<double>(0, 0) = coords_[29].x;
-    temp_X.at<double>(1, 0) = (coords_[29].x - coords_[0].x) / kT;
-    temp_X.at<double>(2, 0) = coords_[0].y;
-    temp_X.at<double>(3, 0) = (coords_[29].y - coords_[0].y) / kT;
-    kalman_filter_.statePost = temp_X;
-    start_frame_++;
-    return true;
-  } else {
-    return true;
+  if (start_frame_ >= kINIT_FRAMES) return true;
+
+  /* 第一帧只有位置，第二帧由两点差分得到速度，之后正常滤波 */
+  coords_.emplace_back(measurements_point);
+  const cv::Point2d& first = coords_.front();
+  const cv::Point2d& last = coords_.back();
+  const double dt = kT * (coords_.size() - 1);
+  cv::Mat temp_X = cv::Mat_<double>::zeros(states_, 1);
+  temp_X.at<double>(0, 0) = last.x;
+  temp_X.at<double>(2, 0) = last.y;
+  if (dt > 0) {
+    temp_X.at<double>(1, 0) = (last.x - first.x) / dt;
+    temp_X.at<double>(3, 0) = (last.y - first.y) / dt;
   }
+  kalman_filter_.statePost = temp_X;
+  cur_predict_matx_ = temp_X.clone();
+  start_frame_++;
+  return false;
 }
 
 const cv::Point2d Kalman::Predict(const cv::Point2d& measurements_point) {
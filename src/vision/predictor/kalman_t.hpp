@@ -0,0 +1,281 @@
+#pragma once
+
+#include <Eigen/Dense>
+#include <array>
+
+/**
+ * @brief 固定维度的线性卡尔曼滤波
+ * 所有矩阵都是编译期确定尺寸的 Eigen 矩阵，预测和更新过程不申请堆内存。
+ * 更新使用 Joseph 形式，协方差在单精度下也能保持对称正定
+ *
+ * @tparam States 状态维数
+ * @tparam Measurements 观测维数
+ * @tparam Scalar float 或 double
+ */
+template <int States, int Measurements, typename Scalar = double>
+class KalmanT {
+ public:
+  using State = Eigen::Matrix<Scalar, States, 1>;
+  using Measurement = Eigen::Matrix<Scalar, Measurements, 1>;
+  using StateMatrix = Eigen::Matrix<Scalar, States, States>;
+  using MeasurementMatrix = Eigen::Matrix<Scalar, Measurements, States>;
+  using MeasurementCov = Eigen::Matrix<Scalar, Measurements, Measurements>;
+  using Gain = Eigen::Matrix<Scalar, States, Measurements>;
+
+  static constexpr int kSTATES = States;
+  static constexpr int kMEASUREMENTS = Measurements;
+
+ private:
+  State x_;
+  StateMatrix P_, F_, Q_;
+  MeasurementMatrix H_;
+  MeasurementCov R_;
+
+ public:
+  KalmanT()
+      : x_(State::Zero()),
+        P_(StateMatrix::Identity()),
+        F_(StateMatrix::Identity()),
+        Q_(StateMatrix::Identity()),
+        H_(MeasurementMatrix::Identity()),
+        R_(MeasurementCov::Identity()) {}
+
+  /**
+   * @brief 设置初始状态和协方差
+   *
+   * @param x 状态
+   * @param P 协方差
+   */
+  void Init(const State &x, const StateMatrix &P) {
+    x_ = x;
+    P_ = P;
+  }
+
+  void SetTransition(const StateMatrix &F) { F_ = F; }
+  void SetMeasurement(const MeasurementMatrix &H) { H_ = H; }
+  void SetProcessNoise(const StateMatrix &Q) { Q_ = Q; }
+  void SetMeasurementNoise(const MeasurementCov &R) { R_ = R; }
+
+  const State &Predict() {
+    x_ = F_ * x_;
+    P_ = F_ * P_ * F_.transpose() + Q_;
+    return x_;
+  }
+
+  const State &Update(const Measurement &z) {
+    const MeasurementCov S = H_ * P_ * H_.transpose() + R_;
+    const Gain K = P_ * H_.transpose() * S.inverse();
+    x_ += K * (z - H_ * x_);
+
+    /* Joseph 形式：P = (I - KH) P (I - KH)' + K R K' */
+    const StateMatrix I_KH = StateMatrix::Identity() - K * H_;
+    P_ = I_KH * P_ * I_KH.transpose() + K * R_ * K.transpose();
+    return x_;
+  }
+
+  /**
+   * @brief 观测与预测观测之间的马氏距离平方，用于关联门限
+   *
+   * @param z 观测
+   * @return Scalar 马氏距离平方
+   */
+  Scalar Mahalanobis(const Measurement &z) const {
+    const MeasurementCov S = H_ * P_ * H_.transpose() + R_;
+    const Measurement y = z - H_ * x_;
+    return y.dot(S.ldlt().solve(y));
+  }
+
+  const State &GetState() const { return x_; }
+  const StateMatrix &GetCovariance() const { return P_; }
+  const StateMatrix &GetTransition() const { return F_; }
+  const MeasurementMatrix &GetMeasurement() const { return H_; }
+};
+
+namespace kalman {
+
+constexpr double Factorial(int n) { return n <= 1 ? 1. : n * Factorial(n - 1); }
+
+/**
+ * @brief 运动学模型的系数表，编译期生成
+ * 转移矩阵 F(i, j) = dt^(j-i) / (j-i)!
+ * 最高阶导数为连续白噪声时，离散过程噪声
+ * Q(i, j) = q * dt^(2n-1-i-j) / ((n-1-i)! (n-1-j)! (2n-1-i-j))
+ *
+ * @tparam Order 每个轴的状态数
+ */
+template <int Order>
+struct KinematicCoefs {
+  std::array<double, Order> transition{};
+  std::array<double, Order * Order> noise{};
+
+  constexpr KinematicCoefs() {
+    for (int k = 0; k < Order; ++k) transition[k] = 1. / Factorial(k);
+    for (int i = 0; i < Order; ++i)
+      for (int j = 0; j < Order; ++j)
+        noise[i * Order + j] =
+            1. / (Factorial(Order - 1 - i) * Factorial(Order - 1 - j) *
+                  (2 * Order - 1 - i - j));
+  }
+};
+
+/**
+ * @brief 各轴独立的运动学模型
+ * 每个轴的状态依次为位置、速度（、加速度），只观测位置
+ *
+ * @tparam Axes 轴数
+ * @tparam Order 每个轴的状态数，2 为匀速，3 为匀加速
+ * @tparam Scalar float 或 double
+ */
+template <int Axes, int Order, typename Scalar = double>
+struct Kinematic {
+  static_assert(Order >= 1, "Order must be positive.");
+
+  using Filter = KalmanT<Axes * Order, Axes, Scalar>;
+  using StateMatrix = typename Filter::StateMatrix;
+  using MeasurementMatrix = typename Filter::MeasurementMatrix;
+
+  /* dt 的 0 到 2n-1 次幂 */
+  static std::array<Scalar, 2 * Order> Powers(Scalar dt) {
+    std::array<Scalar, 2 * Order> powers;
+    powers[0] = Scalar(1);
+    for (int k = 1; k < 2 * Order; ++k) powers[k] = powers[k - 1] * dt;
+    return powers;
+  }
+
+  static constexpr KinematicCoefs<Order> kCOEFS{};
+
+  static StateMatrix Transition(Scalar dt) {
+    const auto powers = Powers(dt);
+    StateMatrix F = StateMatrix::Zero();
+    for (int a = 0; a < Axes; ++a)
+      for (int i = 0; i < Order; ++i)
+        for (int j = i; j < Order; ++j)
+          F(a * Order + i, a * Order + j) =
+              powers[j - i] * static_cast<Scalar>(kCOEFS.transition[j - i]);
+    return F;
+  }
+
+  static MeasurementMatrix Measurement() {
+    MeasurementMatrix H = MeasurementMatrix::Zero();
+    for (int a = 0; a < Axes; ++a) H(a, a * Order) = Scalar(1);
+    return H;
+  }
+
+  /**
+   * @brief 离散过程噪声
+   *
+   * @param dt 时间间隔
+   * @param q 最高阶导数的噪声功率谱密度
+   * @return StateMatrix 过程噪声协方差
+   */
+  static StateMatrix ProcessNoise(Scalar dt, Scalar q) {
+    const auto powers = Powers(dt);
+    StateMatrix Q = StateMatrix::Zero();
+    for (int a = 0; a < Axes; ++a)
+      for (int i = 0; i < Order; ++i)
+        for (int j = 0; j < Order; ++j)
+          Q(a * Order + i, a * Order + j) =
+              q * powers[2 * Order - 1 - i - j] *
+              static_cast<Scalar>(kCOEFS.noise[i * Order + j]);
+    return Q;
+  }
+
+  /**
+   * @brief 按模型配置滤波器
+   *
+   * @param filter 滤波器
+   * @param dt 时间间隔
+   * @param q 过程噪声功率谱密度
+   * @param r 观测噪声方差
+   */
+  static void Configure(Filter &filter, Scalar dt, Scalar q, Scalar r) {
+    filter.SetTransition(Transition(dt));
+    filter.SetMeasurement(Measurement());
+    filter.SetProcessNoise(ProcessNoise(dt, q));
+    filter.SetMeasurementNoise(Filter::MeasurementCov::Identity() * r);
+  }
+};
+
+/**
+ * @brief 快速起始
+ * 用最近几帧观测按最小二乘拟合各轴的多项式运动，直接得到最后一帧的状态，
+ * 协方差为 r (A'A)^-1。帧数等于每轴状态数时就是两点（三点）起始，
+ * 不需要先积累几十帧观测
+ *
+ * @tparam Axes 轴数
+ * @tparam Order 每个轴的状态数
+ * @tparam Points 拟合使用的帧数，不少于 Order
+ * @tparam Scalar float 或 double
+ */
+template <int Axes, int Order, int Points = Order, typename Scalar = double>
+class FastStart {
+  static_assert(Points >= Order, "Need at least one point per state.");
+
+ public:
+  using Filter = typename Kinematic<Axes, Order, Scalar>::Filter;
+  using Measurement = typename Filter::Measurement;
+
+ private:
+  std::array<Measurement, Points> z_;
+  std::array<Scalar, Points> t_;
+  int count_ = 0;
+
+ public:
+  void Reset() { count_ = 0; }
+
+  /**
+   * @brief 加入一帧观测，超过 Points 帧时覆盖最早的一帧
+   *
+   * @param z 观测
+   * @param t 时间戳，单位秒，各帧不能相同
+   * @return true 观测足够，可以初始化
+   */
+  bool Add(const Measurement &z, Scalar t) {
+    z_[count_ % Points] = z;
+    t_[count_ % Points] = t;
+    ++count_;
+    return Ready();
+  }
+
+  bool Ready() const { return count_ >= Points; }
+
+  /**
+   * @brief 用拟合结果初始化滤波器，状态对应最后一帧的时刻，需先 Ready
+   *
+   * @param filter 滤波器
+   * @param r 观测噪声方差
+   */
+  void Init(Filter &filter, Scalar r) const {
+    /* A(k, j) = (t_k - t_last)^j / j! */
+    const Scalar t_last = t_[(count_ - 1) % Points];
+    Eigen::Matrix<Scalar, Points, Order> A;
+    for (int k = 0; k < Points; ++k) {
+      Scalar power = Scalar(1);
+      for (int j = 0; j < Order; ++j) {
+        A(k, j) = power / static_cast<Scalar>(Factorial(j));
+        power *= t_[k] - t_last;
+      }
+    }
+    const Eigen::Matrix<Scalar, Order, Order> cov =
+        (A.transpose() * A).inverse();
+    const Eigen::Matrix<Scalar, Order, Points> solver = cov * A.transpose();
+
+    typename Filter::State x;
+    typename Filter::StateMatrix P = Filter::StateMatrix::Zero();
+    Eigen::Matrix<Scalar, Points, 1> b;
+    for (int a = 0; a < Axes; ++a) {
+      for (int k = 0; k < Points; ++k) b(k) = z_[k](a);
+      x.template segment<Order>(a * Order) = solver * b;
+      P.template block<Order, Order>(a * Order, a * Order) = r * cov;
+    }
+    filter.Init(x, P);
+  }
+};
+
+template <int Axes, typename Scalar = double>
+using ConstantVelocity = Kinematic<Axes, 2, Scalar>;
+
+template <int Axes, typename Scalar = double>
+using ConstantAcceleration = Kinematic<Axes, 3, Scalar>;
+
+}  // namespace kalman
@@ -1,24 +1,31 @@
 #include "aim_assitant.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
 #include "armor.hpp"
 
 void AimAssitant::Sort() {
   cv::Point2f image_center(kIMAGE_WIDTH / 2, kIMAGE_HEIGHT / 2);
-  auto weight = [image_center](Armor armor) {
+  auto weight = [image_center](const Armor &armor) {
     double center_dis = cv::norm(armor.ImageCenter() - image_center);
-    auto corner_points = armor.ImageVertices();
-    std::vector<cv::Point2f> cvt_points;
-    cv::warpPerspective(corner_points, cvt_points, armor.trans_,
-                        armor.face_size_);
-    double diff = 0;
-    for (std::size_t i = 0; i < corner_points.size(); i++)
-      diff += cv::norm((corner_points[i] - cvt_points[i]));
-    return center_dis += diff / 4;
+    /* 正对相机时左右两边等长，宽高比与正视图案相同。偏离量都以像素计，
+       只由图像中的角点决定，分类缓存命中时同样可用 */
+    const auto v = armor.ImageVertices();
+    const auto &pov = armor.FaceVertices();
+    const double ratio = cv::norm(pov[2] - pov[1]) / cv::norm(pov[0] - pov[1]);
+    const double left = cv::norm(v[0] - v[1]), right = cv::norm(v[3] - v[2]);
+    const double width = (cv::norm(v[2] - v[1]) + cv::norm(v[3] - v[0])) / 2.;
+    const double skew = std::abs(left - right) +
+                        std::abs(width - ratio * (left + right) / 2.);
+    return center_dis + skew;
   };
 
-  std::sort(armors_.begin(), armors_.end(), [weight](Armor iti, Armor itj) {
-    return weight(iti) > weight(itj);
-  });
+  std::sort(armors_.begin(), armors_.end(),
+            [weight](const Armor &iti, const Armor &itj) {
+              return weight(iti) > weight(itj);
+            });
 }
 
 AimAssitant::AimAssitant() { SPDLOG_TRACE("Constructed."); }
@@ -34,12 +41,17 @@ void AimAssitant::LoadParams(const std::string& armor_param,
                              const std::string& buff_param,
                              const std::string& snipe_param,
                              const std::string& armor_pre_param,
-                             const std::string& buff_pre_param) {
+                             const std::string& buff_pre_param,
+                             const std::string& flow_param,
+                             const std::string& cam_mat_path) {
   a_detector_.LoadParams(armor_param);
+  a_tracker_.LoadParams(flow_param);
   b_detector_.LoadParams(buff_param);
   s_detector_.LoadParams(snipe_param);
   a_predictor_.LoadParams(armor_pre_param);
   b_predictor_.LoadParams(buff_pre_param);
+  /* 能量机关转子平面模型需要相机参数 */
+  b_predictor_.LoadCameraMat(cam_mat_path);
 }
 
 void AimAssitant::SetEnemyTeam(game::Team enemy_team) {
@@ -50,10 +62,12 @@ void AimAssitant::SetEnemyTeam(game::Team enemy_team) {
 
 void AimAssitant::SetClassiferParam(const std::string model_path,
                                     const std::string lable_path,
-                                    const cv::Size& input_size) {
+                                    const cv::Size& input_size,
+                                    const std::string template_dir) {
   classifier_.LoadModel(model_path);
   classifier_.LoadLable(lable_path);
   classifier_.SetInputSize(input_size);
+  classifier_.LoadTemplates(lable_path, template_dir);
 }
 
 void AimAssitant::SetRFID(game::RFID rfid) {
@@ -90,31 +104,43 @@ void AimAssitant::SetRace(game::Race race) { b_predictor_.SetRace(race); }
 
 void AimAssitant::SetTime(double time) { b_predictor_.SetTime(time); }
 
+void AimAssitant::SetFlightTime(double flight_time) {
+  b_predictor_.SetFlightTime(flight_time);
+}
+
 game::AimMethod AimAssitant::GetMethod() {
   SPDLOG_DEBUG("{}", game::ToString(method_));
   return method_;
 }
 
 const tbb::concurrent_vector<Armor>& AimAssitant::Aim(const cv::Mat& frame) {
+  FrameContext ctx(frame);
+  return Aim(ctx);
+}
+
+const tbb::concurrent_vector<Armor>& AimAssitant::Aim(FrameContext& ctx) {
+  /* 在检测之前取时间戳，检测耗时的波动不计入帧间隔 */
+  const auto stamp = std::chrono::steady_clock::now();
   armors_.clear();
   if (method_ == game::AimMethod::kUNKNOWN) {
     method_ = game::AimMethod::kARMOR;
   }
 
   if (method_ == game::AimMethod::kBUFF) {
-    auto buffs = b_detector_.Detect(frame);
+    auto buffs = b_detector_.Detect(ctx);
     b_predictor_.SetBuff(buffs.back());
     armors_ = b_predictor_.Predict();
   } else {
     if (method_ == game::AimMethod::kARMOR) {
-      armors_ = a_detector_.Detect(frame);
-      for (auto& armor : armors_) classifier_.ClassifyModel(armor, frame);
+      /* 两次完整检测之间用光流跟踪角点 */
+      armors_ = a_tracker_.Detect(ctx);
+      classifier_.ClassifyTracked(armors_, ctx);
       Sort();
     } else if (method_ == game::AimMethod::kSNIPE) {
-      armors_ = s_detector_.Detect(frame);
+      armors_ = s_detector_.Detect(ctx.Frame());
     }
 
-    a_predictor_.SetArmor(armors_.front());
+    a_predictor_.SetArmors(armors_, stamp);
     armors_ = a_predictor_.Predict();
   }
   return armors_;
@@ -122,7 +148,7 @@ const tbb::concurrent_vector<Armor>& AimAssitant::Aim(const cv::Mat& frame) {
 
 void AimAssitant::VisualizeResult(const cv::Mat& frame, int add_label) {
   if (method_ == game::AimMethod::kARMOR) {
-    a_detector_.VisualizeResult(frame, add_label);
+    a_tracker_.VisualizeResult(frame, add_label);
     a_predictor_.VisualizePrediction(frame, add_label);
   } else if (method_ == game::AimMethod::kBUFF) {
     b_detector_.VisualizeResult(frame, add_label);
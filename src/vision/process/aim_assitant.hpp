@@ -6,11 +6,13 @@
 #include "buff_detector.hpp"
 #include "buff_predictor.hpp"
 #include "common.hpp"
+#include "flow_tracker.hpp"
 #include "snipe_detector.hpp"
 
 class AimAssitant {
  private:
   ArmorDetector a_detector_;
+  FlowTracker a_tracker_{a_detector_};
   ArmorPredictor a_predictor_;
   BuffDetector b_detector_;
   BuffPredictor b_predictor_;
@@ -31,18 +33,29 @@ class AimAssitant {
   void LoadParams(const std::string& armor_param, const std::string& buff_param,
                   const std::string& snipe_param,
                   const std::string& armor_pre_param,
-                  const std::string& buff_pre_param);
+                  const std::string& buff_pre_param,
+                  const std::string& flow_param,
+                  const std::string& cam_mat_path);
   void SetClassiferParam(const std::string model_path,
                          const std::string lable_path,
-                         const cv::Size& input_size);
+                         const cv::Size& input_size,
+                         const std::string template_dir);
   void SetEnemyTeam(game::Team enemy_team);
   void SetRFID(game::RFID rfid);
   void SetArm(game::Arm arm);
   void SetRace(game::Race race);
   void SetTime(double time);
 
+  /**
+   * @brief 设置弹丸飞行时间，计入能量机关预测的提前量
+   *
+   * @param flight_time 飞行时间，单位秒
+   */
+  void SetFlightTime(double flight_time);
+
   game::AimMethod GetMethod();
 
   const tbb::concurrent_vector<Armor>& Aim(const cv::Mat& frame);
+  const tbb::concurrent_vector<Armor>& Aim(FrameContext& ctx);
   void VisualizeResult(const cv::Mat& frame, int add_label = 1);
 };